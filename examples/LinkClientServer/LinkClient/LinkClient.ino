@@ -63,7 +63,7 @@
 #include "../src/Display/LinkGraphicsEngine.h"
 #endif
 
-#include "Testing\LinkLogTask.h"
+#include "Testing/LinkLogTask.h"
 
 // Process scheduler.
 TS::Scheduler SchedulerBase{};
@@ -56,7 +56,7 @@
 #endif
 
 #if defined(LOLA_DEBUG_LINK_STATUS)
-#include "Testing\LinkLogTask.h"
+#include "Testing/LinkLogTask.h"
 #endif
 
 // Process scheduler.
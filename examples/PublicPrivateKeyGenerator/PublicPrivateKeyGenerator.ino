@@ -1,6 +1,8 @@
 /* LoLa Link Key generator.
 * Generate a one time pair of private/public keys for ECC Public-Key Exchange.*
 * The sketch also benchmarks PKE operations.
+* The sliced ECDH reports the time until the key is ready, its step count and worst step,
+*  the longest it holds the scheduler. Requires uECC_ENABLE_VLI_API=1.
 */
 
 
@@ -11,11 +13,12 @@
 
 #include <uECC.h>
 #include <ILoLaInclude.h>
+#include <Experimental/SlicedEcdh.h>
 
 
 
 #define LINK_DUPLEX_SLOT false
-#include "Testing\ExampleTransceiverDefinitions.h"
+#include "Testing/ExampleTransceiverDefinitions.h"
 
 LoLaRandom RandomSource(&EntropySource);
 
@@ -37,6 +40,8 @@ uint8_t Public2Decompressed[LoLaCryptoDefinition::PUBLIC_KEY_SIZE];
 
 const struct uECC_Curve_t* ECC_CURVE = uECC_secp160r1();
 
+SlicedEcdh<> Ecdh{};
+
 
 void Halt()
 {
@@ -119,6 +124,41 @@ void loop()
 		Serial.println(F("Secret Key calculation failed."));
 	}
 
+	uint32_t stepStart = 0;
+	uint32_t worstStep = 0;
+	uint16_t steps = 0;
+	start = micros();
+	Ecdh.Start(Public2, Private1, ECC_CURVE);
+	worstStep = micros() - start;
+	do
+	{
+		stepStart = micros();
+		success = Ecdh.Step();
+		const uint32_t stepDuration = micros() - stepStart;
+		if (stepDuration > worstStep)
+		{
+			worstStep = stepDuration;
+		}
+		steps++;
+	} while (!success);
+	success = Ecdh.GetSecret(Secret1);
+	end = micros();
+
+	if (success && ArrayMatches(Secret1, Secret2, LoLaCryptoDefinition::SHARED_KEY_SIZE))
+	{
+		Serial.print(F("Sliced Secret Key ready after "));
+		Serial.print(end - start);
+		Serial.print(F(" us, in "));
+		Serial.print(steps + 1);
+		Serial.print(F(" steps, worst step "));
+		Serial.print(worstStep);
+		Serial.println(F(" us."));
+	}
+	else
+	{
+		Serial.println(F("Sliced Secret Key calculation failed."));
+	}
+
 	start = micros();
 	uECC_compress(Public1, Public1Compressed, ECC_CURVE);
 	uECC_compress(Public2, Public2Compressed, ECC_CURVE);
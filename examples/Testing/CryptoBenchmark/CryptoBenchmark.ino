@@ -0,0 +1,537 @@
+/* LoLa Crypto Benchmark.
+* Times the per-packet encode and decode of LoLaCryptoEncoderSession,
+* for every payload size from 0 to LoLaPacketDefinition::MAX_PAYLOAD_SIZE.
+*
+* Unlinked: EncodeOutPacket/DecodeInPacket without implicit addressing, key or token (Linking).
+* Linked: EncodeOutPacket/DecodeInPacket with implicit addressing, key and token (Linked).
+* Reject: DecodeInPacket of a linked packet with a forged MAC, the cost of each spoofed or foreign packet.
+*
+* Reports cycles per packet and payload bytes per second, for each call.
+* Use the worst case to size the duplex slot, on top of the transceiver's Time-To-Air.
+*
+* Also checks that in-place (zero-copy) encode and decode match the buffered calls.
+*
+* Session key derivation: times each incremental LoLaCryptoAmSession::Calculate step,
+*  against the blocking derivation. The worst step is the longest the link's task holds the scheduler.
+*
+* Crypto backends run side by side on the same payloads, with a worst case summary for each.
+* XoodyakCryptoBackend always runs, with and without Ascon AEAD for linked packets.
+* Poly1305CryptoBackend runs with BENCHMARK_POLY1305_BACKEND.
+*
+*/
+
+#define SERIAL_BAUD_RATE 115200
+
+// Enable to also benchmark the Poly1305 backend.
+//#define BENCHMARK_POLY1305_BACKEND
+
+// Timed calls per payload size.
+#if !defined(BENCHMARK_ITERATIONS)
+#define BENCHMARK_ITERATIONS 100
+#endif
+
+#include <ILoLaInclude.h>
+#include <Arduino.h>
+#include <Crypto/LoLaCryptoAmSession.h>
+
+#if defined(BENCHMARK_POLY1305_BACKEND) || defined(LOLA_USE_POLY1305)
+#include <Crypto/Poly1305CryptoBackend.h>
+#define BENCHMARK_POLY1305
+#endif
+
+static constexpr uint8_t AccessPassword[LoLaLinkDefinition::ACCESS_CONTROL_PASSWORD_SIZE] = { 0x10, 0x01, 0x20, 0x02, 0x30, 0x03, 0x40, 0x04 };
+
+static constexpr uint8_t ServerAddress[LoLaLinkDefinition::PUBLIC_ADDRESS_SIZE] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 };
+static constexpr uint8_t ClientAddress[LoLaLinkDefinition::PUBLIC_ADDRESS_SIZE] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 };
+static constexpr uint8_t SecretKey[LoLaLinkDefinition::SECRET_KEY_SIZE] = { 0x50, 0x05, 0x60, 0x06, 0x70, 0x07, 0x80, 0x08 };
+static constexpr uint8_t SessionId[LoLaLinkDefinition::SESSION_ID_SIZE] = { 0x30, 0x03, 0x33 };
+
+static constexpr uint16_t Iterations = BENCHMARK_ITERATIONS;
+static constexpr uint32_t Timestamp = 123456789;
+
+// Linked counters start past the packet id range, to exercise the implicit high bits.
+static constexpr uint32_t LinkedCounter = (uint32_t)UINT16_MAX + 1;
+
+// Cycle source for timing. Replace with a platform cycle counter (e.g. Stm32SystemCycles) for sub-microsecond resolution.
+ArduinoCycles CyclesSource{};
+
+static constexpr uint8_t MaxDataSize = LoLaPacketDefinition::GetDataSizeFromPayloadSize(LoLaPacketDefinition::MAX_PAYLOAD_SIZE);
+
+uint8_t RawData[MaxDataSize] = { };
+uint8_t Encoded[LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE] = { };
+uint8_t DecodedData[MaxDataSize] = { };
+uint8_t InPlace[LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE] = { };
+uint8_t Forged[LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE] = { };
+
+/// <summary>
+/// Cycles for all Iterations of one call.
+/// </summary>
+struct BenchmarkResultStruct
+{
+	uint32_t EncodeUnlinked = 0;
+	uint32_t DecodeUnlinked = 0;
+	uint32_t EncodeLinked = 0;
+	uint32_t DecodeLinked = 0;
+	uint32_t RejectLinked = 0;
+};
+
+// Incremental derivation steps, enough for any hasher digest size.
+static constexpr uint8_t MaxDerivationSteps = 16;
+
+/// <summary>
+/// Cycles for all Iterations of the session key derivation.
+/// </summary>
+struct DerivationResultStruct
+{
+	uint32_t Steps[MaxDerivationSteps]{};
+	uint32_t Blocking = 0;
+	uint8_t StepCount = 0;
+};
+
+/// <summary>
+/// Server and Client sessions on one crypto backend, with their results.
+/// </summary>
+template<typename CryptoBackend>
+struct BackendBenchmark
+{
+	LoLaCryptoAmSession<CryptoBackend> ServerEncoder{};
+	LoLaCryptoAmSession<CryptoBackend> ClientEncoder{};
+
+	BenchmarkResultStruct WorstCase{};
+	DerivationResultStruct Derivation{};
+};
+
+BackendBenchmark<XoodyakCryptoBackend> XoodyakBenchmark{};
+BackendBenchmark<AsconAeadCryptoBackend<XoodyakCryptoBackend>> XoodyakAeadBenchmark{};
+#if defined(BENCHMARK_POLY1305)
+BackendBenchmark<Poly1305CryptoBackend> Poly1305Benchmark{};
+#endif
+
+bool BenchmarkOk = false;
+
+/// <summary>
+/// Encodes in place and checks the packet matches the buffered encode, then decodes it back in place.
+/// </summary>
+/// <returns>False if any in-place call diverged.</returns>
+template<typename CryptoBackend>
+const bool VerifyInPlace(BackendBenchmark<CryptoBackend>& bench, const uint8_t payloadSize, const bool linked)
+{
+	const uint8_t dataSize = LoLaPacketDefinition::GetDataSizeFromPayloadSize(payloadSize);
+	const uint8_t packetSize = LoLaPacketDefinition::GetTotalSize(payloadSize);
+	uint8_t* inPlaceData = &InPlace[(uint8_t)LoLaPacketDefinition::IndexEnum::Data];
+	uint16_t counter = 0;
+	bool accepted = false;
+
+	memcpy(inPlaceData, RawData, dataSize);
+	if (linked)
+	{
+		bench.ServerEncoder.EncodeOutPacket(RawData, Encoded, Timestamp, LinkedCounter, dataSize);
+		bench.ServerEncoder.EncodeOutPacket(inPlaceData, InPlace, Timestamp, LinkedCounter, dataSize);
+	}
+	else
+	{
+		bench.ServerEncoder.EncodeOutPacket(RawData, Encoded, 0, dataSize);
+		bench.ServerEncoder.EncodeOutPacket(inPlaceData, InPlace, 0, dataSize);
+	}
+
+	if (memcmp(Encoded, InPlace, packetSize) != 0)
+	{
+		return false;
+	}
+
+	if (linked)
+	{
+		accepted = bench.ClientEncoder.DecodeInPacket(InPlace, inPlaceData, Timestamp, LinkedCounter, dataSize);
+	}
+	else
+	{
+		accepted = bench.ClientEncoder.DecodeInPacket(InPlace, inPlaceData, counter, dataSize);
+	}
+
+	return accepted
+		&& memcmp(RawData, inPlaceData, dataSize) == 0;
+}
+
+/// <summary>
+/// Times every call for one payload size.
+/// Each encoded packet is decoded and checked once, before the decode is timed.
+/// Linked packets must also be rejected with the wrong implicit counter high bits.
+/// </summary>
+/// <returns>False if the decode rejected or corrupted the packet.</returns>
+template<typename CryptoBackend>
+const bool BenchmarkPayloadSize(BackendBenchmark<CryptoBackend>& bench, BenchmarkResultStruct& result, const uint8_t payloadSize)
+{
+	const uint8_t dataSize = LoLaPacketDefinition::GetDataSizeFromPayloadSize(payloadSize);
+	uint16_t counter = 0;
+	uint32_t start = 0;
+
+	for (uint8_t i = 0; i < dataSize; i++)
+	{
+		RawData[i] = random((uint32_t)UINT8_MAX + 1);
+	}
+
+	if (!VerifyInPlace(bench, payloadSize, false)
+		|| !VerifyInPlace(bench, payloadSize, true))
+	{
+		return false;
+	}
+
+	// Unlinked.
+	start = CyclesSource.GetCycles();
+	for (uint16_t i = 0; i < Iterations; i++)
+	{
+		bench.ServerEncoder.EncodeOutPacket(RawData, Encoded, i, dataSize);
+	}
+	result.EncodeUnlinked = CyclesSource.GetCycles() - start;
+
+	if (!bench.ClientEncoder.DecodeInPacket(Encoded, DecodedData, counter, dataSize)
+		|| counter != (uint16_t)(Iterations - 1)
+		|| memcmp(RawData, DecodedData, dataSize) != 0)
+	{
+		return false;
+	}
+
+	start = CyclesSource.GetCycles();
+	for (uint16_t i = 0; i < Iterations; i++)
+	{
+		bench.ClientEncoder.DecodeInPacket(Encoded, DecodedData, counter, dataSize);
+	}
+	result.DecodeUnlinked = CyclesSource.GetCycles() - start;
+
+	// Linked.
+	start = CyclesSource.GetCycles();
+	for (uint16_t i = 0; i < Iterations; i++)
+	{
+		bench.ServerEncoder.EncodeOutPacket(RawData, Encoded, Timestamp, LinkedCounter + i, dataSize);
+	}
+	result.EncodeLinked = CyclesSource.GetCycles() - start;
+
+	const uint32_t linkedCounter = LinkedCounter + Iterations - 1;
+	if (bench.ClientEncoder.DecodeInPacket(Encoded, DecodedData, Timestamp, linkedCounter - LinkedCounter, dataSize)
+		|| !bench.ClientEncoder.DecodeInPacket(Encoded, DecodedData, Timestamp, linkedCounter, dataSize)
+		|| memcmp(RawData, DecodedData, dataSize) != 0)
+	{
+		return false;
+	}
+
+	start = CyclesSource.GetCycles();
+	for (uint16_t i = 0; i < Iterations; i++)
+	{
+		bench.ClientEncoder.DecodeInPacket(Encoded, DecodedData, Timestamp, linkedCounter, dataSize);
+	}
+	result.DecodeLinked = CyclesSource.GetCycles() - start;
+
+	// Reject, same packet with one MAC bit flipped.
+	memcpy(Forged, Encoded, LoLaPacketDefinition::GetTotalSize(payloadSize));
+	Forged[(uint8_t)LoLaPacketDefinition::IndexEnum::Mac] ^= 0x01;
+	if (bench.ClientEncoder.DecodeInPacket(Forged, DecodedData, Timestamp, linkedCounter, dataSize))
+	{
+		return false;
+	}
+
+	start = CyclesSource.GetCycles();
+	for (uint16_t i = 0; i < Iterations; i++)
+	{
+		bench.ClientEncoder.DecodeInPacket(Forged, DecodedData, Timestamp, linkedCounter, dataSize);
+	}
+	result.RejectLinked = CyclesSource.GetCycles() - start;
+
+	return true;
+}
+
+/// <summary>
+/// Times the session key derivation, step by step and blocking.
+/// </summary>
+/// <returns>False if the incremental and blocking keys differ.</returns>
+template<typename CryptoBackend>
+const bool BenchmarkDerivation(BackendBenchmark<CryptoBackend>& bench)
+{
+	uint32_t start = 0;
+
+	for (uint16_t i = 0; i < Iterations; i++)
+	{
+		bench.ClientEncoder.SetPartnerAddressFrom(ServerAddress);
+		uint8_t step = 0;
+		while (!bench.ClientEncoder.Ready())
+		{
+			if (step >= MaxDerivationSteps)
+			{
+				return false;
+			}
+			start = CyclesSource.GetCycles();
+			bench.ClientEncoder.Calculate();
+			bench.Derivation.Steps[step++] += CyclesSource.GetCycles() - start;
+		}
+		bench.Derivation.StepCount = step;
+	}
+
+	start = CyclesSource.GetCycles();
+	for (uint16_t i = 0; i < Iterations; i++)
+	{
+		bench.ServerEncoder.CalculateExpandedKey();
+		bench.ServerEncoder.CalculateSessionAddressing();
+	}
+	bench.Derivation.Blocking = CyclesSource.GetCycles() - start;
+
+	// Both sides must still agree on the linked keys.
+	bench.ServerEncoder.EncodeOutPacket(RawData, Encoded, Timestamp, LinkedCounter, 0);
+
+	return bench.ClientEncoder.DecodeInPacket(Encoded, DecodedData, Timestamp, LinkedCounter, 0);
+}
+
+const uint32_t GetBytesPerSecond(const uint32_t cycles, const uint8_t payloadSize)
+{
+	if (cycles == 0)
+	{
+		return 0;
+	}
+
+	return ((uint64_t)payloadSize * Iterations * CyclesSource.GetCyclesOneSecond()) / cycles;
+}
+
+void PrintResult(const uint32_t cycles, const uint8_t payloadSize)
+{
+	Serial.print('\t');
+	Serial.print((float)cycles / Iterations, 2);
+	Serial.print('\t');
+	Serial.print('\t');
+	Serial.print(GetBytesPerSecond(cycles, payloadSize));
+	Serial.print('\t');
+}
+
+void PrintWorstCase(const __FlashStringHelper* label, const uint32_t cycles)
+{
+	Serial.print(label);
+	Serial.print((float)cycles / Iterations, 2);
+	Serial.print(F(" cycles\t"));
+	Serial.print(((float)cycles * ONE_SECOND_MICROS) / ((float)CyclesSource.GetCyclesOneSecond() * Iterations), 2);
+	Serial.println(F(" us"));
+}
+
+void PrintMicros(const uint32_t cycles)
+{
+	Serial.print('\t');
+	Serial.print(((float)cycles * ONE_SECOND_MICROS) / ((float)CyclesSource.GetCyclesOneSecond() * Iterations), 2);
+	Serial.print(F(" us"));
+}
+
+/// <summary>
+/// Worst step of the incremental session key derivation.
+/// </summary>
+const uint32_t GetWorstStep(const DerivationResultStruct& derivation)
+{
+	uint32_t worstStep = 0;
+	for (uint8_t i = 0; i < derivation.StepCount; i++)
+	{
+		if (derivation.Steps[i] > worstStep)
+		{
+			worstStep = derivation.Steps[i];
+		}
+	}
+
+	return worstStep;
+}
+
+template<typename CryptoBackend>
+const bool PerformBackendBenchmark(BackendBenchmark<CryptoBackend>& bench, const __FlashStringHelper* name)
+{
+	if (!bench.ServerEncoder.Setup()
+		|| !bench.ClientEncoder.Setup()
+		|| !bench.ServerEncoder.SetKeys(ServerAddress, AccessPassword, SecretKey)
+		|| !bench.ClientEncoder.SetKeys(ClientAddress, AccessPassword, SecretKey))
+	{
+		Serial.println(F("Encoder Setup fail."));
+		return false;
+	}
+
+	bench.ServerEncoder.GenerateProtocolId(
+		10000,
+		100000,
+		0xffffffff);
+	bench.ClientEncoder.GenerateProtocolId(
+		10000,
+		100000,
+		0xffffffff);
+
+	bench.ServerEncoder.SetSessionId(SessionId);
+	bench.ServerEncoder.SetPartnerAddressFrom(ClientAddress);
+
+	bench.ClientEncoder.SetSessionId(SessionId);
+	bench.ClientEncoder.SetPartnerAddressFrom(ServerAddress);
+
+	while (!bench.ServerEncoder.Ready() || !bench.ClientEncoder.Ready())
+	{
+		bench.ServerEncoder.Calculate();
+		bench.ClientEncoder.Calculate();
+	}
+
+	Serial.print(F("Backend: "));
+	Serial.println(name);
+	Serial.println();
+	if (!BenchmarkDerivation(bench))
+	{
+		Serial.println(F("Derivation fail."));
+		return false;
+	}
+
+	Serial.println(F("Session key derivation"));
+	for (uint8_t i = 0; i < bench.Derivation.StepCount; i++)
+	{
+		Serial.print(F("\tStep "));
+		Serial.print(i);
+		PrintWorstCase(F("\t"), bench.Derivation.Steps[i]);
+	}
+	PrintWorstCase(F("\tWorst step\t"), GetWorstStep(bench.Derivation));
+	PrintWorstCase(F("\tBlocking\t"), bench.Derivation.Blocking);
+	Serial.println();
+
+	Serial.println(F("Payload\tEncode Unlinked\t\tDecode Unlinked\t\tEncode Linked\t\tDecode Linked\t\tReject Linked"));
+	Serial.println(F("(bytes)\t(cycles)\t(bytes/s)\t(cycles)\t(bytes/s)\t(cycles)\t(bytes/s)\t(cycles)\t(bytes/s)\t(cycles)\t(bytes/s)"));
+
+	BenchmarkResultStruct result{};
+	for (uint8_t payloadSize = 0; payloadSize <= LoLaPacketDefinition::MAX_PAYLOAD_SIZE; payloadSize++)
+	{
+		if (!BenchmarkPayloadSize(bench, result, payloadSize))
+		{
+			Serial.print(F("Decode fail at payload size "));
+			Serial.println(payloadSize);
+			return false;
+		}
+
+		Serial.print(payloadSize);
+		PrintResult(result.EncodeUnlinked, payloadSize);
+		PrintResult(result.DecodeUnlinked, payloadSize);
+		PrintResult(result.EncodeLinked, payloadSize);
+		PrintResult(result.DecodeLinked, payloadSize);
+		PrintResult(result.RejectLinked, payloadSize);
+		Serial.println();
+
+		if (result.EncodeUnlinked > bench.WorstCase.EncodeUnlinked)
+		{
+			bench.WorstCase.EncodeUnlinked = result.EncodeUnlinked;
+		}
+		if (result.DecodeUnlinked > bench.WorstCase.DecodeUnlinked)
+		{
+			bench.WorstCase.DecodeUnlinked = result.DecodeUnlinked;
+		}
+		if (result.EncodeLinked > bench.WorstCase.EncodeLinked)
+		{
+			bench.WorstCase.EncodeLinked = result.EncodeLinked;
+		}
+		if (result.DecodeLinked > bench.WorstCase.DecodeLinked)
+		{
+			bench.WorstCase.DecodeLinked = result.DecodeLinked;
+		}
+		if (result.RejectLinked > bench.WorstCase.RejectLinked)
+		{
+			bench.WorstCase.RejectLinked = result.RejectLinked;
+		}
+	}
+
+	Serial.println();
+	Serial.println(F("Worst case per packet"));
+	PrintWorstCase(F("\tEncode Unlinked\t"), bench.WorstCase.EncodeUnlinked);
+	PrintWorstCase(F("\tDecode Unlinked\t"), bench.WorstCase.DecodeUnlinked);
+	PrintWorstCase(F("\tEncode Linked\t"), bench.WorstCase.EncodeLinked);
+	PrintWorstCase(F("\tDecode Linked\t"), bench.WorstCase.DecodeLinked);
+	PrintWorstCase(F("\tReject Linked\t"), bench.WorstCase.RejectLinked);
+	Serial.println();
+
+	return true;
+}
+
+/// <summary>
+/// One summary row, with a column per backend.
+/// </summary>
+void PrintSummary(const __FlashStringHelper* label, const uint32_t xoodyakCycles, const uint32_t xoodyakAeadCycles
+#if defined(BENCHMARK_POLY1305)
+	, const uint32_t poly1305Cycles
+#endif
+)
+{
+	Serial.print(label);
+	PrintMicros(xoodyakCycles);
+	PrintMicros(xoodyakAeadCycles);
+#if defined(BENCHMARK_POLY1305)
+	PrintMicros(poly1305Cycles);
+#endif
+	Serial.println();
+}
+
+const bool PerformBenchmark()
+{
+	CyclesSource.StartCycles();
+
+	Serial.print(F("CPU @ "));
+	Serial.print(F_CPU / 1000000);
+	Serial.println(F(" MHz"));
+	Serial.print(F("Cycles @ "));
+	Serial.print(CyclesSource.GetCyclesOneSecond());
+	Serial.println(F(" /s"));
+	Serial.print(F("Iterations "));
+	Serial.println(Iterations);
+	Serial.println();
+
+	if (!PerformBackendBenchmark(XoodyakBenchmark, F("Xoodyak")))
+	{
+		return false;
+	}
+	if (!PerformBackendBenchmark(XoodyakAeadBenchmark, F("Xoodyak AEAD")))
+	{
+		return false;
+	}
+#if defined(BENCHMARK_POLY1305)
+	if (!PerformBackendBenchmark(Poly1305Benchmark, F("Poly1305")))
+	{
+		return false;
+	}
+#endif
+
+	Serial.println(F("Backend worst case summary"));
+#if defined(BENCHMARK_POLY1305)
+	Serial.println(F("\t\t\tXoodyak\t\tXoodyak AEAD\tPoly1305"));
+	PrintSummary(F("\tEncode Unlinked\t"), XoodyakBenchmark.WorstCase.EncodeUnlinked, XoodyakAeadBenchmark.WorstCase.EncodeUnlinked, Poly1305Benchmark.WorstCase.EncodeUnlinked);
+	PrintSummary(F("\tDecode Unlinked\t"), XoodyakBenchmark.WorstCase.DecodeUnlinked, XoodyakAeadBenchmark.WorstCase.DecodeUnlinked, Poly1305Benchmark.WorstCase.DecodeUnlinked);
+	PrintSummary(F("\tEncode Linked\t"), XoodyakBenchmark.WorstCase.EncodeLinked, XoodyakAeadBenchmark.WorstCase.EncodeLinked, Poly1305Benchmark.WorstCase.EncodeLinked);
+	PrintSummary(F("\tDecode Linked\t"), XoodyakBenchmark.WorstCase.DecodeLinked, XoodyakAeadBenchmark.WorstCase.DecodeLinked, Poly1305Benchmark.WorstCase.DecodeLinked);
+	PrintSummary(F("\tReject Linked\t"), XoodyakBenchmark.WorstCase.RejectLinked, XoodyakAeadBenchmark.WorstCase.RejectLinked, Poly1305Benchmark.WorstCase.RejectLinked);
+	PrintSummary(F("\tDerivation step\t"), GetWorstStep(XoodyakBenchmark.Derivation), GetWorstStep(XoodyakAeadBenchmark.Derivation), GetWorstStep(Poly1305Benchmark.Derivation));
+#else
+	Serial.println(F("\t\t\tXoodyak\t\tXoodyak AEAD"));
+	PrintSummary(F("\tEncode Unlinked\t"), XoodyakBenchmark.WorstCase.EncodeUnlinked, XoodyakAeadBenchmark.WorstCase.EncodeUnlinked);
+	PrintSummary(F("\tDecode Unlinked\t"), XoodyakBenchmark.WorstCase.DecodeUnlinked, XoodyakAeadBenchmark.WorstCase.DecodeUnlinked);
+	PrintSummary(F("\tEncode Linked\t"), XoodyakBenchmark.WorstCase.EncodeLinked, XoodyakAeadBenchmark.WorstCase.EncodeLinked);
+	PrintSummary(F("\tDecode Linked\t"), XoodyakBenchmark.WorstCase.DecodeLinked, XoodyakAeadBenchmark.WorstCase.DecodeLinked);
+	PrintSummary(F("\tReject Linked\t"), XoodyakBenchmark.WorstCase.RejectLinked, XoodyakAeadBenchmark.WorstCase.RejectLinked);
+	PrintSummary(F("\tDerivation step\t"), GetWorstStep(XoodyakBenchmark.Derivation), GetWorstStep(XoodyakAeadBenchmark.Derivation));
+#endif
+
+	return true;
+}
+
+void setup()
+{
+	Serial.begin(SERIAL_BAUD_RATE);
+	while (!Serial)
+		;
+	delay(1000);
+
+	Serial.println(F("LoLa Crypto Benchmark starting."));
+
+	BenchmarkOk = PerformBenchmark();
+
+	Serial.println();
+	if (BenchmarkOk)
+	{
+		Serial.println(F("LoLa Crypto Benchmark completed with success."));
+	}
+	else
+	{
+		Serial.println(F("LoLa Crypto Benchmark FAILED."));
+	}
+	Serial.println();
+}
+
+void loop()
+{
+}
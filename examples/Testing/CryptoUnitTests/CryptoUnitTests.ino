@@ -18,8 +18,8 @@ static constexpr uint8_t ClientAddress[LoLaLinkDefinition::PUBLIC_ADDRESS_SIZE]
 static constexpr uint8_t SecretKey[LoLaLinkDefinition::SECRET_KEY_SIZE] = { 0x50, 0x05, 0x60, 0x06, 0x70, 0x07, 0x80, 0x08 };
 static constexpr uint8_t SessionId[LoLaLinkDefinition::SESSION_ID_SIZE] = { 0x30, 0x03, 0x33 };
 
-LoLaCryptoAmSession ServerEncoder(SecretKey, AccessPassword, ServerAddress);
-LoLaCryptoAmSession ClientEncoder(SecretKey, AccessPassword, ClientAddress);
+LoLaCryptoAmSession<> ServerEncoder(SecretKey, AccessPassword, ServerAddress);
+LoLaCryptoAmSession<> ClientEncoder(SecretKey, AccessPassword, ClientAddress);
 
 uint8_t ClientLinkingToken[LoLaLinkDefinition::LINKING_TOKEN_SIZE]{};
 
@@ -0,0 +1,248 @@
+/* LoLa PKE Session test.
+* Pairs two LoLaCryptoPkeSession from fixed secp160r1 key pairs, one Calculate step at a time,
+*  and checks linked packets round-trip both ways.
+*
+* Also checks that:
+*	- Re-pairing with the same partner key reuses the cached shared secret, skipping the ECDH steps.
+*	- An impostor with the partner's public key but another private key can't decode.
+*	- A wrong access password can't decode.
+*	- The local public key and an off-curve key are rejected as partner keys.
+*
+* Requires micro-ecc with uECC_ENABLE_VLI_API=1.
+*/
+
+#define SERIAL_BAUD_RATE 115200
+
+#include <ILoLaInclude.h>
+#include <Arduino.h>
+
+/*
+* https://github.com/kmackay/micro-ecc
+*/
+#include <uECC.h>
+#include <Experimental/LoLaCryptoPkeSession.h>
+
+static constexpr uint8_t AccessPassword[LoLaLinkDefinition::ACCESS_CONTROL_PASSWORD_SIZE] = { 0x10, 0x01, 0x20, 0x02, 0x30, 0x03, 0x40, 0x04 };
+static constexpr uint8_t WrongPassword[LoLaLinkDefinition::ACCESS_CONTROL_PASSWORD_SIZE] = { 0x10, 0x01, 0x20, 0x02, 0x30, 0x03, 0x40, 0x05 };
+
+static constexpr uint8_t ServerPrivateKey[LoLaCryptoDefinition::PRIVATE_KEY_SIZE] = {
+	0x00, 0xBD, 0xC3, 0x2A, 0x70, 0x36, 0x76, 0x12, 0x92, 0xD1,
+	0xC1, 0xCF, 0x57, 0xE8, 0x4F, 0xE7, 0x46, 0x89, 0xF7, 0x58,
+	0x3E };
+static constexpr uint8_t ClientPrivateKey[LoLaCryptoDefinition::PRIVATE_KEY_SIZE] = {
+	0x00, 0xD5, 0x3B, 0x17, 0xAE, 0x4A, 0x02, 0xF4, 0x2B, 0x74,
+	0x4F, 0x44, 0x75, 0x5E, 0x78, 0x46, 0x30, 0x82, 0x00, 0x71,
+	0x73 };
+static constexpr uint8_t ImpostorPrivateKey[LoLaCryptoDefinition::PRIVATE_KEY_SIZE] = {
+	0x00, 0x5E, 0xB5, 0xFA, 0x61, 0x49, 0x65, 0xB8, 0xFD, 0x95,
+	0xC7, 0x29, 0xD0, 0x65, 0x18, 0x35, 0xE9, 0x00, 0xDA, 0xDD,
+	0x14 };
+
+// x is past the field prime, so it can't be on the curve.
+static constexpr uint8_t OffCurveKey[LoLaCryptoDefinition::COMPRESSED_KEY_SIZE] = {
+	0x02, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF };
+
+static constexpr uint8_t SessionId1[LoLaLinkDefinition::SESSION_ID_SIZE] = { 0x30, 0x03, 0x33 };
+static constexpr uint8_t SessionId2[LoLaLinkDefinition::SESSION_ID_SIZE] = { 0x40, 0x04, 0x44 };
+
+static constexpr uint32_t Timestamp = 123456789;
+static constexpr uint32_t Counter = 1234;
+
+// ECDH at 4 bits per step, on top of the key decompression, key derivation and prefixes.
+static constexpr uint16_t EcdhSteps = SlicedEcdh<4>::GetStepCount(LoLaCryptoDefinition::PKE_CURVE_SIZE + 1) + 1;
+static constexpr uint16_t MaxSteps = EcdhSteps + 32;
+
+static constexpr uint8_t DataSize = LoLaPacketDefinition::GetDataSizeFromPayloadSize(LoLaPacketDefinition::MAX_PAYLOAD_SIZE);
+
+uint8_t ServerPublicKey[LoLaCryptoDefinition::PUBLIC_KEY_SIZE]{};
+uint8_t ClientPublicKey[LoLaCryptoDefinition::PUBLIC_KEY_SIZE]{};
+
+uint8_t ServerCompressedKey[LoLaCryptoDefinition::COMPRESSED_KEY_SIZE]{};
+uint8_t ClientCompressedKey[LoLaCryptoDefinition::COMPRESSED_KEY_SIZE]{};
+
+uint8_t RawData[DataSize]{};
+uint8_t Encoded[LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE]{};
+uint8_t Decoded[DataSize]{};
+
+LoLaCryptoPkeSession<> ServerSession{};
+LoLaCryptoPkeSession<> ClientSession{};
+LoLaCryptoPkeSession<> IntruderSession{};
+
+bool TestOk = false;
+
+void SetProtocol(LoLaCryptoPkeSession<>& session, const uint8_t* sessionId)
+{
+	session.GenerateProtocolId(10000, 0, 0x1234);
+	session.SetSessionId(sessionId);
+}
+
+/// <summary>
+/// Runs both sessions one step at a time, until both are ready.
+/// </summary>
+/// <returns>Step count, MaxSteps if either session didn't get ready.</returns>
+const uint16_t Pair(LoLaCryptoPkeSession<>& server, LoLaCryptoPkeSession<>& client,
+	const uint8_t* serverCompressedKey, const uint8_t* sessionId)
+{
+	SetProtocol(server, sessionId);
+	SetProtocol(client, sessionId);
+
+	server.ResetPke();
+	client.ResetPke();
+	server.SetPartnerPublicKeyFrom(ClientCompressedKey);
+	client.SetPartnerPublicKeyFrom(serverCompressedKey);
+
+	uint16_t steps = 0;
+	while ((!server.Ready() || !client.Ready())
+		&& steps < MaxSteps)
+	{
+		server.Calculate();
+		client.Calculate();
+		steps++;
+	}
+
+	return steps;
+}
+
+/// <returns>True if a linked packet from the sender decodes at the receiver, back to the same data.</returns>
+const bool RoundTrip(LoLaCryptoPkeSession<>& sender, LoLaCryptoPkeSession<>& receiver)
+{
+	for (uint8_t i = 0; i < DataSize; i++)
+	{
+		RawData[i] = random((uint32_t)UINT8_MAX + 1);
+	}
+
+	sender.EncodeOutPacket(RawData, Encoded, Timestamp, Counter, DataSize);
+
+	return receiver.DecodeInPacket(Encoded, Decoded, Timestamp, Counter, DataSize)
+		&& memcmp(RawData, Decoded, DataSize) == 0;
+}
+
+/// <returns>True if the partner key is dropped on the first Calculate.</returns>
+const bool Rejects(LoLaCryptoPkeSession<>& session, const uint8_t* compressedKey)
+{
+	session.ResetPke();
+	session.SetPartnerPublicKeyFrom(compressedKey);
+	session.Calculate();
+
+	return !session.HasPartner();
+}
+
+const bool PerformTest()
+{
+	const uECC_Curve curve = uECC_secp160r1();
+	uint8_t impostorPublicKey[LoLaCryptoDefinition::PUBLIC_KEY_SIZE]{};
+	bool success = true;
+
+	if (!uECC_compute_public_key(ServerPrivateKey, ServerPublicKey, curve)
+		|| !uECC_compute_public_key(ClientPrivateKey, ClientPublicKey, curve)
+		|| !uECC_compute_public_key(ImpostorPrivateKey, impostorPublicKey, curve))
+	{
+		Serial.println(F("Public key generation failed."));
+		return false;
+	}
+
+	if (!ServerSession.Setup()
+		|| !ClientSession.Setup()
+		|| !IntruderSession.Setup()
+		|| !ServerSession.SetKeys(AccessPassword, ServerPublicKey, ServerPrivateKey)
+		|| !ClientSession.SetKeys(AccessPassword, ClientPublicKey, ClientPrivateKey))
+	{
+		Serial.println(F("Session setup failed."));
+		return false;
+	}
+	ServerSession.CompressPublicKeyTo(ServerCompressedKey);
+	ClientSession.CompressPublicKeyTo(ClientCompressedKey);
+
+	uint16_t steps = Pair(ServerSession, ClientSession, ServerCompressedKey, SessionId1);
+	Serial.print(F("First pairing took "));
+	Serial.print(steps);
+	Serial.println(F(" steps."));
+	if (steps >= MaxSteps
+		|| steps <= EcdhSteps)
+	{
+		Serial.println(F("\tFirst pairing failed."));
+		success = false;
+	}
+	else if (!RoundTrip(ServerSession, ClientSession)
+		|| !RoundTrip(ClientSession, ServerSession))
+	{
+		Serial.println(F("\tFirst pairing round trip failed."));
+		success = false;
+	}
+
+	steps = Pair(ServerSession, ClientSession, ServerCompressedKey, SessionId2);
+	Serial.print(F("Cached pairing took "));
+	Serial.print(steps);
+	Serial.println(F(" steps."));
+	if (steps >= EcdhSteps)
+	{
+		Serial.println(F("\tCached pairing failed."));
+		success = false;
+	}
+	else if (!RoundTrip(ServerSession, ClientSession)
+		|| !RoundTrip(ClientSession, ServerSession))
+	{
+		Serial.println(F("\tCached pairing round trip failed."));
+		success = false;
+	}
+
+	// Impostor claims the Client's public key, without its private key.
+	if (!IntruderSession.SetKeys(AccessPassword, ClientPublicKey, ImpostorPrivateKey)
+		|| Pair(ServerSession, IntruderSession, ServerCompressedKey, SessionId1) >= MaxSteps
+		|| RoundTrip(ServerSession, IntruderSession)
+		|| RoundTrip(IntruderSession, ServerSession))
+	{
+		Serial.println(F("\tImpostor wasn't rejected."));
+		success = false;
+	}
+
+	if (!IntruderSession.SetKeys(WrongPassword, ClientPublicKey, ClientPrivateKey)
+		|| Pair(ServerSession, IntruderSession, ServerCompressedKey, SessionId1) >= MaxSteps
+		|| RoundTrip(ServerSession, IntruderSession)
+		|| RoundTrip(IntruderSession, ServerSession))
+	{
+		Serial.println(F("\tWrong password wasn't rejected."));
+		success = false;
+	}
+
+	if (!Rejects(ServerSession, ServerCompressedKey))
+	{
+		Serial.println(F("\tLocal public key wasn't rejected."));
+		success = false;
+	}
+
+	if (!Rejects(ServerSession, OffCurveKey))
+	{
+		Serial.println(F("\tOff-curve public key wasn't rejected."));
+		success = false;
+	}
+
+	return success;
+}
+
+void setup()
+{
+	Serial.begin(SERIAL_BAUD_RATE);
+	while (!Serial)
+		;
+	delay(1000);
+
+	Serial.println(F("LoLa PKE Session Test starting."));
+
+	TestOk = PerformTest();
+
+	if (TestOk)
+	{
+		Serial.println(F("LoLa PKE Session Test completed with success."));
+	}
+	else
+	{
+		Serial.println(F("LoLa PKE Session Test FAILED."));
+	}
+}
+
+void loop()
+{
+}
@@ -0,0 +1,134 @@
+/* LoLa anti-replay window test.
+* Runs a fixed sequence of receive counters through LinkReplayWindow and checks, for each one:
+*	- Accepted or rejected.
+*	- How many counters were accounted as lost.
+*
+* Covers out of order packets inside the window (accepted once), duplicates,
+*  packets too old for the window, jumps past the window and the 16 bit id extension.
+*/
+
+#define SERIAL_BAUD_RATE 115200
+
+#include <ILoLaInclude.h>
+#include <Arduino.h>
+
+#include <Link/LinkReplayWindow.h>
+
+static_assert(LoLaLinkDefinition::RX_REPLAY_WINDOW_SIZE == 32, "Test sequence assumes a 32 counter window.");
+
+struct ReplayStep
+{
+	uint32_t Counter;
+	bool Accepted;
+	uint16_t Lost;
+};
+
+static constexpr ReplayStep Steps[] = {
+	{ 1000, true, 0 },	// Anchor, everything before it counts as received.
+	{ 1001, true, 0 },
+	{ 1004, true, 0 },	// Skips 1002 and 1003, not lost while inside the window.
+	{ 1002, true, 0 },	// Out of order, inside the window.
+	{ 1002, false, 0 },	// Replay of the out of order packet.
+	{ 1004, false, 0 },	// Replay of the latest.
+	{ 1001, false, 0 },	// Replay of an older one.
+	{ 1005, true, 0 },
+	{ 1035, true, 1 },	// Window slides past 1003, never received.
+	{ 1003, false, 0 },	// Too old, left the window.
+	{ 1004, false, 0 },	// Oldest in the window, already received.
+	{ 1034, true, 0 },	// Out of order, inside the window.
+	{ 1075, true, 36 },	// Jump past the whole window: 1006 to 1033 and 1036 to 1043.
+	{ 1044, true, 0 },	// Oldest in the window, skipped by the jump.
+	{ 1043, false, 0 },	// Too old, already accounted as lost.
+	{ 1075 + 40000, false, 0 },	// Too far ahead, taken as behind.
+};
+
+static constexpr uint8_t StepCount = sizeof(Steps) / sizeof(ReplayStep);
+
+LinkReplayWindow ReplayWindow{};
+
+bool TestOk = false;
+
+const bool TestSteps()
+{
+	bool success = true;
+
+	for (uint8_t i = 0; i < StepCount; i++)
+	{
+		uint16_t lost = UINT16_MAX;
+		const bool accepted = ReplayWindow.Validate(Steps[i].Counter, lost);
+
+		if (accepted != Steps[i].Accepted
+			|| lost != Steps[i].Lost)
+		{
+			Serial.print(F("\tStep "));
+			Serial.print(i);
+			Serial.print(F(" counter "));
+			Serial.print(Steps[i].Counter);
+			Serial.print(accepted ? F(" accepted") : F(" rejected"));
+			Serial.print(F(" lost "));
+			Serial.println(lost);
+			success = false;
+		}
+	}
+
+	return success;
+}
+
+const bool TestIdExtension()
+{
+	uint16_t lost = 0;
+
+	// Anchored just below the 16 bit roll over.
+	ReplayWindow.Reset();
+	if (ReplayWindow.GetReceivingCounter(65530) != 65530
+		|| !ReplayWindow.Validate(65530, lost))
+	{
+		Serial.println(F("\tRe-anchor failed."));
+		return false;
+	}
+
+	if (ReplayWindow.GetReceivingCounter(3) != ((uint32_t)UINT16_MAX + 4)
+		|| ReplayWindow.GetReceivingCounter(65500) != 65500)
+	{
+		Serial.println(F("\tId extension failed."));
+		return false;
+	}
+
+	// Past the roll over, the same ids extend to the new high bits.
+	if (!ReplayWindow.Validate(ReplayWindow.GetReceivingCounter(3), lost)
+		|| lost != 0
+		|| ReplayWindow.GetReceivingCounter(65531) != 65531
+		|| ReplayWindow.Validate(ReplayWindow.GetReceivingCounter(65530), lost))
+	{
+		Serial.println(F("\tRoll over failed."));
+		return false;
+	}
+
+	return true;
+}
+
+void setup()
+{
+	Serial.begin(SERIAL_BAUD_RATE);
+	while (!Serial)
+		;
+	delay(1000);
+
+	Serial.println(F("LoLa Replay Window Test starting."));
+
+	TestOk = TestSteps();
+	TestOk &= TestIdExtension();
+
+	if (TestOk)
+	{
+		Serial.println(F("LoLa Replay Window Test completed with success."));
+	}
+	else
+	{
+		Serial.println(F("LoLa Replay Window Test FAILED."));
+	}
+}
+
+void loop()
+{
+}
@@ -0,0 +1,206 @@
+/* LoLa Sliced ECDH test.
+* Checks SlicedEcdh against uECC_shared_secret, on fixed secp160r1 known answer vectors.
+* The expected secrets are from an independent reference implementation of the curve.
+*
+* Each vector runs with the default 4 bits per step and with 7 bits per step,
+*  which doesn't divide the scalar length, so the last ladder step is partial.
+* Also checks the step count and that GetSecret wipes the working state.
+*
+* Requires micro-ecc with uECC_ENABLE_VLI_API=1.
+*/
+
+#define SERIAL_BAUD_RATE 115200
+
+#include <Arduino.h>
+
+/*
+* https://github.com/kmackay/micro-ecc
+*/
+#include <uECC.h>
+#include <Experimental/SlicedEcdh.h>
+
+static constexpr uint8_t PUBLIC_KEY_SIZE = 40;
+static constexpr uint8_t PRIVATE_KEY_SIZE = 21;
+static constexpr uint8_t SHARED_KEY_SIZE = 20;
+static constexpr uint16_t ORDER_BITS = 161;
+
+/// <summary>
+/// Partner's uncompressed public key, local private key and the expected shared secret.
+/// </summary>
+struct EcdhVectorStruct
+{
+	uint8_t PartnerPublicKey[PUBLIC_KEY_SIZE];
+	uint8_t PrivateKey[PRIVATE_KEY_SIZE];
+	uint8_t Secret[SHARED_KEY_SIZE];
+};
+
+static const EcdhVectorStruct Vectors[] =
+{
+	// Random keys.
+	{
+		{ 0x06, 0x34, 0x39, 0xD2, 0x62, 0xF5, 0x44, 0xAC, 0xFD, 0x38,
+			0x28, 0x21, 0x6C, 0x45, 0x06, 0x61, 0xB5, 0x16, 0xCC, 0x49,
+			0x82, 0x0F, 0x3D, 0x4F, 0x8C, 0x50, 0x76, 0x17, 0x82, 0x57,
+			0xA3, 0x4C, 0x98, 0x7E, 0xDA, 0xA9, 0xB9, 0xB4, 0xF0, 0x1E },
+		{ 0x00, 0xBD, 0xC3, 0x2A, 0x70, 0x36, 0x76, 0x12, 0x92, 0xD1,
+			0xC1, 0xCF, 0x57, 0xE8, 0x4F, 0xE7, 0x46, 0x89, 0xF7, 0x58,
+			0x3E },
+		{ 0xBF, 0x4D, 0x2A, 0xBB, 0xBF, 0xC6, 0xA7, 0x7C, 0x76, 0xC4,
+			0xFA, 0x1D, 0x1F, 0xD8, 0xBC, 0x72, 0x0F, 0x10, 0x8B, 0x98 }
+	},
+	// Random keys.
+	{
+		{ 0x51, 0xF4, 0xE6, 0xE6, 0x22, 0x86, 0x5B, 0x69, 0xF6, 0x2B,
+			0xA3, 0x92, 0x25, 0xB8, 0xF9, 0xA6, 0xBE, 0x46, 0x7D, 0xDE,
+			0x08, 0x95, 0xB0, 0xEC, 0xEF, 0xBC, 0x55, 0xB8, 0x32, 0xDC,
+			0xCE, 0xCD, 0x28, 0x46, 0xB8, 0x64, 0xC3, 0x96, 0xD3, 0xFC },
+		{ 0x00, 0xD5, 0x3B, 0x17, 0xAE, 0x4A, 0x02, 0xF4, 0x2B, 0x74,
+			0x4F, 0x44, 0x75, 0x5E, 0x78, 0x46, 0x30, 0x82, 0x00, 0x71,
+			0x73 },
+		{ 0x0C, 0x23, 0xB4, 0x29, 0xFA, 0xCB, 0x2F, 0xA6, 0xE8, 0x70,
+			0xA4, 0x7E, 0x2F, 0x52, 0x29, 0x2E, 0x07, 0xC5, 0xA0, 0xE6 }
+	},
+	// Short private key, the regularized scalar covers the leading zero bits.
+	{
+		{ 0x88, 0xDE, 0xA9, 0x25, 0xD1, 0x64, 0x68, 0xB8, 0x99, 0xA7,
+			0xE6, 0x73, 0x5C, 0x47, 0x1C, 0x0C, 0xAD, 0x9C, 0x02, 0xC0,
+			0x5B, 0x7F, 0xD6, 0x0F, 0x93, 0xC5, 0x24, 0x54, 0xFD, 0x7B,
+			0x4B, 0xEA, 0xA2, 0x3A, 0x51, 0x53, 0x33, 0x52, 0x85, 0x71 },
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+			0x00, 0x00, 0x00, 0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD,
+			0xEF },
+		{ 0x7E, 0x1F, 0x18, 0x11, 0xF5, 0xDA, 0x00, 0x2A, 0x04, 0x23,
+			0xBF, 0x81, 0x18, 0x87, 0x55, 0x84, 0xD0, 0xC7, 0xF9, 0x23 }
+	},
+	// Private key with the top bit set.
+	{
+		{ 0x88, 0xDE, 0xA9, 0x25, 0xD1, 0x64, 0x68, 0xB8, 0x99, 0xA7,
+			0xE6, 0x73, 0x5C, 0x47, 0x1C, 0x0C, 0xAD, 0x9C, 0x02, 0xC0,
+			0x5B, 0x7F, 0xD6, 0x0F, 0x93, 0xC5, 0x24, 0x54, 0xFD, 0x7B,
+			0x4B, 0xEA, 0xA2, 0x3A, 0x51, 0x53, 0x33, 0x52, 0x85, 0x71 },
+		{ 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+			0x00, 0xF4, 0xC8, 0xF9, 0x27, 0xAE, 0xD3, 0xCA, 0x74, 0xF2,
+			0x1E },
+		{ 0x7D, 0x2C, 0xAD, 0xB4, 0x0D, 0x47, 0x57, 0xC6, 0xE7, 0x7F,
+			0x4B, 0x5E, 0x68, 0x0C, 0x54, 0x98, 0x4D, 0x47, 0x67, 0x4A }
+	},
+	// Partner key is the generator.
+	{
+		{ 0x4A, 0x96, 0xB5, 0x68, 0x8E, 0xF5, 0x73, 0x28, 0x46, 0x64,
+			0x69, 0x89, 0x68, 0xC3, 0x8B, 0xB9, 0x13, 0xCB, 0xFC, 0x82,
+			0x23, 0xA6, 0x28, 0x55, 0x31, 0x68, 0x94, 0x7D, 0x59, 0xDC,
+			0xC9, 0x12, 0x04, 0x23, 0x51, 0x37, 0x7A, 0xC5, 0xFB, 0x32 },
+		{ 0x00, 0x5E, 0xB5, 0xFA, 0x61, 0x49, 0x65, 0xB8, 0xFD, 0x95,
+			0xC7, 0x29, 0xD0, 0x65, 0x18, 0x35, 0xE9, 0x00, 0xDA, 0xDD,
+			0x14 },
+		{ 0xFF, 0xDE, 0x10, 0x3F, 0x8B, 0xD3, 0xDB, 0xE0, 0x92, 0x48,
+			0xC0, 0x41, 0x97, 0xA7, 0x45, 0x4E, 0x37, 0xFE, 0x46, 0xCB }
+	}
+};
+
+static constexpr uint8_t VectorCount = sizeof(Vectors) / sizeof(EcdhVectorStruct);
+
+bool TestOk = false;
+
+const bool ArrayMatches(const uint8_t* a, const uint8_t* b, const size_t size)
+{
+	for (size_t i = 0; i < size; i++)
+	{
+		if (a[i] != b[i])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+template<const uint8_t BitsPerStep>
+const bool TestSliced(const EcdhVectorStruct& vector, uECC_Curve curve)
+{
+	SlicedEcdh<BitsPerStep> ecdh{};
+	uint8_t secret[SHARED_KEY_SIZE]{};
+	uint16_t steps = 0;
+
+	ecdh.Start(vector.PartnerPublicKey, vector.PrivateKey, curve);
+	do
+	{
+		steps++;
+	} while (!ecdh.Step() && steps <= SlicedEcdh<BitsPerStep>::GetStepCount(ORDER_BITS));
+
+	if (steps != SlicedEcdh<BitsPerStep>::GetStepCount(ORDER_BITS))
+	{
+		Serial.print(F("\tStep count "));
+		Serial.print(steps);
+		Serial.print(F(" expected "));
+		Serial.println(SlicedEcdh<BitsPerStep>::GetStepCount(ORDER_BITS));
+		return false;
+	}
+
+	if (!ecdh.GetSecret(secret)
+		|| !ArrayMatches(secret, vector.Secret, SHARED_KEY_SIZE))
+	{
+		Serial.print(F("\tSliced secret mismatch, "));
+		Serial.print(BitsPerStep);
+		Serial.println(F(" bits per step."));
+		return false;
+	}
+
+	// The working state must be wiped once the secret is read.
+	if (ecdh.IsDone() || ecdh.IsBusy() || ecdh.GetSecret(secret))
+	{
+		Serial.println(F("\tWorking state not cleared."));
+		return false;
+	}
+
+	return true;
+}
+
+const bool PerformTest()
+{
+	const uECC_Curve curve = uECC_secp160r1();
+	uint8_t secret[SHARED_KEY_SIZE]{};
+	bool success = true;
+
+	for (uint8_t i = 0; i < VectorCount; i++)
+	{
+		Serial.print(F("Vector "));
+		Serial.println(i);
+
+		if (!uECC_shared_secret(Vectors[i].PartnerPublicKey, Vectors[i].PrivateKey, secret, curve)
+			|| !ArrayMatches(secret, Vectors[i].Secret, SHARED_KEY_SIZE))
+		{
+			Serial.println(F("\tuECC_shared_secret mismatch."));
+			success = false;
+		}
+
+		success &= TestSliced<4>(Vectors[i], curve);
+		success &= TestSliced<7>(Vectors[i], curve);
+	}
+
+	return success;
+}
+
+void setup()
+{
+	Serial.begin(SERIAL_BAUD_RATE);
+	while (!Serial)
+		;
+	delay(1000);
+
+	Serial.println(F("LoLa Sliced ECDH Test starting."));
+
+	TestOk = PerformTest();
+
+	if (TestOk)
+	{
+		Serial.println(F("LoLa Sliced ECDH Test completed with success."));
+	}
+	else
+	{
+		Serial.println(F("LoLa Sliced ECDH Test FAILED."));
+	}
+}
+
+void loop()
+{
+}
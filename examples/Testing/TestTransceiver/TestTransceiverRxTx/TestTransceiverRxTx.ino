@@ -27,8 +27,8 @@
 
 #include <ILoLaInclude.h>
 
-#include "Testing\ExampleTransceiverDefinitions.h"
-#include "Testing\ExampleLogicAnalyserDefinitions.h"
+#include "Testing/ExampleTransceiverDefinitions.h"
+#include "Testing/ExampleLogicAnalyserDefinitions.h"
 
 #include "TransmitReceiveTester.h"
 
@@ -9,7 +9,7 @@
 #include <ILoLaInclude.h>
 #include <Arduino.h>
 
-#include "Link\LoLaPacketService.h"
+#include "Link/LoLaPacketService.h"
 
 template<const bool TxEnabled = false,
 	const uint8_t TxActivePin = UINT8_MAX>
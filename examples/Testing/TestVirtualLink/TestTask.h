@@ -20,6 +20,7 @@ private:
 	static constexpr uint8_t PayloadSize = 1;
 	static constexpr uint32_t HearBeatPeriod = 1000;
 	static constexpr uint32_t PingPeriod = 1234;
+	static constexpr uint32_t CheckPeriod = 1;
 
 private:
 	uint32_t RxCount = 0;
@@ -64,7 +65,7 @@ public:
 
 	virtual bool Callback() final
 	{
-		TS::Task::delay(0);
+		TS::Task::delay(CheckPeriod);
 		Server->GetLinkStatus(ServerStatus);
 		ServerStatus.OnUpdate();
 
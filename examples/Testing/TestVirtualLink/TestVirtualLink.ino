@@ -22,6 +22,9 @@
 // Enable for experimental faster hash.
 //#define LOLA_USE_POLY1305
 
+// Enable for single pass AEAD on linked packets.
+//#define LOLA_USE_ASCON_AEAD
+
 // Enable to use channel hop. Disable for fixed channel.
 #define LINK_USE_CHANNEL_HOP
 
@@ -40,6 +43,19 @@
 // Test Delivery Service.
 //#define LINK_TEST_DELIVERY
 
+// Test Fragment Service.
+//#define LINK_TEST_FRAGMENT
+
+// Use compile-time registries for the Fragment test services.
+//#define LINK_TEST_STATIC_REGISTRY
+
+// Test small payload services, aggregated into the same packets.
+//#define LINK_TEST_AGGREGATE
+
+// Use the experimental Public Key Exchange links, instead of Address Match.
+// Depends on https://github.com/kmackay/micro-ecc with uECC_ENABLE_VLI_API=1
+//#define LINK_TEST_PKE
+
 // Enable to log raw packets in transit.
 //#define PRINT_PACKETS
 
@@ -49,6 +65,10 @@
 //#define DOUBLE_SEND_CHANCE 10
 //#define ECO_CHANCE 5
 
+// Medium Simulation fade, all packets are lost for the duration, every period.
+//#define FADE_PERIOD_MILLIS 10000
+//#define FADE_DURATION_MILLIS 2000
+
 // DROP_LINK_TEST period in seconds. Disable for no test link drop.
 //#define SERVER_DROP_LINK_TEST 5
 //#define CLIENT_DROP_LINK_TEST 5
@@ -78,6 +98,23 @@
 #if defined(LINK_TEST_DELIVERY)
 #include "../src/Testing/DeliveryTestService.h"
 #endif
+#if defined(LINK_TEST_FRAGMENT)
+#include "../src/Testing/FragmentTestService.h"
+#endif
+#if defined(LINK_TEST_AGGREGATE)
+#include "../src/Testing/AggregateTestService.h"
+#endif
+#if defined(LINK_TEST_STATIC_REGISTRY) && !defined(LINK_TEST_FRAGMENT)
+#error LINK_TEST_STATIC_REGISTRY requires LINK_TEST_FRAGMENT.
+#endif
+#if defined(LINK_TEST_PKE)
+#if defined(LINK_TEST_STATIC_REGISTRY)
+#error LINK_TEST_PKE requires the default registries, disable LINK_TEST_STATIC_REGISTRY.
+#endif
+#include <uECC.h>
+#include <Experimental/LolaPkeLink/LoLaPkeLinkServer.h>
+#include <Experimental/LolaPkeLink/LoLaPkeLinkClient.h>
+#endif
 
 #if defined(LINK_TEST_SURFACE)
 #include "../src/Testing/ExampleSurface.h"
@@ -104,6 +141,20 @@ static constexpr uint8_t AccessPassword[LoLaLinkDefinition::ACCESS_CONTROL_PASSW
 static constexpr uint8_t SecretKey[LoLaLinkDefinition::SECRET_KEY_SIZE] = { 0x50, 0x05, 0x60, 0x06, 0x70, 0x07, 0x80, 0x08 };
 //
 
+#if defined(LINK_TEST_PKE)
+// secp160r1 private keys, public keys are computed on setup.
+static constexpr uint8_t ServerPrivateKey[LoLaCryptoDefinition::PRIVATE_KEY_SIZE] = {
+	0x00, 0xBD, 0xC3, 0x2A, 0x70, 0x36, 0x76, 0x12, 0x92, 0xD1,
+	0xC1, 0xCF, 0x57, 0xE8, 0x4F, 0xE7, 0x46, 0x89, 0xF7, 0x58,
+	0x3E };
+static constexpr uint8_t ClientPrivateKey[LoLaCryptoDefinition::PRIVATE_KEY_SIZE] = {
+	0x00, 0xD5, 0x3B, 0x17, 0xAE, 0x4A, 0x02, 0xF4, 0x2B, 0x74,
+	0x4F, 0x44, 0x75, 0x5E, 0x78, 0x46, 0x30, 0x82, 0x00, 0x71,
+	0x73 };
+uint8_t ServerPublicKey[LoLaCryptoDefinition::PUBLIC_KEY_SIZE]{};
+uint8_t ClientPublicKey[LoLaCryptoDefinition::PUBLIC_KEY_SIZE]{};
+#endif
+
 // Virtual Transceiver configurations.
 // <ChannelCount, TxBaseMicros, TxByteNanos, AirBaseMicros, AirByteNanos, HopMicros>
 using SlowSingleChannel = IVirtualTransceiver::Configuration<1, 50, 4000, 700, 35000, 100>;
@@ -145,11 +196,23 @@ NoHopNoChannel ClientChannelHop{};
 #endif
 ///
 
+// Link types, with their listener registry.
+#if defined(LINK_TEST_PKE)
+using ServerLinkType = LoLaPkeLinkServer<>;
+using ClientLinkType = LoLaPkeLinkClient<>;
+#elif defined(LINK_TEST_STATIC_REGISTRY)
+using ServerLinkType = LoLaAddressMatchLinkServer<0, 0, false, StaticLinkRegistry<1, FragmentTestService<'S', 2, 234567, true>>>;
+using ClientLinkType = LoLaAddressMatchLinkClient<0, 0, false, StaticLinkRegistry<1, FragmentTestService<'C', 2, 234567, false>>>;
+#else
+using ServerLinkType = LoLaAddressMatchLinkServer<>;
+using ClientLinkType = LoLaAddressMatchLinkClient<>;
+#endif
+
 // Link Server and its required instances.
 VirtualTransceiver<TestRadioConfig, 'S', false> ServerTransceiver(SchedulerBase);
 HalfDuplex<DuplexPeriod, false, DuplexDeadZone> ServerDuplex;
 ArduinoCycles ServerCyclesSource{};
-LoLaAddressMatchLinkServer<> LinkServer(SchedulerBase,
+ServerLinkType LinkServer(SchedulerBase,
 	&ServerTransceiver,
 	&ServerCyclesSource,
 	&ServerEntropySource,
@@ -160,7 +223,7 @@ LoLaAddressMatchLinkServer<> LinkServer(SchedulerBase,
 VirtualTransceiver<TestRadioConfig, 'C', PRINT_CHANNEL_HOP> ClientTransceiver(SchedulerBase);
 HalfDuplex<DuplexPeriod, true, DuplexDeadZone> ClientDuplex;
 ArduinoCycles ClientCyclesSource{};
-LoLaAddressMatchLinkClient<> LinkClient(SchedulerBase,
+ClientLinkType LinkClient(SchedulerBase,
 	&ClientTransceiver,
 	&ClientCyclesSource,
 	&ClientEntropySource,
@@ -181,6 +244,19 @@ DeliveryTestService<'S', 1, 123456, true> ServerDelivery(SchedulerBase, &LinkSer
 DeliveryTestService<'C', 1, 123456, false> ClientDelivery(SchedulerBase, &LinkClient);
 #endif
 
+#if defined(LINK_TEST_FRAGMENT)
+FragmentTestService<'S', 2, 234567, true> ServerFragment(SchedulerBase, &LinkServer);
+FragmentTestService<'C', 2, 234567, false> ClientFragment(SchedulerBase, &LinkClient);
+#endif
+
+#if defined(LINK_TEST_AGGREGATE)
+AggregateTestTracker ClientAggregateTracker{};
+AggregateTestService<'S', 3, 345678, true> ServerAggregateA(SchedulerBase, &LinkServer);
+AggregateTestService<'S', 4, 456789, true> ServerAggregateB(SchedulerBase, &LinkServer);
+AggregateTestService<'C', 3, 345678, false> ClientAggregateA(SchedulerBase, &LinkClient, &ClientAggregateTracker);
+AggregateTestService<'C', 4, 456789, false> ClientAggregateB(SchedulerBase, &LinkClient, &ClientAggregateTracker);
+#endif
+
 #if defined(LINK_TEST_SURFACE)
 ExampleSurface ReadSurface{};
 SurfaceReader<1, 23456> ClientReader(SchedulerBase, &LinkClient, &ReadSurface);
@@ -313,15 +389,73 @@ void setup()
 #endif
 #endif
 
+#if defined(LINK_TEST_FRAGMENT)
+	// Setup Test Fragment services.
+#if defined(LINK_TEST_STATIC_REGISTRY)
+	LinkServer.GetRegistry().Attach(&ServerFragment);
+	LinkClient.GetRegistry().Attach(&ClientFragment);
+#endif
+	if (!ServerFragment.Setup())
+	{
+#ifdef DEBUG
+		Serial.println(F("ServerFragment setup failed."));
+#endif
+		BootError();
+	}
+	if (!ClientFragment.Setup())
+	{
+#ifdef DEBUG
+		Serial.println(F("ClientFragment setup failed."));
+#endif
+		BootError();
+	}
+#endif
+
+#if defined(LINK_TEST_AGGREGATE)
+	// Setup Test Aggregate services.
+	if (!ServerAggregateA.Setup()
+		|| !ServerAggregateB.Setup())
+	{
+#ifdef DEBUG
+		Serial.println(F("ServerAggregate setup failed."));
+#endif
+		BootError();
+	}
+	if (!ClientAggregateA.Setup()
+		|| !ClientAggregateB.Setup())
+	{
+#ifdef DEBUG
+		Serial.println(F("ClientAggregate setup failed."));
+#endif
+		BootError();
+	}
+#endif
+
 	// Setup Link instances.
+#if defined(LINK_TEST_PKE)
+	if (!uECC_compute_public_key(ServerPrivateKey, ServerPublicKey, uECC_secp160r1())
+		|| !uECC_compute_public_key(ClientPrivateKey, ClientPublicKey, uECC_secp160r1()))
+	{
+#ifdef DEBUG
+		Serial.println(F("Public key generation failed."));
+#endif
+		BootError();
+	}
+	if (!LinkServer.Setup(AccessPassword, ServerPublicKey, ServerPrivateKey))
+#else
 	if (!LinkServer.Setup(ServerAddress, AccessPassword, SecretKey))
+#endif
 	{
 #ifdef DEBUG
 		Serial.println(F("Server Link Setup Failed."));
 #endif
 		BootError();
 	}
+#if defined(LINK_TEST_PKE)
+	if (!LinkClient.Setup(AccessPassword, ClientPublicKey, ClientPrivateKey))
+#else
 	if (!LinkClient.Setup(ClientAddress, AccessPassword, SecretKey))
+#endif
 	{
 #ifdef DEBUG
 		Serial.println(F("Client Link Setup Failed."));
@@ -0,0 +1,74 @@
+// MediumLogTask.h
+
+#ifndef _MEDIUM_LOG_TASK_h
+#define _MEDIUM_LOG_TASK_h
+
+#define _TASK_OO_CALLBACKS
+#include <TSchedulerDeclarations.hpp>
+
+#include <ILoLaInclude.h>
+
+/// <summary>
+/// Periodically logs the shared medium occupancy and the state of every link on it.
+/// </summary>
+template<typename MediumType,
+	const uint8_t LinkCount,
+	const uint32_t PeriodMillis = 10000>
+class MediumLogTask : private TS::Task
+{
+private:
+	LoLaLinkStatus LinkStatus{};
+
+	MediumType& Medium;
+	ILoLaLink** Links;
+	const char* Names;
+
+	uint32_t LastLog = 0;
+
+public:
+	MediumLogTask(TS::Scheduler& scheduler, MediumType& medium, ILoLaLink** links, const char* names)
+		: TS::Task(PeriodMillis, TASK_FOREVER, &scheduler, false)
+		, Medium(medium)
+		, Links(links)
+		, Names(names)
+	{}
+
+	void Start()
+	{
+		Medium.ClearStats();
+		LastLog = micros();
+		TS::Task::enableDelayed(PeriodMillis);
+	}
+
+	bool Callback() final
+	{
+		const uint32_t timestamp = micros();
+
+		Serial.print(millis() / 1000);
+		Serial.println(F(" s"));
+		for (uint_fast8_t i = 0; i < LinkCount; i++)
+		{
+			Links[i]->GetLinkStatus(LinkStatus);
+			Serial.print('\t');
+			Serial.print(Names[i]);
+			if (Links[i]->HasLink())
+			{
+				Serial.print(F(" Linked\tRx Drop Rate "));
+				Serial.print(LinkStatus.RxDropRate);
+				Serial.print(F("\tTx Drop Rate "));
+				Serial.println(LinkStatus.TxDropRate);
+			}
+			else
+			{
+				Serial.println(F(" Not Linked"));
+			}
+		}
+		Medium.LogStats(Serial, timestamp - LastLog);
+
+		Medium.ClearStats();
+		LastLog = timestamp;
+
+		return true;
+	}
+};
+#endif
@@ -0,0 +1,208 @@
+/* LoLa Link Virtual Medium tester.
+* Creates two Server/Client pairs, all sharing a simulated RF medium.
+*
+* Used to test how Duplex and Channel Hop settings scale,
+* when several links share the same band in the same room.
+*
+*/
+
+#define DEBUG
+
+#if defined(DEBUG)
+#define DEBUG_LOLA
+//#define DEBUG_LOLA_LINK
+#define SERIAL_BAUD_RATE 115200
+#endif
+
+#define _TASK_OO_CALLBACKS
+#ifdef _TASK_SLEEP_ON_IDLE_RUN
+#undef _TASK_SLEEP_ON_IDLE_RUN // Virtual Transceiver can't wake up the CPU, sleep is not compatible.
+#endif
+
+// Enable to use channel hop. Disable for fixed channel.
+#define LINK_USE_CHANNEL_HOP
+
+// Attenuation between partners and between pairs, out of 255.
+#define PARTNER_ATTENUATION 20
+#define CROSS_PAIR_ATTENUATION 60
+
+// Period in milliseconds, to log the Links' status and the medium occupancy.
+#define PRINT_MEDIUM_PERIOD 10000
+
+#include <TScheduler.hpp>
+#include <ILoLaInclude.h>
+
+#include "MediumLogTask.h"
+
+// Process scheduler.
+TS::Scheduler SchedulerBase{};
+//
+
+// Diceware created values for address and secret keys.
+static constexpr uint8_t ServerAddressA[LoLaLinkDefinition::PUBLIC_ADDRESS_SIZE] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 };
+static constexpr uint8_t ClientAddressA[LoLaLinkDefinition::PUBLIC_ADDRESS_SIZE] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 };
+static constexpr uint8_t AccessPasswordA[LoLaLinkDefinition::ACCESS_CONTROL_PASSWORD_SIZE] = { 0x10, 0x01, 0x20, 0x02, 0x30, 0x03, 0x40, 0x04 };
+static constexpr uint8_t SecretKeyA[LoLaLinkDefinition::SECRET_KEY_SIZE] = { 0x50, 0x05, 0x60, 0x06, 0x70, 0x07, 0x80, 0x08 };
+
+static constexpr uint8_t ServerAddressB[LoLaLinkDefinition::PUBLIC_ADDRESS_SIZE] = { 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17 };
+static constexpr uint8_t ClientAddressB[LoLaLinkDefinition::PUBLIC_ADDRESS_SIZE] = { 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18 };
+static constexpr uint8_t AccessPasswordB[LoLaLinkDefinition::ACCESS_CONTROL_PASSWORD_SIZE] = { 0x90, 0x09, 0xA0, 0x0A, 0xB0, 0x0B, 0xC0, 0x0C };
+static constexpr uint8_t SecretKeyB[LoLaLinkDefinition::SECRET_KEY_SIZE] = { 0xD0, 0x0D, 0xE0, 0x0E, 0xF0, 0x0F, 0x01, 0x10 };
+//
+
+// Virtual Transceiver configurations.
+// <ChannelCount, TxBaseMicros, TxByteNanos, AirBaseMicros, AirByteNanos, HopMicros>
+using SlowMultiChannel = IVirtualTransceiver::Configuration<10, 50, 4000, 700, 35000, 100>;
+
+// Used Virtual Driver Configuration.
+using TestRadioConfig = SlowMultiChannel;
+
+// Shared Link configuration.
+static constexpr uint16_t DuplexPeriod = 10000;
+static constexpr uint16_t DuplexDeadZone = 500;
+static constexpr uint32_t ChannelHopPeriod = 200000;
+
+// Shared RF medium, for all 4 transceivers.
+VirtualMedium<TestRadioConfig, 4> Medium{};
+
+ArduinoLowEntropy EntropySource{};
+
+// Channel Hoppers
+#if defined(LINK_USE_CHANNEL_HOP)
+TimedChannelHopper<ChannelHopPeriod, DuplexDeadZone> ServerChannelHopA(SchedulerBase);
+TimedChannelHopper<ChannelHopPeriod, DuplexDeadZone> ClientChannelHopA(SchedulerBase);
+TimedChannelHopper<ChannelHopPeriod, DuplexDeadZone> ServerChannelHopB(SchedulerBase);
+TimedChannelHopper<ChannelHopPeriod, DuplexDeadZone> ClientChannelHopB(SchedulerBase);
+#else
+NoHopNoChannel ServerChannelHopA{};
+NoHopNoChannel ClientChannelHopA{};
+NoHopNoChannel ServerChannelHopB{};
+NoHopNoChannel ClientChannelHopB{};
+#endif
+///
+
+// Pair A.
+VirtualTransceiver<TestRadioConfig, 'S', false> ServerTransceiverA(SchedulerBase);
+HalfDuplex<DuplexPeriod, false, DuplexDeadZone> ServerDuplexA;
+ArduinoCycles ServerCyclesSourceA{};
+LoLaAddressMatchLinkServer<> LinkServerA(SchedulerBase,
+	&ServerTransceiverA,
+	&ServerCyclesSourceA,
+	&EntropySource,
+	&ServerDuplexA,
+	&ServerChannelHopA);
+
+VirtualTransceiver<TestRadioConfig, 'C', false> ClientTransceiverA(SchedulerBase);
+HalfDuplex<DuplexPeriod, true, DuplexDeadZone> ClientDuplexA;
+ArduinoCycles ClientCyclesSourceA{};
+LoLaAddressMatchLinkClient<> LinkClientA(SchedulerBase,
+	&ClientTransceiverA,
+	&ClientCyclesSourceA,
+	&EntropySource,
+	&ClientDuplexA,
+	&ClientChannelHopA);
+
+// Pair B, with direct port dispatch.
+VirtualTransceiver<TestRadioConfig, 's', false> ServerTransceiverB(SchedulerBase);
+HalfDuplex<DuplexPeriod, false, DuplexDeadZone> ServerDuplexB;
+ArduinoCycles ServerCyclesSourceB{};
+LoLaAddressMatchLinkServer<10, 10, true> LinkServerB(SchedulerBase,
+	&ServerTransceiverB,
+	&ServerCyclesSourceB,
+	&EntropySource,
+	&ServerDuplexB,
+	&ServerChannelHopB);
+
+VirtualTransceiver<TestRadioConfig, 'c', false> ClientTransceiverB(SchedulerBase);
+HalfDuplex<DuplexPeriod, true, DuplexDeadZone> ClientDuplexB;
+ArduinoCycles ClientCyclesSourceB{};
+LoLaAddressMatchLinkClient<10, 10, true> LinkClientB(SchedulerBase,
+	&ClientTransceiverB,
+	&ClientCyclesSourceB,
+	&EntropySource,
+	&ClientDuplexB,
+	&ClientChannelHopB);
+
+ILoLaLink* Links[4] = { &LinkServerA, &LinkClientA, &LinkServerB, &LinkClientB };
+
+MediumLogTask<VirtualMedium<TestRadioConfig, 4>, 4, PRINT_MEDIUM_PERIOD> MediumLog(SchedulerBase, Medium, Links, "SCsc");
+
+void BootError()
+{
+#ifdef DEBUG
+	Serial.println("Critical Error");
+#endif
+	delay(1000);
+	while (1);;
+}
+
+void setup()
+{
+#ifdef DEBUG
+	Serial.begin(SERIAL_BAUD_RATE);
+	while (!Serial)
+		;
+	delay(1000);
+#endif
+
+	// Setup shared medium.
+	if (!Medium.Attach(&ServerTransceiverA)
+		|| !Medium.Attach(&ClientTransceiverA)
+		|| !Medium.Attach(&ServerTransceiverB)
+		|| !Medium.Attach(&ClientTransceiverB))
+	{
+#ifdef DEBUG
+		Serial.println(F("Medium setup failed."));
+#endif
+		BootError();
+	}
+
+	Medium.SetAttenuation(&ServerTransceiverA, &ClientTransceiverA, PARTNER_ATTENUATION);
+	Medium.SetAttenuation(&ServerTransceiverB, &ClientTransceiverB, PARTNER_ATTENUATION);
+	Medium.SetAttenuation(&ServerTransceiverA, &ServerTransceiverB, CROSS_PAIR_ATTENUATION);
+	Medium.SetAttenuation(&ServerTransceiverA, &ClientTransceiverB, CROSS_PAIR_ATTENUATION);
+	Medium.SetAttenuation(&ClientTransceiverA, &ServerTransceiverB, CROSS_PAIR_ATTENUATION);
+	Medium.SetAttenuation(&ClientTransceiverA, &ClientTransceiverB, CROSS_PAIR_ATTENUATION);
+
+	// Setup Link instances.
+	if (!LinkServerA.Setup(ServerAddressA, AccessPasswordA, SecretKeyA)
+		|| !LinkClientA.Setup(ClientAddressA, AccessPasswordA, SecretKeyA))
+	{
+#ifdef DEBUG
+		Serial.println(F("Pair A Link Setup Failed."));
+#endif
+		BootError();
+	}
+	if (!LinkServerB.Setup(ServerAddressB, AccessPasswordB, SecretKeyB)
+		|| !LinkClientB.Setup(ClientAddressB, AccessPasswordB, SecretKeyB))
+	{
+#ifdef DEBUG
+		Serial.println(F("Pair B Link Setup Failed."));
+#endif
+		BootError();
+	}
+
+	// Start Link instances.
+	if (LinkServerA.Start() && LinkClientA.Start()
+		&& LinkServerB.Start() && LinkClientB.Start())
+	{
+#if defined(DEBUG_LOLA)
+		Serial.print(millis());
+		Serial.println(F("\tLoLa Links have started."));
+#endif
+	}
+	else
+	{
+#if defined(DEBUG_LOLA)
+		Serial.println(F("Link Start Failed."));
+#endif
+		BootError();
+	}
+
+	MediumLog.Start();
+}
+
+void loop()
+{
+	SchedulerBase.execute();
+}
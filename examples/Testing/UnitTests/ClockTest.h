@@ -5,7 +5,7 @@
 
 #include <Arduino.h>
 #include "Tests.h"
-#include <Clock\LinkClock.h>
+#include <Clock/LinkClock.h>
 
 
 class ClockTest
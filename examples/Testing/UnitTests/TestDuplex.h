@@ -103,6 +103,36 @@ private:
 			}
 		}
 
+		return TestTimeToRange<Period, Duration>(duplex);
+	}
+
+	/// <summary>
+	/// Time to range must land on the first in range timestamp.
+	/// </summary>
+	/// <typeparam name="Period"></typeparam>
+	/// <typeparam name="Duration"></typeparam>
+	/// <param name="duplex"></param>
+	/// <returns>True if test successful.</returns>
+	template<uint32_t Period, uint16_t Duration>
+	static const bool TestTimeToRange(IDuplex* duplex)
+	{
+		for (uint32_t i = 0; i < Period; i++)
+		{
+			const uint32_t wait = duplex->GetTimeToRange(i, Duration);
+
+			if (duplex->IsInRange(i, Duration) != (wait == 0)
+				|| !duplex->IsInRange(i + wait, Duration)
+				|| (wait > 0 && duplex->IsInRange(i + wait - 1, Duration)))
+			{
+				Serial.print(F("Time to range "));
+				Serial.print(wait);
+				Serial.print(F(" wrong at timestamp "));
+				Serial.println(i);
+
+				return false;
+			}
+		}
+
 		return true;
 	}
 
@@ -7,7 +7,7 @@
 #define LOLA_UNIT_TESTING
 
 #include <ILoLaInclude.h>
-#include <Clock\Time.h>
+#include <Clock/Time.h>
 
 static const uint32_t SHIFT_LOW = (UINT32_MAX / 2) + 1000;
 static const uint32_t SHIFT_MID = (UINT32_MAX / 2) - 1;
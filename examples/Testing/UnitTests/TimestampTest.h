@@ -5,7 +5,7 @@
 
 #include <Arduino.h>
 #include "Tests.h"
-#include <Clock\Timestamp.h>
+#include <Clock/Timestamp.h>
 
 class TimestampTest
 {
@@ -0,0 +1,21 @@
+/* LoLa Crypto Benchmark, native host runner.
+* Builds the unmodified CryptoBenchmark sketch against the Arduino shim.
+* Timing is in real time (micros), to benchmark the host CPU.
+*
+* Usage: CryptoBenchmarkHost
+*	Returns non-zero if any encoded packet failed to decode.
+*/
+
+#include <Arduino.h>
+
+HardwareSerial Serial{};
+
+#include "../../../examples/Testing/CryptoBenchmark/CryptoBenchmark.ino"
+
+int main(int argc, char** argv)
+{
+	setup();
+	Serial.flush();
+
+	return BenchmarkOk ? 0 : 1;
+}
@@ -0,0 +1,39 @@
+// HostRunner.h
+// Runs an included sketch's setup() and loop() as a native executable.
+//
+// Command line: [duration seconds] [seed]
+//	Without duration, runs forever.
+//	With a seed, runs in virtual time: the clock advances to the next event instead of waiting,
+//	so long soaks take a fraction of the duration and every run with the same seed is identical.
+
+#ifndef _HOST_RUNNER_h
+#define _HOST_RUNNER_h
+
+#include <Arduino.h>
+
+void setup();
+void loop();
+
+namespace HostRunner
+{
+	inline void Run(const int argc, char** argv)
+	{
+		const uint32_t durationSeconds = (argc > 1) ? (uint32_t)strtoul(argv[1], nullptr, 10) : 0;
+
+		if (argc > 2)
+		{
+			randomSeed(strtoul(argv[2], nullptr, 10));
+			HostClock::StartVirtual();
+		}
+
+		setup();
+
+		const uint64_t start = HostClock::GetMicros64();
+		while (durationSeconds == 0
+			|| ((HostClock::GetMicros64() - start) / 1000000) < durationSeconds)
+		{
+			loop();
+		}
+	}
+}
+#endif
@@ -0,0 +1,278 @@
+// Arduino.h
+// Host shim for the Arduino HAL subset used by LoLa.
+// Allows the link stack to be built as a native POSIX executable,
+// for profiling and long soak tests without a board on the bench.
+
+#ifndef _HOST_ARDUINO_h
+#define _HOST_ARDUINO_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Print.h"
+
+#if !defined(F_CPU)
+#define F_CPU 1000000000L
+#endif
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define IRAM_ATTR
+
+namespace HostClock
+{
+	/// <summary>
+	/// Virtual time state.
+	/// When enabled, time only moves when the scheduler advances it,
+	/// so runs are deterministic and don't wait for the wall clock.
+	/// </summary>
+	struct VirtualTimeStruct
+	{
+		uint64_t Micros = 0;
+		uint64_t WakeMicros = UINT64_MAX;
+
+		// Virtual duration of a busy scheduler pass.
+		uint32_t PassMicros = 1;
+
+		// Longest jump of an idle scheduler pass, bounds polling tasks that don't request a wake.
+		uint32_t MaxIdleMicros = 1000;
+
+		bool Enabled = false;
+	};
+
+	inline VirtualTimeStruct& GetVirtualTime()
+	{
+		static VirtualTimeStruct virtualTime{};
+
+		return virtualTime;
+	}
+
+	/// <summary>
+	/// Monotonic microseconds since process start.
+	/// </summary>
+	inline uint64_t GetRealMicros64()
+	{
+		static uint64_t start = 0;
+		timespec now{};
+		clock_gettime(CLOCK_MONOTONIC, &now);
+
+		const uint64_t timestamp = ((uint64_t)now.tv_sec * 1000000) + ((uint64_t)now.tv_nsec / 1000);
+		if (start == 0)
+		{
+			start = timestamp;
+		}
+
+		return timestamp - start;
+	}
+
+	inline uint64_t GetMicros64()
+	{
+		if (GetVirtualTime().Enabled)
+		{
+			return GetVirtualTime().Micros;
+		}
+		else
+		{
+			return GetRealMicros64();
+		}
+	}
+
+	/// <summary>
+	/// Switches to virtual time, starting at zero.
+	/// Must be called before any timestamp is taken.
+	/// </summary>
+	/// <param name="passMicros">Virtual duration of a busy scheduler pass.</param>
+	/// <param name="maxIdleMicros">Longest jump of an idle scheduler pass.</param>
+	inline void StartVirtual(const uint32_t passMicros = 1, const uint32_t maxIdleMicros = 1000)
+	{
+		VirtualTimeStruct& virtualTime = GetVirtualTime();
+		virtualTime.Micros = 0;
+		virtualTime.WakeMicros = UINT64_MAX;
+		virtualTime.PassMicros = passMicros > 0 ? passMicros : 1;
+		virtualTime.MaxIdleMicros = maxIdleMicros > virtualTime.PassMicros ? maxIdleMicros : virtualTime.PassMicros;
+		virtualTime.Enabled = true;
+	}
+
+	inline bool IsVirtual()
+	{
+		return GetVirtualTime().Enabled;
+	}
+
+	/// <summary>
+	/// Requests the next idle jump to stop at timestamp.
+	/// No effect with real time.
+	/// </summary>
+	/// <param name="timestamp">micros() timestamp of the next pending event.</param>
+	inline void RequestWake(const uint32_t timestamp)
+	{
+		VirtualTimeStruct& virtualTime = GetVirtualTime();
+		if (virtualTime.Enabled)
+		{
+			const uint32_t remaining = timestamp - (uint32_t)virtualTime.Micros;
+			const uint64_t wake = (remaining > INT32_MAX) ? virtualTime.Micros : virtualTime.Micros + remaining;
+
+			if (wake < virtualTime.WakeMicros)
+			{
+				virtualTime.WakeMicros = wake;
+			}
+		}
+	}
+
+	inline void Advance(const uint64_t duration)
+	{
+		GetVirtualTime().Micros += duration;
+	}
+
+	/// <summary>
+	/// Scheduler pass is complete.
+	/// Busy passes take PassMicros, idle passes jump to the next event.
+	/// </summary>
+	/// <param name="idle">True if no task did work on this pass.</param>
+	/// <param name="nextDueMicros">Earliest virtual timestamp of a delayed task.</param>
+	inline void OnSchedulerPass(const bool idle, const uint64_t nextDueMicros)
+	{
+		VirtualTimeStruct& virtualTime = GetVirtualTime();
+
+		uint64_t target = virtualTime.Micros + virtualTime.PassMicros;
+		if (idle)
+		{
+			target = virtualTime.Micros + virtualTime.MaxIdleMicros;
+			if (nextDueMicros < target)
+			{
+				target = nextDueMicros;
+			}
+			if (virtualTime.WakeMicros < target)
+			{
+				target = virtualTime.WakeMicros;
+			}
+			if (target <= virtualTime.Micros)
+			{
+				target = virtualTime.Micros + virtualTime.PassMicros;
+			}
+		}
+
+		virtualTime.Micros = target;
+		virtualTime.WakeMicros = UINT64_MAX;
+	}
+}
+
+static inline uint32_t micros()
+{
+	return (uint32_t)HostClock::GetMicros64();
+}
+
+static inline uint32_t millis()
+{
+	return (uint32_t)(HostClock::GetMicros64() / 1000);
+}
+
+static inline void delayMicroseconds(const uint32_t duration)
+{
+	if (HostClock::IsVirtual())
+	{
+		HostClock::Advance(duration);
+	}
+	else
+	{
+		const uint32_t start = micros();
+		while (micros() - start < duration)
+			;
+	}
+}
+
+static inline void delay(const uint32_t duration)
+{
+	if (HostClock::IsVirtual())
+	{
+		HostClock::Advance((uint64_t)duration * 1000);
+	}
+	else
+	{
+		usleep((useconds_t)duration * 1000);
+	}
+}
+
+static inline void yield() {}
+static inline void interrupts() {}
+static inline void noInterrupts() {}
+
+static inline void pinMode(const uint8_t pin, const uint8_t mode) {}
+static inline void digitalWrite(const uint8_t pin, const uint8_t value) {}
+static inline int digitalRead(const uint8_t pin) { return LOW; }
+static inline int analogRead(const uint8_t pin) { return (int)(::random() & 0x3FF); }
+
+static inline void randomSeed(const unsigned long seed)
+{
+	if (seed != 0)
+	{
+		srandom((unsigned int)seed);
+	}
+}
+
+static inline long random(const long howBig)
+{
+	if (howBig == 0)
+	{
+		return 0;
+	}
+
+	return ::random() % howBig;
+}
+
+static inline long random(const long howSmall, const long howBig)
+{
+	if (howSmall >= howBig)
+	{
+		return howSmall;
+	}
+
+	return random(howBig - howSmall) + howSmall;
+}
+
+/// <summary>
+/// Arduino Stream interface.
+/// </summary>
+class Stream : public Print
+{
+public:
+	virtual int available() { return 0; }
+	virtual int read() { return -1; }
+	virtual int peek() { return -1; }
+};
+
+/// <summary>
+/// Serial port mapped to stdout.
+/// </summary>
+class HardwareSerial : public Stream
+{
+public:
+	void begin(const unsigned long baudRate) {}
+	void end() {}
+
+	operator bool() const { return true; }
+
+	virtual size_t write(const uint8_t value) final
+	{
+		return fputc(value, stdout) == EOF ? 0 : 1;
+	}
+
+	virtual void flush() final
+	{
+		fflush(stdout);
+	}
+
+	using Print::write;
+};
+
+extern HardwareSerial Serial;
+#endif
@@ -0,0 +1,126 @@
+// Print.h
+// Host shim for the Arduino Print interface.
+
+#ifndef _HOST_PRINT_h
+#define _HOST_PRINT_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper*>(string_literal))
+
+/// <summary>
+/// Minimal Arduino String, only what the library uses for debug output.
+/// </summary>
+class String
+{
+private:
+	static constexpr size_t MAX_LENGTH = 64;
+
+	char Buffer[MAX_LENGTH]{};
+
+public:
+	String(const char* source = "")
+	{
+		strncpy(Buffer, source, MAX_LENGTH - 1);
+	}
+
+	const char* c_str() const
+	{
+		return Buffer;
+	}
+};
+
+/// <summary>
+/// Arduino Print interface, implementations only need to provide write(uint8_t).
+/// </summary>
+class Print
+{
+public:
+	virtual size_t write(const uint8_t value) = 0;
+
+	virtual size_t write(const uint8_t* buffer, size_t size)
+	{
+		size_t count = 0;
+		while (size--)
+		{
+			count += write(*buffer++);
+		}
+		return count;
+	}
+
+	size_t write(const char* text)
+	{
+		return write((const uint8_t*)text, strlen(text));
+	}
+
+	virtual void flush() {}
+
+public:
+	size_t print(const __FlashStringHelper* text) { return write(reinterpret_cast<const char*>(text)); }
+	size_t print(const String& text) { return write(text.c_str()); }
+	size_t print(const char* text) { return write(text); }
+	size_t print(const char value) { return write((uint8_t)value); }
+	size_t print(const unsigned char value, const int base = DEC) { return PrintNumber((unsigned long)value, base); }
+	size_t print(const int value, const int base = DEC) { return print((long)value, base); }
+	size_t print(const unsigned int value, const int base = DEC) { return PrintNumber((unsigned long)value, base); }
+	size_t print(const long value, const int base = DEC)
+	{
+		if (base == DEC && value < 0)
+		{
+			return write((uint8_t)'-') + PrintNumber((unsigned long)(-value), base);
+		}
+		return PrintNumber((unsigned long)value, base);
+	}
+	size_t print(const unsigned long value, const int base = DEC) { return PrintNumber(value, base); }
+	size_t print(const long long value, const int base = DEC) { return print((long)value, base); }
+	size_t print(const unsigned long long value, const int base = DEC) { return PrintNumber((unsigned long)value, base); }
+	size_t print(const double value, const int digits = 2)
+	{
+		char buffer[32]{};
+		snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+		return write(buffer);
+	}
+
+	size_t println() { return write((uint8_t)'\n'); }
+
+	template<typename T>
+	size_t println(const T value)
+	{
+		const size_t count = print(value);
+		return count + println();
+	}
+
+	template<typename T>
+	size_t println(const T value, const int format)
+	{
+		const size_t count = print(value, format);
+		return count + println();
+	}
+
+private:
+	size_t PrintNumber(unsigned long value, const int base)
+	{
+		char buffer[8 * sizeof(long) + 1]{};
+		char* digit = &buffer[sizeof(buffer) - 1];
+		const unsigned long divisor = (base < 2) ? 10 : base;
+
+		do
+		{
+			const char remainder = value % divisor;
+			value /= divisor;
+			*--digit = remainder < 10 ? remainder + '0' : remainder + 'A' - 10;
+		} while (value > 0);
+
+		return write(digit);
+	}
+};
+#endif
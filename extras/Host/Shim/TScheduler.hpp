@@ -0,0 +1,9 @@
+// TScheduler.hpp
+// Host shim for TaskScheduler, the implementation lives with the declarations.
+
+#ifndef _HOST_TSCHEDULER_h
+#define _HOST_TSCHEDULER_h
+
+#include "TSchedulerDeclarations.hpp"
+
+#endif
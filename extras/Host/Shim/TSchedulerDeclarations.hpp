@@ -0,0 +1,260 @@
+// TSchedulerDeclarations.hpp
+// Host shim for the TaskScheduler subset used by LoLa.
+// https://github.com/arkhipenko/TaskScheduler
+// Cooperative, single threaded, millisecond resolution and OO callbacks only.
+
+#ifndef _HOST_TSCHEDULER_DECLARATIONS_h
+#define _HOST_TSCHEDULER_DECLARATIONS_h
+
+#include <Arduino.h>
+
+#if !defined(_TASK_OO_CALLBACKS)
+#define _TASK_OO_CALLBACKS
+#endif
+
+#define TASK_IMMEDIATE 0
+#define TASK_FOREVER (-1)
+#define TASK_MILLISECOND 1UL
+#define TASK_SECOND 1000UL
+
+namespace TS
+{
+	class Scheduler;
+
+	class Task
+	{
+		friend class Scheduler;
+
+	private:
+		Scheduler* Owner;
+		Task* Next = nullptr;
+
+		uint32_t Interval;
+		uint32_t Delay = 0;
+		uint32_t PreviousMillis = 0;
+
+		long Iterations;
+		long SetIterations;
+
+		bool Enabled = false;
+
+	public:
+		Task(const unsigned long interval = 0, const long iterations = 0, Scheduler* scheduler = nullptr, const bool enable = false);
+
+		virtual ~Task() {}
+
+		virtual bool Callback() = 0;
+
+		virtual bool OnEnable() { return true; }
+		virtual void OnDisable() {}
+
+	public:
+		void enable()
+		{
+			if (Owner == nullptr)
+			{
+				return;
+			}
+
+			Iterations = SetIterations;
+			Enabled = OnEnable();
+			Delay = 0;
+			PreviousMillis = millis();
+		}
+
+		bool enableIfNot()
+		{
+			const bool previousEnabled = Enabled;
+			if (!Enabled)
+			{
+				enable();
+			}
+			return previousEnabled;
+		}
+
+		void enableDelayed(const unsigned long delayMillis = 0)
+		{
+			enable();
+			delay(delayMillis);
+		}
+
+		void delay(const unsigned long delayMillis = 0)
+		{
+			Delay = delayMillis ? delayMillis : Interval;
+			PreviousMillis = millis();
+		}
+
+		void forceNextIteration()
+		{
+			Delay = 0;
+			PreviousMillis = millis();
+		}
+
+		bool disable()
+		{
+			const bool previousEnabled = Enabled;
+			Enabled = false;
+			if (previousEnabled)
+			{
+				OnDisable();
+			}
+			return previousEnabled;
+		}
+
+		bool isEnabled() const
+		{
+			return Enabled;
+		}
+
+		void setInterval(const unsigned long interval)
+		{
+			Interval = interval;
+			delay();
+		}
+
+		unsigned long getInterval() const
+		{
+			return Interval;
+		}
+
+		void setIterations(const long iterations)
+		{
+			Iterations = SetIterations = iterations;
+		}
+
+		long getIterations() const
+		{
+			return Iterations;
+		}
+	};
+
+	class Scheduler
+	{
+		friend class Task;
+
+	private:
+		Task* First = nullptr;
+		Task* Last = nullptr;
+
+	public:
+		Scheduler() {}
+
+		void init()
+		{
+			First = nullptr;
+			Last = nullptr;
+		}
+
+		void addTask(Task& task)
+		{
+			task.Owner = this;
+			task.Next = nullptr;
+			if (First == nullptr)
+			{
+				First = &task;
+			}
+			else
+			{
+				Last->Next = &task;
+			}
+			Last = &task;
+		}
+
+		/// <summary>
+		/// One pass over all tasks.
+		/// With virtual time, the pass also advances the clock.
+		/// </summary>
+		/// <returns>True if no task did work on this pass (idle).</returns>
+		bool execute()
+		{
+			bool idle = true;
+
+			for (Task* task = First; task != nullptr; task = task->Next)
+			{
+				if (!task->Enabled)
+				{
+					continue;
+				}
+
+				if (task->Iterations == 0)
+				{
+					task->disable();
+					continue;
+				}
+
+				const uint32_t timestamp = millis();
+				if (timestamp - task->PreviousMillis < task->Delay)
+				{
+					continue;
+				}
+
+				if (task->Iterations > 0)
+				{
+					task->Iterations--;
+				}
+
+				// Next run is scheduled before the callback, so it may re-schedule itself.
+				task->PreviousMillis = timestamp;
+				task->Delay = task->Interval;
+
+				if (task->Callback())
+				{
+					idle = false;
+				}
+			}
+
+			if (HostClock::IsVirtual())
+			{
+				HostClock::OnSchedulerPass(idle, GetNextDueMicros());
+			}
+
+			return idle;
+		}
+
+	private:
+		/// <summary>
+		/// Earliest virtual timestamp of an enabled task that is still delayed.
+		/// </summary>
+		uint64_t GetNextDueMicros() const
+		{
+			const uint64_t now = HostClock::GetMicros64();
+			const uint32_t timestamp = millis();
+			uint64_t nextDue = UINT64_MAX;
+
+			for (Task* task = First; task != nullptr; task = task->Next)
+			{
+				if (task->Enabled)
+				{
+					const uint32_t elapsed = timestamp - task->PreviousMillis;
+					if (elapsed < task->Delay)
+					{
+						const uint64_t due = ((now / 1000) + (task->Delay - elapsed)) * 1000;
+						if (due < nextDue)
+						{
+							nextDue = due;
+						}
+					}
+				}
+			}
+
+			return nextDue;
+		}
+	};
+
+	inline Task::Task(const unsigned long interval, const long iterations, Scheduler* scheduler, const bool enable)
+		: Owner(nullptr)
+		, Interval(interval)
+		, Iterations(iterations)
+		, SetIterations(iterations)
+	{
+		if (scheduler != nullptr)
+		{
+			scheduler->addTask(*this);
+		}
+		if (enable)
+		{
+			this->enable();
+		}
+	}
+}
+#endif
@@ -0,0 +1,20 @@
+/* LoLa PKE Session test, native host runner.
+* Builds the unmodified TestPkeSession sketch against the Arduino shim and micro-ecc.
+*
+* Usage: TestPkeSessionHost
+*	Returns non-zero if any check failed.
+*/
+
+#include <Arduino.h>
+
+HardwareSerial Serial{};
+
+#include "../../../examples/Testing/TestPkeSession/TestPkeSession.ino"
+
+int main(int argc, char** argv)
+{
+	setup();
+	Serial.flush();
+
+	return TestOk ? 0 : 1;
+}
@@ -0,0 +1,20 @@
+/* LoLa anti-replay window test, native host runner.
+* Builds the unmodified TestReplayWindow sketch against the Arduino shim.
+*
+* Usage: TestReplayWindowHost
+*	Returns non-zero if any counter was accepted, rejected or accounted as lost unexpectedly.
+*/
+
+#include <Arduino.h>
+
+HardwareSerial Serial{};
+
+#include "../../../examples/Testing/TestReplayWindow/TestReplayWindow.ino"
+
+int main(int argc, char** argv)
+{
+	setup();
+	Serial.flush();
+
+	return TestOk ? 0 : 1;
+}
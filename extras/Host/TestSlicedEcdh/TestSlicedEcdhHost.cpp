@@ -0,0 +1,20 @@
+/* LoLa Sliced ECDH test, native host runner.
+* Builds the unmodified TestSlicedEcdh sketch against the Arduino shim and micro-ecc.
+*
+* Usage: TestSlicedEcdhHost
+*	Returns non-zero if any vector mismatched.
+*/
+
+#include <Arduino.h>
+
+HardwareSerial Serial{};
+
+#include "../../../examples/Testing/TestSlicedEcdh/TestSlicedEcdh.ino"
+
+int main(int argc, char** argv)
+{
+	setup();
+	Serial.flush();
+
+	return TestOk ? 0 : 1;
+}
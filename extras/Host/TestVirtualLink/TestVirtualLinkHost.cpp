@@ -0,0 +1,169 @@
+/* LoLa Link Virtual tester, native host runner.
+* Builds the unmodified TestVirtualLink sketch against the Arduino/TaskScheduler shim,
+* so both Server and Client run as a normal POSIX executable.
+*
+* Usage: TestVirtualLinkHost [duration seconds] [seed]
+*	See HostRunner.h.
+*	Returns non-zero if both links aren't linked by the end of the duration.
+*	With LINK_TEST_FRAGMENT, also if no message was reassembled or any was corrupted.
+*	With LINK_TEST_AGGREGATE, also if no packet carried both services, or any sub-frame was corrupted or misrouted.
+*	With LINK_TEST_REKEY, also if the session key wasn't ratcheted or the link was dropped.
+*	With LINK_TEST_RESUME, also if the link wasn't resumed shortly after every fade.
+*	With LINK_TEST_PKE, the same checks run over the Public Key Exchange links.
+*/
+
+#include <Arduino.h>
+
+HardwareSerial Serial{};
+
+#include "../../../examples/Testing/TestVirtualLink/TestVirtualLink.ino"
+#include "../HostRunner.h"
+
+#if defined(LINK_TEST_RESUME)
+/// <summary>
+/// Polls the Client link, for the count of its outages
+///  and the longest recovery, from the end of a fade to the link being restored.
+/// </summary>
+class LinkOutageTracker : private TS::Task
+{
+private:
+	uint32_t LongestRecovery = 0;
+	uint16_t OutageCount = 0;
+	bool WasLinked = false;
+
+public:
+	LinkOutageTracker(TS::Scheduler& scheduler)
+		: TS::Task(1, TASK_FOREVER, &scheduler, true)
+	{}
+
+	bool Callback() final
+	{
+		const bool linked = LinkClient.HasLink();
+
+		if (linked != WasLinked)
+		{
+			WasLinked = linked;
+			if (!linked)
+			{
+				OutageCount++;
+			}
+			else if (OutageCount > 0)
+			{
+				// Fades end on the period, the link can only be restored after it.
+				const uint32_t recovery = millis() % FADE_PERIOD_MILLIS;
+				if (recovery > LongestRecovery)
+				{
+					LongestRecovery = recovery;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	const uint16_t GetOutageCount() const
+	{
+		return OutageCount;
+	}
+
+	const uint32_t GetLongestRecovery() const
+	{
+		return LongestRecovery;
+	}
+};
+
+LinkOutageTracker OutageTracker(SchedulerBase);
+#endif
+
+static void LogLinkStatus(const char* name, ILoLaLink& link)
+{
+	LoLaLinkStatus status{};
+	link.GetLinkStatus(status);
+
+	Serial.print(name);
+	Serial.println(link.HasLink() ? F(" Linked") : F(" Not Linked"));
+#if defined(DEBUG_LOLA)
+	status.Log(Serial);
+#endif
+}
+
+int main(int argc, char** argv)
+{
+	HostRunner::Run(argc, argv);
+
+	LogLinkStatus("Server", LinkServer);
+	LogLinkStatus("Client", LinkClient);
+
+#if defined(LINK_TEST_FRAGMENT)
+	Serial.print(F("Fragment messages "));
+	Serial.print(ClientFragment.GetReceivedCount());
+	Serial.print(F(" Corrupted "));
+	Serial.println(ClientFragment.GetErrorCount());
+	Serial.flush();
+
+	if (ClientFragment.GetReceivedCount() == 0
+		|| ClientFragment.GetErrorCount() > 0)
+	{
+		return 1;
+	}
+#endif
+#if defined(LINK_TEST_AGGREGATE)
+	Serial.print(F("Aggregate received "));
+	Serial.print(ClientAggregateA.GetReceivedCount());
+	Serial.print('/');
+	Serial.print(ClientAggregateB.GetReceivedCount());
+	Serial.print(F(" Aggregated packets "));
+	Serial.print(ClientAggregateTracker.AggregateCount);
+	Serial.print(F(" Corrupted "));
+	Serial.println(ClientAggregateA.GetErrorCount() + ClientAggregateB.GetErrorCount());
+	Serial.flush();
+
+	if (ClientAggregateA.GetReceivedCount() == 0
+		|| ClientAggregateB.GetReceivedCount() == 0
+		|| ClientAggregateTracker.AggregateCount == 0
+		|| ClientAggregateA.GetErrorCount() > 0
+		|| ClientAggregateB.GetErrorCount() > 0)
+	{
+		return 1;
+	}
+#endif
+#if defined(LINK_TEST_REKEY)
+	LoLaLinkStatus serverStatus{};
+	LoLaLinkStatus clientStatus{};
+	LinkServer.GetLinkStatus(serverStatus);
+	LinkClient.GetLinkStatus(clientStatus);
+
+	Serial.print(F("Rekey count "));
+	Serial.print(serverStatus.RekeyCount);
+	Serial.print('/');
+	Serial.print(clientStatus.RekeyCount);
+	Serial.print(F(" Link duration "));
+	Serial.println(serverStatus.DurationSeconds);
+	Serial.flush();
+
+	// A dropped link restarts the duration and the rekey count.
+	if (serverStatus.RekeyCount < 2
+		|| clientStatus.RekeyCount != serverStatus.RekeyCount)
+	{
+		return 1;
+	}
+#endif
+#if defined(LINK_TEST_RESUME)
+	Serial.print(F("Outages "));
+	Serial.print(OutageTracker.GetOutageCount());
+	Serial.print(F(" Longest recovery "));
+	Serial.print(OutageTracker.GetLongestRecovery());
+	Serial.println(F(" ms"));
+	Serial.flush();
+
+	// Every fade drops the link, a full re-link takes over 300 ms to recover.
+	if (OutageTracker.GetOutageCount() == 0
+		|| OutageTracker.GetLongestRecovery() > 250)
+	{
+		return 1;
+	}
+#endif
+	Serial.flush();
+
+	return (LinkServer.HasLink() && LinkClient.HasLink()) ? 0 : 1;
+}
@@ -0,0 +1,29 @@
+/* LoLa Link Virtual Medium tester, native host runner.
+* Builds the unmodified TestVirtualMedium sketch against the Arduino/TaskScheduler shim.
+*
+* Usage: TestVirtualMediumHost [duration seconds] [seed]
+*	See HostRunner.h.
+*	Returns non-zero if any link isn't linked by the end of the duration.
+*/
+
+#include <Arduino.h>
+
+HardwareSerial Serial{};
+
+#include "../../../examples/Testing/TestVirtualMedium/TestVirtualMedium.ino"
+#include "../HostRunner.h"
+
+int main(int argc, char** argv)
+{
+	HostRunner::Run(argc, argv);
+
+	bool allLinked = true;
+	for (uint_fast8_t i = 0; i < 4; i++)
+	{
+		allLinked &= Links[i]->HasLink();
+	}
+	Serial.println(allLinked ? F("All Linked") : F("Not All Linked"));
+	Serial.flush();
+
+	return allLinked ? 0 : 1;
+}
@@ -5,7 +5,7 @@
 
 #include <stdint.h>
 
-#include "Clock\LinkClock.h"
+#include "Clock/LinkClock.h"
 
 /// <summary>
 /// Interface for generic channel hopper/manager.
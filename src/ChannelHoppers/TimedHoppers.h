@@ -173,11 +173,11 @@ private:
 
 			if (LastHopIndex != hopIndex)
 			{
+				const uint32_t elapsed = now - LastHop;
+
 				LastHop = now;
 				LastHopIndex = hopIndex;
 
-				const uint32_t elapsed = now - LastHop;
-
 				if (PeriodBiggerMillisecond()
 					&& (elapsed >= HopPeriodMillis())
 					&& (elapsed <= HopPeriodMillis() + 1))
@@ -192,6 +192,7 @@ protected:
 		TS::Task::enable();
 	}
 
+public:
 	/// <summary>
 	/// Get duration from cyclestamp counts.
 	/// </summary>
@@ -3,7 +3,7 @@
 #ifndef _TIMESTAMP_h
 #define _TIMESTAMP_h
 
-#include "Clock\Time.h"
+#include "Clock/Time.h"
 
 /// <summary>
 /// Timestamp with seconds [0;UINT32_MAX]
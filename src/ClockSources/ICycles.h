@@ -2,7 +2,7 @@
 #ifndef _I_CYCLE_SOURCE_h
 #define _I_CYCLE_SOURCE_h
 
-#include "Clock\Time.h"
+#include "Clock/Time.h"
 
 
 /// <summary>
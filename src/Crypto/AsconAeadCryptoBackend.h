@@ -0,0 +1,28 @@
+// AsconAeadCryptoBackend.h
+
+#ifndef _ASCON_AEAD_CRYPTO_BACKEND_h
+#define _ASCON_AEAD_CRYPTO_BACKEND_h
+
+#include "../Link/LoLaCryptoDefinition.h"
+
+/*
+* https://github.com/rweather/arduinolibs
+*
+* Requires library CryptoLW from repository.
+*/
+#include <Ascon128.h>
+
+/// <summary>
+/// Ascon128 AEAD over another backend.
+/// Linked packets are signed by the cypher's truncated tag, in the same pass as the encryption.
+/// The base backend's Hasher is still used for KDF, addressing and unlinked packets.
+/// </summary>
+/// <typeparam name="MacBackend">Base backend, see LoLaCryptoBackend.h.</typeparam>
+template<typename MacBackend>
+struct AsconAeadCryptoBackend : MacBackend
+{
+	using Cypher = Ascon128;
+
+	static constexpr bool AEAD = true;
+};
+#endif
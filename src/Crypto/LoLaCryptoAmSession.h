@@ -7,23 +7,49 @@
 
 /// <summary>
 /// Address Match (AM) session based on addresses, access password and secret key.
+/// Session keys are derived incrementally, one hash pass per Calculate call.
 /// </summary>
-class LoLaCryptoAmSession final : public LoLaCryptoEncoderSession
+/// <typeparam name="CryptoBackend">Hasher and cypher policy, see LoLaCryptoBackend.h.</typeparam>
+template<typename CryptoBackend = LoLaCryptoDefaultBackend>
+class LoLaCryptoAmSession final : public LoLaCryptoEncoderSession<CryptoBackend>
 {
+private:
+	using BaseClass = LoLaCryptoEncoderSession<CryptoBackend>;
+
+	using BaseClass::LocalAddress;
+	using BaseClass::SecretKey;
+	using BaseClass::AccessPassword;
+	using BaseClass::HKDFSize;
+	using BaseClass::SetPartnerAddress;
+	using BaseClass::ClearPartnerAddress;
+	using BaseClass::StartExpandedKey;
+	using BaseClass::CalculateExpandedKeyBlock;
+	using BaseClass::FinishExpandedKey;
+	using BaseClass::CalculateInputKey;
+	using BaseClass::CalculateOutputKey;
+	using BaseClass::CalculateSessionPrefixes;
+
 private:
 	enum class AmEnum
 	{
 		NoPartner,
 		CalculatingExpandedKey,
-		CalculatingAddressing,
+		CalculatingInputKey,
+		CalculatingOutputKey,
+		CalculatingPrefixes,
 		AmCached
 	};
 
 private:
 	AmEnum AmState = AmEnum::NoPartner;
 
+	/// <summary>
+	/// Expanded key byte index, for the next block.
+	/// </summary>
+	uint8_t KeyIndex = 0;
+
 public:
-	LoLaCryptoAmSession() : LoLaCryptoEncoderSession()
+	LoLaCryptoAmSession() : BaseClass()
 	{}
 
 public:
@@ -53,11 +79,13 @@ public:
 		}
 
 		SetPartnerAddress(source);
+		KeyIndex = 0;
 		AmState = AmEnum::CalculatingExpandedKey;
 	}
 
 	/// <summary>
 	/// Long operations, cannot be done in line with linking protocol.
+	/// Runs a single step per call, so the caller can yield between steps.
 	/// </summary>
 	void Calculate()
 	{
@@ -73,11 +101,27 @@ public:
 		case AmEnum::NoPartner:
 			break;
 		case AmEnum::CalculatingExpandedKey:
-			CalculateExpandedKey();
-			AmState = AmEnum::CalculatingAddressing;
+			if (KeyIndex == 0)
+			{
+				StartExpandedKey();
+			}
+			KeyIndex = CalculateExpandedKeyBlock(KeyIndex);
+			if (KeyIndex >= HKDFSize)
+			{
+				FinishExpandedKey();
+				AmState = AmEnum::CalculatingInputKey;
+			}
+			break;
+		case AmEnum::CalculatingInputKey:
+			CalculateInputKey();
+			AmState = AmEnum::CalculatingOutputKey;
+			break;
+		case AmEnum::CalculatingOutputKey:
+			CalculateOutputKey();
+			AmState = AmEnum::CalculatingPrefixes;
 			break;
-		case AmEnum::CalculatingAddressing:
-			CalculateSessionAddressing();
+		case AmEnum::CalculatingPrefixes:
+			CalculateSessionPrefixes();
 			AmState = AmEnum::AmCached;
 			break;
 		case AmEnum::AmCached:
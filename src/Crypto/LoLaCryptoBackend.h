@@ -0,0 +1,68 @@
+// LoLaCryptoBackend.h
+
+#ifndef _LOLA_CRYPTO_BACKEND_h
+#define _LOLA_CRYPTO_BACKEND_h
+
+/*
+* Compile-time crypto backend policy, for LoLaCryptoSession and derived sessions.
+* struct CryptoBackend
+* {
+*	// MAC and KDF hasher. Same interface as XoodyakHashWrapper and Poly1305Wrapper.
+*	using Hasher;
+*	// Cypher. Same interface as Ascon128: setKey, setIV, encrypt, decrypt, computeTag, checkTag.
+*	using Cypher;
+*	// Bound into the Protocol Id, so partners with different backends never link.
+*	static constexpr LoLaCryptoDefinition::MacType MAC_TYPE;
+*	// Linked MAC key size, in the expanded key. At least LoLaCryptoDefinition::MAC_KEY_MIN_SIZE.
+*	static constexpr uint8_t MAC_KEY_SIZE;
+*	// Linked packets are signed by the cypher's tag, instead of the Hasher's MAC.
+*	static constexpr bool AEAD;
+* };
+*
+* Hardware accelerated backends (i.e. ESP32 AES/SHA, STM32 AES)
+*  wrap the peripheral driver with the same interfaces and are passed as the session's template parameter.
+*/
+
+/// <summary>
+/// Overload tag, so only the backend's linked authentication path is instantiated.
+/// </summary>
+template<const bool Aead>
+struct TemplateAeadTag {};
+
+/// <summary>
+/// Linked MAC states with the directional keys already absorbed.
+/// Empty for AEAD backends.
+/// </summary>
+template<typename CryptoBackend, const bool Aead = CryptoBackend::AEAD>
+struct TemplateMacPrefixStruct
+{
+	typename CryptoBackend::Hasher::PrefixState InputPrefix;
+	typename CryptoBackend::Hasher::PrefixState OutputPrefix;
+};
+
+template<typename CryptoBackend>
+struct TemplateMacPrefixStruct<CryptoBackend, true>
+{};
+
+#include "XoodyakCryptoBackend.h"
+#include "AsconAeadCryptoBackend.h"
+
+#if defined(LOLA_USE_POLY1305)
+#include "Poly1305CryptoBackend.h"
+#endif
+
+/// <summary>
+/// Backend for the link's session.
+/// </summary>
+#if defined(LOLA_USE_POLY1305)
+using LoLaCryptoMacBackend = Poly1305CryptoBackend;
+#else
+using LoLaCryptoMacBackend = XoodyakCryptoBackend;
+#endif
+
+#if defined(LOLA_USE_ASCON_AEAD)
+using LoLaCryptoDefaultBackend = AsconAeadCryptoBackend<LoLaCryptoMacBackend>;
+#else
+using LoLaCryptoDefaultBackend = LoLaCryptoMacBackend;
+#endif
+#endif
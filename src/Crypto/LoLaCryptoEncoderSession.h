@@ -5,78 +5,149 @@
 
 #include "LoLaCryptoSession.h"
 
-/*
-* https://github.com/rweather/arduinolibs
-*
-* Requires library CryptoLW from repository.
-*/
-#include <Ascon128.h>
-
 /// <summary>
 /// Encodes and decodes LoLa packets.
+/// Linked packets are encrypted and then signed by a separate MAC,
+///  or with an AEAD backend, signed by the cypher's own AEAD tag in the same pass.
 /// </summary>
-class LoLaCryptoEncoderSession : public LoLaCryptoSession
+/// <typeparam name="CryptoBackend">Hasher and cypher policy, see LoLaCryptoBackend.h.</typeparam>
+template<typename CryptoBackend>
+class LoLaCryptoEncoderSession : public LoLaCryptoSession<CryptoBackend>
 {
+private:
+	using BaseClass = LoLaCryptoSession<CryptoBackend>;
+
+protected:
+	using BaseClass::CryptoHasher;
+	using BaseClass::Nonce;
+	using BaseClass::Keys;
+	using BaseClass::UnlinkedPrefix;
+	using BaseClass::GetKeys;
+
+	using SessionKeysStruct = typename BaseClass::SessionKeysStruct;
+	using AeadTag = typename BaseClass::AeadTag;
+
 private:
 	/// <summary>
 	/// Cryptographic cypher.
+	/// Keyed once per session, only the IV is set per packet.
 	/// </summary>
-	Ascon128 CryptoCypher{};
+	typename CryptoBackend::Cypher CryptoCypher{};
 
 public:
 	LoLaCryptoEncoderSession()
-		: LoLaCryptoSession()
+		: BaseClass()
 	{}
 
+protected:
+	/// <summary>
+	/// Same key for both directions, the nonce differs.
+	/// </summary>
+	virtual void OnExpandedKeyUpdated()
+	{
+		CryptoCypher.setKey(Keys->ExpandedKey.CypherKey, LoLaCryptoDefinition::CYPHER_KEY_SIZE);
+	}
+
+public:
 	const bool Setup()
 	{
 		return CryptoHasher.DIGEST_LENGTH >= LoLaPacketDefinition::MAC_SIZE
 			&& 2 == LoLaPacketDefinition::ID_SIZE
 			&& CryptoCypher.keySize() == LoLaCryptoDefinition::CYPHER_KEY_SIZE
-			&& CryptoCypher.ivSize() == LoLaCryptoDefinition::CYPHER_IV_SIZE;
+			&& CryptoCypher.ivSize() == LoLaCryptoDefinition::CYPHER_IV_SIZE
+			&& (!CryptoBackend::AEAD || CryptoCypher.tagSize() >= LoLaPacketDefinition::MAC_SIZE);
 	}
 
 	/// <summary>
-	/// Validates and decodes packet with implicit addressing, key and token.
+	/// Validates and decodes packet with implicit addressing, key, token and counter.
+	/// Data can point to the packet's own data section, to decode in place.
 	/// </summary>
 	/// <param name="inPacket"></param>
 	/// <param name="data"></param>
 	/// <param name="timestamp"></param>
+	/// <param name="counter">Implicit counter, extended from the packet id by the receiver.</param>
 	/// <param name="dataSize"></param>
-	/// <param name="counter"></param>
 	/// <returns>True if packet was accepted.</returns>
-	const bool DecodeInPacket(const uint8_t* inPacket, uint8_t* data, const uint32_t timestamp, uint16_t& counter, const uint8_t dataSize)
+	const bool DecodeInPacket(const uint8_t* inPacket, uint8_t* data, const uint32_t timestamp, const uint32_t counter, const uint8_t dataSize)
+	{
+		const SessionKeysStruct* keys = GetKeys(timestamp);
+		if (keys == Keys)
+		{
+			return DecodeInPacket(*keys, inPacket, data, timestamp, counter, dataSize);
+		}
+
+		// Late packet, stamped before the last rekey switch over.
+		CryptoCypher.setKey(keys->ExpandedKey.CypherKey, LoLaCryptoDefinition::CYPHER_KEY_SIZE);
+		const bool accepted = DecodeInPacket(*keys, inPacket, data, timestamp, counter, dataSize);
+		CryptoCypher.setKey(Keys->ExpandedKey.CypherKey, LoLaCryptoDefinition::CYPHER_KEY_SIZE);
+
+		return accepted;
+	}
+
+private:
+	/// <summary>
+	/// Linked decode with the given keys, the cypher must already be keyed with them.
+	/// </summary>
+	const bool DecodeInPacket(const SessionKeysStruct& keys, const uint8_t* inPacket, uint8_t* data, const uint32_t timestamp, const uint32_t counter, const uint8_t dataSize)
 	{
 		// Set Nonce.
 		Nonce[LoLaCryptoDefinition::CYPHER_TAG_TIMESTAMP_INDEX] = timestamp;
 		Nonce[LoLaCryptoDefinition::CYPHER_TAG_TIMESTAMP_INDEX + 1] = timestamp >> 8;
 		Nonce[LoLaCryptoDefinition::CYPHER_TAG_TIMESTAMP_INDEX + 2] = timestamp >> 16;
 		Nonce[LoLaCryptoDefinition::CYPHER_TAG_TIMESTAMP_INDEX + 3] = timestamp >> 24;
-		Nonce[LoLaCryptoDefinition::CYPHER_TAG_ID_INDEX] = inPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Id];
-		Nonce[LoLaCryptoDefinition::CYPHER_TAG_ID_INDEX + 1] = inPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Id + 1];
-		memcpy(&Nonce[LoLaCryptoDefinition::CYPHER_TAG_SIZE], InputKey, LoLaCryptoDefinition::CYPHER_IV_SIZE - LoLaCryptoDefinition::CYPHER_TAG_SIZE);
+		Nonce[LoLaCryptoDefinition::CYPHER_TAG_ID_INDEX] = counter;
+		Nonce[LoLaCryptoDefinition::CYPHER_TAG_ID_INDEX + 1] = counter >> 8;
+		Nonce[LoLaCryptoDefinition::CYPHER_TAG_ID_INDEX + 2] = counter >> 16;
+		Nonce[LoLaCryptoDefinition::CYPHER_TAG_ID_INDEX + 3] = counter >> 24;
+		memcpy(&Nonce[LoLaCryptoDefinition::CYPHER_TAG_SIZE], keys.InputKey, LoLaCryptoDefinition::CYPHER_IV_SIZE - LoLaCryptoDefinition::CYPHER_TAG_SIZE);
+
+		return DecryptInPacket(keys, inPacket, data, dataSize, AeadTag());
+	}
 
+	/// <summary>
+	/// AEAD backend, authenticated by the cypher's tag.
+	/// </summary>
+	const bool DecryptInPacket(const SessionKeysStruct&, const uint8_t* inPacket, uint8_t* data, const uint8_t dataSize, TemplateAeadTag<true>)
+	{
+		/*****************/
+		// Set cypher IV with mixed nonce, the packet id is authenticated through it.
+		CryptoCypher.setIV(Nonce, LoLaCryptoDefinition::CYPHER_IV_SIZE);
+
+		// Single pass: the tag is absorbed from the ciphertext, as it's decrypted. Can decrypt in place.
+		// Deliberate trade-off: the tag can only be checked once the whole ciphertext is absorbed,
+		//  so a forged packet costs the cypher pass, instead of the MAC-only pass of MAC-first rejection.
+		// CryptoBenchmark reports this as Reject Linked, next to the separate MAC path.
+		CryptoCypher.decrypt(data, &inPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Data], dataSize);
+
+		// Reject if the truncated tag mismatches the plaintext MAC from packet.
+		if (!CryptoCypher.checkTag(&inPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Mac], LoLaPacketDefinition::MAC_SIZE))
+		{
+			// Packet rejected, unauthenticated plaintext is wiped before it can reach any listener.
+			memset(data, 0, dataSize);
+			return false;
+		}
 		/*****************/
-#if defined(LOLA_USE_POLY1305)
-		// Start HMAC with Key.
-		CryptoHasher.reset(ExpandedKey.MacKey);
-#else
-		// Start MAC.
-		CryptoHasher.reset();
 
-		// Nonce.
-		CryptoHasher.update(Nonce, LoLaCryptoDefinition::CYPHER_IV_SIZE);
-#endif
+		return true;
+	}
+
+	/// <summary>
+	/// Separate MAC backend, authenticated before decrypting.
+	/// </summary>
+	const bool DecryptInPacket(const SessionKeysStruct& keys, const uint8_t* inPacket, uint8_t* data, const uint8_t dataSize, TemplateAeadTag<false>)
+	{
+		/*****************/
+		// Start MAC with the input key already absorbed.
+		CryptoHasher.restorePrefix(keys.InputPrefix);
+		// Nonce tag, the key part is in the prefix.
+		// Also for Poly1305, its truncated MAC only depends on the low bytes of the finalize nonce.
+		CryptoHasher.update(Nonce, LoLaCryptoDefinition::CYPHER_TAG_SIZE);
 
 		// Content.
 		CryptoHasher.update(&inPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Content], LoLaPacketDefinition::GetContentSizeFromDataSize(dataSize));
 
 		// Reject if HMAC mismatches plaintext MAC from packet.
-#if defined(LOLA_USE_POLY1305)
 		if (!CryptoHasher.macMatches(Nonce, &inPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Mac]))
-#else
-		if (!CryptoHasher.macMatches(&inPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Mac]))
-#endif
 		{
 			// Packet rejected.
 			return false;
@@ -84,24 +155,20 @@ public:
 		/*****************/
 
 		/*****************/
-		// Write back the counter from the packet id.
-		counter = ((uint16_t)inPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Id + 1] << 8) | inPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Id];
-
-		// Reset Key entropy.
-		CryptoCypher.setKey(ExpandedKey.CypherKey, LoLaCryptoDefinition::CYPHER_KEY_SIZE);
-
 		// Set cypher IV with mixed nonce as authentication data.
 		CryptoCypher.setIV(Nonce, LoLaCryptoDefinition::CYPHER_IV_SIZE);
 
-		// Decrypt everything but the packet id.
+		// Decrypt everything but the packet id. Can decrypt in place.
 		CryptoCypher.decrypt(data, &inPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Data], dataSize);
 		/*****************/
 
 		return true;
 	}
 
+public:
 	/// <summary>
 	/// Validates and decodes packet without implicit addressing, key or token.
+	/// Data can point to the packet's own data section, to decode in place.
 	/// </summary>
 	/// <param name="inPacket"></param>
 	/// <param name="data"></param>
@@ -111,21 +178,11 @@ public:
 	const bool DecodeInPacket(const uint8_t* inPacket, uint8_t* data, uint16_t& counter, const uint8_t dataSize)
 	{
 		// Calculate MAC from content.
-#if defined(LOLA_USE_POLY1305)
-		ClearNonce();
-		CryptoHasher.reset(Nonce);
-#else
-		CryptoHasher.reset();
-#endif
-		CryptoHasher.update(ProtocolId, LoLaLinkDefinition::PROTOCOL_ID_SIZE);
+		CryptoHasher.restorePrefix(UnlinkedPrefix);
 		CryptoHasher.update(&inPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Content], LoLaPacketDefinition::GetContentSizeFromDataSize(dataSize));
 
 		// Reject if HMAC mismatches plaintext MAC from packet.
-#if defined(LOLA_USE_POLY1305)
-		if (!CryptoHasher.macMatches(Nonce, &inPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Mac]))
-#else
 		if (!CryptoHasher.macMatches(&inPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Mac]))
-#endif
 		{
 			// Packet rejected.
 			return false;
@@ -134,14 +191,18 @@ public:
 		// Copy plaintext counter from packet id.		
 		counter = ((uint16_t)inPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Id + 1] << 8) | inPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Id];
 
-		// Copy plaintext content to in data.
-		memcpy(data, &inPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Data], dataSize);
+		// Copy plaintext content to in data, unless decoding in place.
+		if (data != &inPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Data])
+		{
+			memcpy(data, &inPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Data], dataSize);
+		}
 
 		return true;
 	}
 
 	/// <summary>
 	/// Encodes packet without implicit addressing, key or token.
+	/// Data can point to the packet's own data section, to encode in place.
 	/// </summary>
 	/// <param name="data"></param>
 	/// <param name="outPacket"></param>
@@ -153,36 +214,30 @@ public:
 		outPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Id] = counter;
 		outPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Id + 1] = counter >> 8;
 
-		// Plaintext copy of data to output.
-		memcpy(&outPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Data], data, dataSize);
+		// Plaintext copy of data to output, unless encoding in place.
+		if (data != &outPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Data])
+		{
+			memcpy(&outPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Data], data, dataSize);
+		}
 
 		// Set HMAC without implicit addressing, key or token.
-#if defined(LOLA_USE_POLY1305)
-		ClearNonce();
-		CryptoHasher.reset(Nonce);
-#else
-		CryptoHasher.reset();
-#endif
-		CryptoHasher.update(ProtocolId, LoLaLinkDefinition::PROTOCOL_ID_SIZE);
+		CryptoHasher.restorePrefix(UnlinkedPrefix);
 		CryptoHasher.update(&outPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Content], LoLaPacketDefinition::GetContentSizeFromDataSize(dataSize));
 
 		// Only the first LoLaPacketDefinition:MAC_SIZE bytes are effectively used.
-#if defined(LOLA_USE_POLY1305)
-		CryptoHasher.finalize(Nonce, &outPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Mac], LoLaPacketDefinition::MAC_SIZE);
-#else
 		CryptoHasher.finalize(&outPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Mac], LoLaPacketDefinition::MAC_SIZE);
-#endif
 	}
 
 	/// <summary>
-	/// Encodes packet with implicit addressing, key and token.
+	/// Encodes packet with implicit addressing, key, token and counter.
+	/// Data can point to the packet's own data section, to encode in place.
 	/// </summary>
 	/// <param name="data"></param>
 	/// <param name="outPacket"></param>
 	/// <param name="timestamp"></param>
-	/// <param name="counter"></param>
+	/// <param name="counter">Implicit counter, only the low bytes are sent as packet id.</param>
 	/// <param name="dataSize"></param>
-	void EncodeOutPacket(const uint8_t* data, uint8_t* outPacket, const uint32_t timestamp, const uint16_t counter, const uint8_t dataSize)
+	void EncodeOutPacket(const uint8_t* data, uint8_t* outPacket, const uint32_t timestamp, const uint32_t counter, const uint8_t dataSize)
 	{
 		//// Set Nonce.
 		Nonce[LoLaCryptoDefinition::CYPHER_TAG_TIMESTAMP_INDEX] = timestamp;
@@ -191,16 +246,15 @@ public:
 		Nonce[LoLaCryptoDefinition::CYPHER_TAG_TIMESTAMP_INDEX + 3] = timestamp >> 24;
 		Nonce[LoLaCryptoDefinition::CYPHER_TAG_ID_INDEX] = counter;
 		Nonce[LoLaCryptoDefinition::CYPHER_TAG_ID_INDEX + 1] = counter >> 8;
-		memcpy(&Nonce[LoLaCryptoDefinition::CYPHER_TAG_SIZE], OutputKey, LoLaCryptoDefinition::CYPHER_IV_SIZE - LoLaCryptoDefinition::CYPHER_TAG_SIZE);
+		Nonce[LoLaCryptoDefinition::CYPHER_TAG_ID_INDEX + 2] = counter >> 16;
+		Nonce[LoLaCryptoDefinition::CYPHER_TAG_ID_INDEX + 3] = counter >> 24;
+		memcpy(&Nonce[LoLaCryptoDefinition::CYPHER_TAG_SIZE], Keys->OutputKey, LoLaCryptoDefinition::CYPHER_IV_SIZE - LoLaCryptoDefinition::CYPHER_TAG_SIZE);
 
 		/*****************/
-		// Reset Key entropy.
-		CryptoCypher.setKey(ExpandedKey.CypherKey, LoLaCryptoDefinition::CYPHER_KEY_SIZE);
-
 		// Set cypher IV with nonce as authentication data.
 		CryptoCypher.setIV(Nonce, LoLaCryptoDefinition::CYPHER_IV_SIZE);
 
-		// Encrypt data to packet.
+		// Encrypt data to packet. Can encrypt in place.
 		CryptoCypher.encrypt(&outPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Data], data, dataSize);
 
 		// Copy plaintext counter to packet id.		
@@ -208,28 +262,36 @@ public:
 		outPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Id + 1] = Nonce[LoLaCryptoDefinition::CYPHER_TAG_ID_INDEX + 1];
 		/*****************/
 
-		/*****************/
-#if defined(LOLA_USE_POLY1305)
-		// Start HMAC with Key.
-		CryptoHasher.reset(ExpandedKey.MacKey);
-#else
-		// Start MAC.
-		CryptoHasher.reset();
+		SignOutPacket(outPacket, dataSize, AeadTag());
+	}
 
-		// Nonce.
-		CryptoHasher.update(Nonce, LoLaCryptoDefinition::CYPHER_IV_SIZE);
-#endif
+private:
+	/// <summary>
+	/// AEAD backend, signed by the cypher's tag.
+	/// </summary>
+	void SignOutPacket(uint8_t* outPacket, const uint8_t, TemplateAeadTag<true>)
+	{
+		// Truncated AEAD tag as the packet MAC, from the same pass.
+		CryptoCypher.computeTag(&outPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Mac], LoLaPacketDefinition::MAC_SIZE);
+	}
+
+	/// <summary>
+	/// Separate MAC backend, signed by the output prefix.
+	/// </summary>
+	void SignOutPacket(uint8_t* outPacket, const uint8_t dataSize, TemplateAeadTag<false>)
+	{
+		/*****************/
+		// Start MAC with the output key already absorbed.
+		CryptoHasher.restorePrefix(Keys->OutputPrefix);
+		// Nonce tag, the key part is in the prefix.
+		// Also for Poly1305, its truncated MAC only depends on the low bytes of the finalize nonce.
+		CryptoHasher.update(Nonce, LoLaCryptoDefinition::CYPHER_TAG_SIZE);
 
 		// Content.
 		CryptoHasher.update(&outPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Content], LoLaPacketDefinition::GetContentSizeFromDataSize(dataSize));
 
-#if defined(LOLA_USE_POLY1305)
-		// Nonce and finalize HMAC.
+		// Nonce (if the MAC takes one) and finalize MAC.
 		CryptoHasher.finalize(Nonce, &outPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Mac], LoLaPacketDefinition::MAC_SIZE);
-#else
-		// Finalize MAC.
-		CryptoHasher.finalize(&outPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Mac], LoLaPacketDefinition::MAC_SIZE);
-#endif
 		/*****************/
 	}
 };
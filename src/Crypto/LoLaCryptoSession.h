@@ -10,22 +10,13 @@
 #include "LoLaRandom.h"
 #include "SeedXorShifter.h"
 
-#if defined(LOLA_USE_POLY1305)
-/*
-* https://github.com/OperatorFoundation/Crypto
-* (Arduino fork of https://github.com/rweather/arduinolibs)
-*/
-#include "Poly1305Wrapper.h"
-#else
-/*
-* https://github.com/rweather/lightweight-crypto
-*/
-#include "XoodyakHashWrapper.h"
-#endif
+#include "LoLaCryptoBackend.h"
 
 /// <summary>
 /// Cryptographic session features.
 /// </summary>
+/// <typeparam name="CryptoBackend">Hasher and cypher policy, see LoLaCryptoBackend.h.</typeparam>
+template<typename CryptoBackend>
 class LoLaCryptoSession : public LoLaLinkSession
 {
 private:
@@ -38,17 +29,17 @@ protected:
 	/// <summary>
 	/// MAC and Signature hasher.
 	/// </summary>
-#if defined(LOLA_USE_POLY1305)
-	Poly1305Wrapper CryptoHasher{};
-#else
-	XoodyakHashWrapper<LoLaPacketDefinition::MAC_SIZE> CryptoHasher{};
-#endif
+	typename CryptoBackend::Hasher CryptoHasher{};
 
 protected:
+	using ExpandedKeyStruct = LoLaCryptoDefinition::TemplateExpandedKeyStruct<CryptoBackend::MAC_KEY_SIZE>;
+
 	/// <summary>
-	/// HKDF Expanded key, with extra seeds.
+	/// Selects the linked authentication path of the backend.
 	/// </summary>
-	LoLaCryptoDefinition::ExpandedKeyStruct ExpandedKey{};
+	using AeadTag = TemplateAeadTag<CryptoBackend::AEAD>;
+
+	static constexpr uint8_t HKDFSize = sizeof(ExpandedKeyStruct);
 
 	/// <summary>
 	/// Reusable nonce for encode/decode. 2 extra bytes to keep the size required by the cypher.
@@ -63,16 +54,51 @@ protected:
 
 protected:
 	/// <summary>
-	/// Implicit addressing Rx key.
-	/// Extracted from seed and public keys: [Sender|Receiver]
+	/// Session keys, with everything derived from them for linked packets.
+	/// Separate MAC backends also keep the MAC states with the directional keys already absorbed.
+	/// </summary>
+	struct SessionKeysStruct : TemplateMacPrefixStruct<CryptoBackend>
+	{
+		/// <summary>
+		/// HKDF Expanded key, with extra seeds.
+		/// </summary>
+		ExpandedKeyStruct ExpandedKey;
+
+		/// <summary>
+		/// Implicit addressing Rx key.
+		/// Extracted from seed and public keys: [Sender|Receiver]
+		/// </summary>
+		uint8_t InputKey[LoLaCryptoDefinition::ADDRESS_KEY_SIZE];
+
+		/// <summary>
+		/// Implicit addressing Tx key.
+		/// Extracted from seed and public keys: [Receiver|Sender]
+		/// </summary>
+		uint8_t OutputKey[LoLaCryptoDefinition::ADDRESS_KEY_SIZE];
+
+	};
+
+private:
+	SessionKeysStruct KeySlots[2]{};
+
+protected:
+	/// <summary>
+	/// Keys in use.
 	/// </summary>
-	uint8_t InputKey[LoLaCryptoDefinition::ADDRESS_KEY_SIZE]{};
+	SessionKeysStruct* Keys = &KeySlots[0];
 
 	/// <summary>
-	/// Implicit addressing Tx key.
-	/// Extracted from seed and public keys: [Receiver|Sender]
+	/// Next keys while a rekey is pending,
+	///  previous keys for one second after the switch over.
 	/// </summary>
-	uint8_t OutputKey[LoLaCryptoDefinition::ADDRESS_KEY_SIZE]{};
+	SessionKeysStruct* OtherKeys = &KeySlots[1];
+
+protected:
+	/// <summary>
+	/// MAC state with the Protocol Id already absorbed.
+	/// Restored per packet, instead of re-absorbing it.
+	/// </summary>
+	typename CryptoBackend::Hasher::PrefixState UnlinkedPrefix{};
 
 protected:
 	/// <summary>
@@ -86,21 +112,60 @@ protected:
 	const uint8_t* AccessPassword = nullptr;
 
 	/// <summary>
-	/// Pointer to secret key. sizeof LoLaLinkDefinition::SECRET_KEY_SIZE.
+	/// Pointer to secret key. sizeof SecretKeySize.
 	/// </summary>
 	const uint8_t* SecretKey = nullptr;
 
+	/// <summary>
+	/// Secret key size in bytes, a PKE shared secret is longer than LoLaLinkDefinition::SECRET_KEY_SIZE.
+	/// </summary>
+	uint8_t SecretKeySize = LoLaLinkDefinition::SECRET_KEY_SIZE;
+
 private:
 	uint8_t PartnerAddress[LoLaLinkDefinition::PUBLIC_ADDRESS_SIZE]{};
 	uint8_t LocalChallengeCode[LoLaLinkDefinition::CHALLENGE_CODE_SIZE]{};
 	uint8_t PartnerChallengeCode[LoLaLinkDefinition::CHALLENGE_CODE_SIZE]{};
 	uint8_t PartnerChallengeSignature[LoLaLinkDefinition::CHALLENGE_SIGNATURE_SIZE]{};
 
+private:
+	enum class RekeyEnum : uint8_t
+	{
+		None,
+		Ratcheting,
+		CalculatingInputKey,
+		CalculatingOutputKey,
+		CalculatingPrefixes,
+		Ready
+	};
+
+	/// <summary>
+	/// Both partners' fresh contributions, until the next keys are ratcheted.
+	/// </summary>
+	uint8_t RekeyServerSeed[LoLaCryptoDefinition::REKEY_SEED_SIZE]{};
+	uint8_t RekeyClientSeed[LoLaCryptoDefinition::REKEY_SEED_SIZE]{};
+
+	/// <summary>
+	/// Switch over second of the pending rekey, or of the last one while PreviousValid.
+	/// </summary>
+	uint32_t RekeySecond = 0;
+	uint16_t RekeyCount = 0;
+	RekeyEnum RekeyState = RekeyEnum::None;
+	uint8_t RekeyIndex = 0;
+	bool PreviousValid = false;
+	bool RekeyLate = false;
+
 public:
 	LoLaCryptoSession()
 		: LoLaLinkSession()
 	{}
 
+protected:
+	/// <summary>
+	/// Fires when the expanded key changes, for derived keyed state.
+	/// </summary>
+	virtual void OnExpandedKeyUpdated() {}
+
+public:
 	const uint8_t GetPrngHopChannel(const uint32_t tokenIndex)
 	{
 		// Add Token Index and return the result.
@@ -136,27 +201,23 @@ public:
 		const uint32_t hopperPeriod,
 		const uint32_t transceiverCode)
 	{
-#if defined(LOLA_USE_POLY1305)
-		ClearNonce();
-		CryptoHasher.reset(Nonce);
-#else
 		CryptoHasher.reset();
-#endif
 		CryptoHasher.update(LoLaLinkDefinition::LOLA_VERSION);
-#if defined(LOLA_USE_POLY1305)
-		CryptoHasher.update((uint8_t)LoLaCryptoDefinition::MacType::Poly1305);
-#else
-		CryptoHasher.update((uint8_t)LoLaCryptoDefinition::MacType::Xoodyak);
-#endif
+		CryptoHasher.update((uint8_t)CryptoBackend::MAC_TYPE);
+		if (CryptoBackend::AEAD)
+		{
+			CryptoHasher.update((uint8_t)LoLaCryptoDefinition::MacType::Ascon128);
+		}
 		CryptoHasher.update(duplexPeriod);
 		CryptoHasher.update(hopperPeriod);
 		CryptoHasher.update(transceiverCode);
 
-#if defined(LOLA_USE_POLY1305)
-		CryptoHasher.finalize(Nonce, ProtocolId, LoLaLinkDefinition::PROTOCOL_ID_SIZE);
-#else
 		CryptoHasher.finalize(ProtocolId, LoLaLinkDefinition::PROTOCOL_ID_SIZE);
-#endif
+
+		// Unlinked packets are signed with the Protocol Id.
+		CryptoHasher.reset();
+		CryptoHasher.update(ProtocolId, LoLaLinkDefinition::PROTOCOL_ID_SIZE);
+		CryptoHasher.savePrefix(UnlinkedPrefix);
 		CryptoHasher.clear();
 
 #if defined(DEBUG_LOLA)
@@ -199,6 +260,7 @@ public:
 	/// -	access password
 	///	-	session id
 	///	-	protocol id
+	/// Blocking, see StartExpandedKey for the incremental steps.
 	/// </summary>
 	void CalculateExpandedKey()
 	{
@@ -206,89 +268,313 @@ public:
 		{
 			return;
 		}
-#if defined(LOLA_USE_POLY1305)
-		ClearNonce();
-#endif
+
+		StartExpandedKey();
 		uint8_t index = 0;
-		while (index < LoLaCryptoDefinition::HKDFSize)
+		while (index < HKDFSize)
 		{
-#if defined(LOLA_USE_POLY1305)
-			CryptoHasher.reset(Nonce);
-#else
-			CryptoHasher.reset();
-#endif
-			CryptoHasher.update(ProtocolId, LoLaLinkDefinition::PROTOCOL_ID_SIZE);
-			CryptoHasher.update(index);
-			for (uint_fast8_t i = 0; i < LoLaLinkDefinition::PUBLIC_ADDRESS_SIZE; i++)
-			{
-				CryptoHasher.update((uint8_t)(LocalAddress[i] ^ PartnerAddress[i]));
-			}
-			CryptoHasher.update(SecretKey, LoLaLinkDefinition::SECRET_KEY_SIZE);
-			CryptoHasher.update(AccessPassword, LoLaLinkDefinition::ACCESS_CONTROL_PASSWORD_SIZE);
-			CryptoHasher.update(SessionId, LoLaLinkDefinition::SESSION_ID_SIZE);
+			index = CalculateExpandedKeyBlock(index);
+		}
+		FinishExpandedKey();
+	}
+
+	/// <summary>
+	/// First step of the incremental expanded key, clears any pending rekey.
+	/// Follow with CalculateExpandedKeyBlock until HKDFSize and then FinishExpandedKey.
+	/// Each step is self contained, so packets can be encoded in between.
+	/// </summary>
+	void StartExpandedKey()
+	{
+		ClearRekey();
+		RekeyCount = 0;
+	}
+
+	/// <summary>
+	/// One hash pass of the expanded key.
+	/// </summary>
+	/// <param name="index">Expanded key byte index, starting at 0.</param>
+	/// <returns>Next block's index, HKDFSize when complete.</returns>
+	const uint8_t CalculateExpandedKeyBlock(const uint8_t index)
+	{
+		uint8_t size = HKDFSize - index;
+		if (size > CryptoHasher.DIGEST_LENGTH)
+		{
+			size = CryptoHasher.DIGEST_LENGTH;
+		}
+
+		CryptoHasher.reset();
+		CryptoHasher.update(ProtocolId, LoLaLinkDefinition::PROTOCOL_ID_SIZE);
+		CryptoHasher.update(index);
+		for (uint_fast8_t i = 0; i < LoLaLinkDefinition::PUBLIC_ADDRESS_SIZE; i++)
+		{
+			CryptoHasher.update((uint8_t)(LocalAddress[i] ^ PartnerAddress[i]));
+		}
+		CryptoHasher.update(SecretKey, SecretKeySize);
+		CryptoHasher.update(AccessPassword, LoLaLinkDefinition::ACCESS_CONTROL_PASSWORD_SIZE);
+		CryptoHasher.update(SessionId, LoLaLinkDefinition::SESSION_ID_SIZE);
+		CryptoHasher.finalize(&((uint8_t*)&Keys->ExpandedKey)[index], size);
+		CryptoHasher.clear();
+
+		return index + size;
+	}
+
+	/// <summary>
+	/// Last step of the incremental expanded key, applies it to the keyed state.
+	/// </summary>
+	void FinishExpandedKey()
+	{
+		// Set Hasher with Channel Hop Seed.
+		ChannelHasher.SetSeed(Keys->ExpandedKey.ChannelSeed);
+
+		OnExpandedKeyUpdated();
+	}
 
-			if (LoLaCryptoDefinition::HKDFSize - index > CryptoHasher.DIGEST_LENGTH)
+	/// <summary>
+	/// Agree on the next keys, ratcheted from the current ones and both partners' fresh seeds.
+	/// Only stores the seeds, the next keys are calculated by CalculateRekey, one hash pass per call.
+	/// The current keys stay in use until CheckRekey reaches the switch over second.
+	/// </summary>
+	/// <param name="serverSeed">sizeof LoLaCryptoDefinition::REKEY_SEED_SIZE.</param>
+	/// <param name="clientSeed">sizeof LoLaCryptoDefinition::REKEY_SEED_SIZE.</param>
+	/// <param name="switchSecond">Synced clock second, from which packets use the next keys.</param>
+	void SetRekey(const uint8_t* serverSeed, const uint8_t* clientSeed, const uint32_t switchSecond)
+	{
+		ClearRekey();
+		memcpy(RekeyServerSeed, serverSeed, LoLaCryptoDefinition::REKEY_SEED_SIZE);
+		memcpy(RekeyClientSeed, clientSeed, LoLaCryptoDefinition::REKEY_SEED_SIZE);
+		RekeySecond = switchSecond;
+		RekeyIndex = 0;
+		RekeyState = RekeyEnum::Ratcheting;
+	}
+
+	/// <summary>
+	/// One step of the pending rekey.
+	/// The channel seed is kept, so the hop sequence doesn't depend on the switch over.
+	/// </summary>
+	/// <returns>True if a step was calculated.</returns>
+	const bool CalculateRekey()
+	{
+		switch (RekeyState)
+		{
+		case RekeyEnum::Ratcheting:
+			RekeyIndex = CalculateRekeyBlock(RekeyIndex);
+			if (RekeyIndex >= HKDFSize)
 			{
-#if defined(LOLA_USE_POLY1305)
-				CryptoHasher.finalize(Nonce, &((uint8_t*)&ExpandedKey)[index], CryptoHasher.DIGEST_LENGTH);
-#else
-				CryptoHasher.finalize(&((uint8_t*)&ExpandedKey)[index], CryptoHasher.DIGEST_LENGTH);
-#endif
-				index += CryptoHasher.DIGEST_LENGTH;
+				memcpy(OtherKeys->ExpandedKey.ChannelSeed, Keys->ExpandedKey.ChannelSeed, LoLaCryptoDefinition::CHANNEL_KEY_SIZE);
+				memset(RekeyServerSeed, 0, LoLaCryptoDefinition::REKEY_SEED_SIZE);
+				memset(RekeyClientSeed, 0, LoLaCryptoDefinition::REKEY_SEED_SIZE);
+				RekeyState = RekeyEnum::CalculatingInputKey;
 			}
-			else
+			break;
+		case RekeyEnum::CalculatingInputKey:
+			CalculateInputKey(*OtherKeys);
+			RekeyState = RekeyEnum::CalculatingOutputKey;
+			break;
+		case RekeyEnum::CalculatingOutputKey:
+			CalculateOutputKey(*OtherKeys);
+			RekeyState = RekeyEnum::CalculatingPrefixes;
+			break;
+		case RekeyEnum::CalculatingPrefixes:
+			CalculateSessionPrefixes(*OtherKeys);
+			RekeyState = RekeyEnum::Ready;
+			break;
+		default:
+			return false;
+		}
+
+		return true;
+	}
+
+	const bool HasRekeyPending() const
+	{
+		return RekeyState != RekeyEnum::None;
+	}
+
+	const uint16_t GetRekeyCount() const
+	{
+		return RekeyCount;
+	}
+
+	/// <summary>
+	/// Drops the pending rekey and the previous keys.
+	/// </summary>
+	void ClearRekey()
+	{
+		RekeyState = RekeyEnum::None;
+		RekeyLate = false;
+		PreviousValid = false;
+		memset(RekeyServerSeed, 0, LoLaCryptoDefinition::REKEY_SEED_SIZE);
+		memset(RekeyClientSeed, 0, LoLaCryptoDefinition::REKEY_SEED_SIZE);
+		*OtherKeys = SessionKeysStruct{};
+	}
+
+	/// <summary>
+	/// Switches to the next keys, on the first linked packet stamped at or after the switch over second.
+	/// Both partners stamp a packet with the same second, so they switch on the same packet.
+	/// The next keys are precalculated, so the switch is only a swap.
+	/// If the next keys aren't ready by then, the switch waits for them and linked packets are rejected,
+	///  the link's task finishes the rekey on its next run, see IsRekeyLate.
+	/// The previous keys are kept for one second, for late packets stamped before the switch over.
+	/// </summary>
+	/// <param name="seconds">Packet timestamp seconds.</param>
+	/// <returns>False if the switch over is due but the next keys aren't ready.</returns>
+	const bool CheckRekey(const uint32_t seconds)
+	{
+		if (RekeyState != RekeyEnum::None)
+		{
+			if ((int32_t)(seconds - RekeySecond) >= 0)
 			{
-#if defined(LOLA_USE_POLY1305)
-				CryptoHasher.finalize(Nonce, &((uint8_t*)&ExpandedKey)[index], LoLaCryptoDefinition::HKDFSize - index);
-#else
-				CryptoHasher.finalize(&((uint8_t*)&ExpandedKey)[index], LoLaCryptoDefinition::HKDFSize - index);
-#endif
-				index += (LoLaCryptoDefinition::HKDFSize - index);
+				if (RekeyState != RekeyEnum::Ready)
+				{
+					RekeyLate = true;
+
+					return false;
+				}
+
+				SessionKeysStruct* previous = Keys;
+				Keys = OtherKeys;
+				OtherKeys = previous;
+				RekeyState = RekeyEnum::None;
+				RekeyLate = false;
+				PreviousValid = true;
+				RekeyCount++;
+
+				OnExpandedKeyUpdated();
 			}
 		}
+		else if (PreviousValid
+			&& (int32_t)(seconds - RekeySecond) > 0)
+		{
+			PreviousValid = false;
+			*OtherKeys = SessionKeysStruct{};
+		}
+
+		return true;
+	}
+
+	/// <summary>
+	/// A linked packet was held back by a rekey that wasn't ready at the switch over.
+	/// </summary>
+	const bool IsRekeyLate() const
+	{
+		return RekeyLate;
+	}
+
+protected:
+	/// <summary>
+	/// Keys for a linked packet, by its timestamp.
+	/// </summary>
+	/// <param name="seconds">Packet timestamp seconds.</param>
+	/// <returns>Previous keys for a late packet stamped before the last switch over, current keys otherwise.</returns>
+	const SessionKeysStruct* GetKeys(const uint32_t seconds) const
+	{
+		if (PreviousValid
+			&& (int32_t)(seconds - RekeySecond) < 0)
+		{
+			return OtherKeys;
+		}
+
+		return Keys;
+	}
+
+private:
+	/// <summary>
+	/// One hash pass of the ratcheted expanded key.
+	/// </summary>
+	/// <param name="index">Expanded key byte index, starting at 0.</param>
+	/// <returns>Next block's index, HKDFSize when complete.</returns>
+	const uint8_t CalculateRekeyBlock(const uint8_t index)
+	{
+		uint8_t size = HKDFSize - index;
+		if (size > CryptoHasher.DIGEST_LENGTH)
+		{
+			size = CryptoHasher.DIGEST_LENGTH;
+		}
+
+		CryptoHasher.reset();
+		CryptoHasher.update(index);
+		CryptoHasher.update((uint8_t*)&Keys->ExpandedKey, HKDFSize);
+		CryptoHasher.update(RekeyServerSeed, LoLaCryptoDefinition::REKEY_SEED_SIZE);
+		CryptoHasher.update(RekeyClientSeed, LoLaCryptoDefinition::REKEY_SEED_SIZE);
+		CryptoHasher.finalize(&((uint8_t*)&OtherKeys->ExpandedKey)[index], size);
 		CryptoHasher.clear();
 
-		// Set Hasher with Channel Hop Seed.
-		ChannelHasher.SetSeed(ExpandedKey.ChannelSeed);
+		return index + size;
 	}
 
+public:
 	/// <summary>
 	/// Set the directional Input and Output keys.
+	/// Blocking, the incremental steps are
+	///  CalculateInputKey, CalculateOutputKey and CalculateSessionPrefixes, in order.
 	/// </summary>
-	/// <param name="localKey">Pointer to array of size = keySize.</param>
-	/// <param name="partnerKey">Pointer to array of size = keySize.</param>
-	/// <param name="keySize">[0;UINT8_MAX]</param>
 	void CalculateSessionAddressing()
 	{
-#if defined(LOLA_USE_POLY1305)
-		ClearNonce();
-		CryptoHasher.reset(Nonce);
-#else
+		CalculateInputKey();
+		CalculateOutputKey();
+		CalculateSessionPrefixes();
+	}
+
+	void CalculateInputKey()
+	{
+		CalculateInputKey(*Keys);
+	}
+
+	void CalculateOutputKey()
+	{
+		CalculateOutputKey(*Keys);
+	}
+
+	void CalculateSessionPrefixes()
+	{
+		CalculateSessionPrefixes(*Keys);
+	}
+
+protected:
+	void CalculateInputKey(SessionKeysStruct& keys)
+	{
 		CryptoHasher.reset();
-#endif
-		CryptoHasher.update(ExpandedKey.CypherIvSeed, LoLaCryptoDefinition::ADDRESS_KEY_SIZE);
+		CryptoHasher.update(keys.ExpandedKey.CypherIvSeed, LoLaCryptoDefinition::ADDRESS_KEY_SIZE);
 		CryptoHasher.update(PartnerAddress, LoLaLinkDefinition::PUBLIC_ADDRESS_SIZE);
 		CryptoHasher.update(LocalAddress, LoLaLinkDefinition::PUBLIC_ADDRESS_SIZE);
-#if defined(LOLA_USE_POLY1305)
-		CryptoHasher.finalize(Nonce, InputKey, LoLaCryptoDefinition::ADDRESS_KEY_SIZE);
+		CryptoHasher.finalize(keys.InputKey, LoLaCryptoDefinition::ADDRESS_KEY_SIZE);
+		CryptoHasher.clear();
+	}
 
-		ClearNonce();
-		CryptoHasher.reset(Nonce);
-#else
-		CryptoHasher.finalize(InputKey, LoLaCryptoDefinition::ADDRESS_KEY_SIZE);
+	void CalculateOutputKey(SessionKeysStruct& keys)
+	{
 		CryptoHasher.reset();
-#endif
-		CryptoHasher.update(ExpandedKey.CypherIvSeed, LoLaCryptoDefinition::ADDRESS_KEY_SIZE);
+		CryptoHasher.update(keys.ExpandedKey.CypherIvSeed, LoLaCryptoDefinition::ADDRESS_KEY_SIZE);
 		CryptoHasher.update(LocalAddress, LoLaLinkDefinition::PUBLIC_ADDRESS_SIZE);
 		CryptoHasher.update(PartnerAddress, LoLaLinkDefinition::PUBLIC_ADDRESS_SIZE);
-#if defined(LOLA_USE_POLY1305)
-		CryptoHasher.finalize(Nonce, OutputKey, LoLaCryptoDefinition::ADDRESS_KEY_SIZE);
-#else
-		CryptoHasher.finalize(OutputKey, LoLaCryptoDefinition::ADDRESS_KEY_SIZE);
-#endif
+		CryptoHasher.finalize(keys.OutputKey, LoLaCryptoDefinition::ADDRESS_KEY_SIZE);
 		CryptoHasher.clear();
 	}
 
+	/// <summary>
+	/// Linked packets are signed with the session keys.
+	/// Requires both Input and Output keys.
+	/// </summary>
+	void CalculateSessionPrefixes(SessionKeysStruct& keys)
+	{
+		CalculateMacPrefixes(keys, AeadTag());
+	}
+
+private:
+	/// <summary>
+	/// Signed by the cypher's AEAD tag instead.
+	/// </summary>
+	void CalculateMacPrefixes(SessionKeysStruct&, TemplateAeadTag<true>)
+	{}
+
+	void CalculateMacPrefixes(SessionKeysStruct& keys, TemplateAeadTag<false>)
+	{
+		CryptoHasher.saveMacPrefix(keys.InputPrefix, keys.ExpandedKey.MacKey, keys.InputKey);
+		CryptoHasher.saveMacPrefix(keys.OutputPrefix, keys.ExpandedKey.MacKey, keys.OutputKey);
+		CryptoHasher.clear();
+	}
+
+public:
 	void GetPairingToken(uint8_t* target)
 	{
 		if (LocalAddress == nullptr)
@@ -296,12 +582,7 @@ public:
 			return;
 		}
 
-#if defined(LOLA_USE_POLY1305)
-		ClearNonce();
-		CryptoHasher.reset(Nonce);
-#else
 		CryptoHasher.reset();
-#endif
 		CryptoHasher.update(SessionId, LoLaLinkDefinition::SESSION_ID_SIZE);
 
 		for (uint_fast8_t i = 0; i < LoLaLinkDefinition::PUBLIC_ADDRESS_SIZE; i++)
@@ -309,11 +590,7 @@ public:
 			CryptoHasher.update((uint8_t)(LocalAddress[i] ^ PartnerAddress[i]));
 		}
 
-#if defined(LOLA_USE_POLY1305)
-		CryptoHasher.finalize(Nonce, target, LoLaLinkDefinition::LINKING_TOKEN_SIZE);
-#else
 		CryptoHasher.finalize(target, LoLaLinkDefinition::LINKING_TOKEN_SIZE);
-#endif
 		CryptoHasher.clear();
 	}
 
@@ -333,6 +610,39 @@ public:
 		return true;
 	}
 
+	/// <summary>
+	/// Resume token, from the linked session key and the partners' synced clock.
+	/// Only gates the resume, key possession is proven by the encrypted switch over that follows.
+	/// </summary>
+	/// <param name="seconds">Synced clock seconds.</param>
+	/// <param name="target">Token target, sizeof LoLaLinkDefinition::LINKING_TOKEN_SIZE.</param>
+	void GetResumeToken(const uint32_t seconds, uint8_t* target)
+	{
+		CryptoHasher.reset();
+		CryptoHasher.update((uint8_t*)&Keys->ExpandedKey, HKDFSize);
+		CryptoHasher.update(SessionId, LoLaLinkDefinition::SESSION_ID_SIZE);
+		CryptoHasher.update(seconds);
+
+		CryptoHasher.finalize(target, LoLaLinkDefinition::LINKING_TOKEN_SIZE);
+		CryptoHasher.clear();
+	}
+
+	const bool ResumeTokenMatches(const uint32_t seconds, const uint8_t* resumeToken)
+	{
+		uint8_t localToken[LoLaLinkDefinition::LINKING_TOKEN_SIZE]{};
+
+		GetResumeToken(seconds, localToken);
+
+		for (uint_fast8_t i = 0; i < LoLaLinkDefinition::LINKING_TOKEN_SIZE; i++)
+		{
+			if (resumeToken[i] != localToken[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
 	const bool VerifyChallengeSignature(const uint8_t* signatureSource)
 	{
 		if (AccessPassword == nullptr)
@@ -435,11 +745,6 @@ public:
 	}
 
 protected:
-	void ClearNonce()
-	{
-		memset(Nonce, 0xFF, LoLaCryptoDefinition::CYPHER_IV_SIZE);
-	}
-
 	void SetPartnerAddress(const uint8_t* source)
 	{
 		memcpy(PartnerAddress, source, LoLaLinkDefinition::PUBLIC_ADDRESS_SIZE);
@@ -453,19 +758,10 @@ protected:
 private:
 	void GetChallengeSignature(const uint8_t* challenge, const uint8_t* password, uint8_t* signatureTarget)
 	{
-#if defined(LOLA_USE_POLY1305)
-		ClearNonce();
-		CryptoHasher.reset(Nonce);
-#else
 		CryptoHasher.reset();
-#endif
 		CryptoHasher.update(password, LoLaLinkDefinition::ACCESS_CONTROL_PASSWORD_SIZE);
 		CryptoHasher.update(challenge, LoLaLinkDefinition::CHALLENGE_CODE_SIZE);
-#if defined(LOLA_USE_POLY1305)
-		CryptoHasher.finalize(Nonce, signatureTarget, LoLaLinkDefinition::CHALLENGE_SIGNATURE_SIZE);
-#else
 		CryptoHasher.finalize(signatureTarget, LoLaLinkDefinition::CHALLENGE_SIGNATURE_SIZE);
-#endif
 		CryptoHasher.clear();
 	}
 };
@@ -0,0 +1,38 @@
+// Poly1305CryptoBackend.h
+
+#ifndef _POLY1305_CRYPTO_BACKEND_h
+#define _POLY1305_CRYPTO_BACKEND_h
+
+#include "../Link/LoLaCryptoDefinition.h"
+
+/*
+* https://github.com/OperatorFoundation/Crypto
+* (Arduino fork of https://github.com/rweather/arduinolibs)
+*/
+#include "Poly1305Wrapper.h"
+
+/*
+* https://github.com/rweather/arduinolibs
+*
+* Requires library CryptoLW from repository.
+*/
+#include <Ascon128.h>
+
+/// <summary>
+/// Faster backend for 32 and 64 bit targets, with native wide multiplies.
+/// Poly1305 (Cryptographic Hash function) for MAC and KDF.
+///		MIT licensed.
+///		16 byte (128 bit) bit digest.
+/// Ascon128 cypher.
+/// Linked MACs are keyed by a dedicated MAC key, in the expanded key.
+/// </summary>
+struct Poly1305CryptoBackend
+{
+	using Hasher = Poly1305Wrapper;
+	using Cypher = Ascon128;
+
+	static constexpr LoLaCryptoDefinition::MacType MAC_TYPE = LoLaCryptoDefinition::MacType::Poly1305;
+	static constexpr uint8_t MAC_KEY_SIZE = Poly1305Wrapper::KEY_SIZE;
+	static constexpr bool AEAD = false;
+};
+#endif
@@ -17,11 +17,34 @@ public:
 	static constexpr uint8_t KEY_SIZE = 16;
 	static constexpr uint8_t NONCE_SIZE = 16;
 
+	/// <summary>
+	/// Hasher state, keyed and with a prefix already absorbed.
+	/// </summary>
+	using PrefixState = Poly1305;
+
 private:
 	Poly1305 Hasher{};
 	uint8_t Match[LoLaPacketDefinition::MAC_SIZE]{};
 
+	/// <summary>
+	/// Constant key and nonce, for unkeyed hashes.
+	/// </summary>
+	uint8_t Unkeyed[KEY_SIZE]{};
+
 public:
+	Poly1305Wrapper()
+	{
+		memset(Unkeyed, 0xFF, KEY_SIZE);
+	}
+
+	/// <summary>
+	/// Unkeyed hash, with a constant key.
+	/// </summary>
+	void reset()
+	{
+		Hasher.reset(Unkeyed);
+	}
+
 	void reset(const uint8_t key[KEY_SIZE])
 	{
 		Hasher.reset(key);
@@ -54,16 +77,59 @@ public:
 		Hasher.update(source, size);
 	}
 
+	/// <summary>
+	/// Saves the current state, to restore for every message with the same key and prefix.
+	/// </summary>
+	/// <param name="target">Prefix state to save to.</param>
+	void savePrefix(PrefixState& target)
+	{
+		target = Hasher;
+	}
+
+	/// <summary>
+	/// Starts a message from a saved prefix, instead of reset.
+	/// </summary>
+	/// <param name="source">Prefix state, from savePrefix.</param>
+	void restorePrefix(const PrefixState& source)
+	{
+		Hasher = source;
+	}
+
+	/// <summary>
+	/// Linked MAC prefix, keyed with the session's MAC key for both directions.
+	/// </summary>
+	/// <param name="target">Prefix state to save to.</param>
+	/// <param name="macKey">sizeof KEY_SIZE.</param>
+	/// <param name="addressKey">Unused, the direction is set by the nonce.</param>
+	void saveMacPrefix(PrefixState& target, const uint8_t* macKey, const uint8_t* addressKey)
+	{
+		Hasher.reset(macKey);
+		savePrefix(target);
+	}
+
 	void clear()
 	{
 		Hasher.clear();
 	}
 
+	/// <summary>
+	/// Unkeyed hash, with a constant nonce.
+	/// </summary>
+	void finalize(uint8_t* target, const uint8_t size)
+	{
+		Hasher.finalize(Unkeyed, target, size);
+	}
+
 	void finalize(const uint8_t nonce[NONCE_SIZE], uint8_t* target, const uint8_t size)
 	{
 		Hasher.finalize(nonce, target, size);
 	}
 
+	const bool macMatches(const uint8_t* source)
+	{
+		return macMatches(Unkeyed, source);
+	}
+
 	const bool macMatches(const uint8_t nonce[NONCE_SIZE], const uint8_t* source)
 	{
 		Hasher.finalize(nonce, Match, LoLaPacketDefinition::MAC_SIZE);
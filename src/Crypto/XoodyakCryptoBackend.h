@@ -0,0 +1,37 @@
+// XoodyakCryptoBackend.h
+
+#ifndef _XOODYAK_CRYPTO_BACKEND_h
+#define _XOODYAK_CRYPTO_BACKEND_h
+
+#include "../Link/LoLaCryptoDefinition.h"
+
+/*
+* https://github.com/rweather/lightweight-crypto
+*/
+#include "XoodyakHashWrapper.h"
+
+/*
+* https://github.com/rweather/arduinolibs
+*
+* Requires library CryptoLW from repository.
+*/
+#include <Ascon128.h>
+
+/// <summary>
+/// Software reference backend, portable to any target.
+/// Xoodyak (Cryptographic Hash function) for MAC and KDF.
+///		Creative Commons Attribution 4.0 International License.
+///		32 byte (256 bit) bit digest.
+/// Ascon128 cypher.
+/// Linked MACs are keyed by absorbing the MAC key and then the directional address key.
+/// </summary>
+struct XoodyakCryptoBackend
+{
+	using Hasher = XoodyakHashWrapper<LoLaPacketDefinition::MAC_SIZE>;
+	using Cypher = Ascon128;
+
+	static constexpr LoLaCryptoDefinition::MacType MAC_TYPE = LoLaCryptoDefinition::MacType::Xoodyak;
+	static constexpr uint8_t MAC_KEY_SIZE = Hasher::KEY_SIZE;
+	static constexpr bool AEAD = false;
+};
+#endif
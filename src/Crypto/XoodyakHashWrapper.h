@@ -6,7 +6,7 @@
 /*
 * https://github.com/rweather/lightweight-crypto
 */
-#include "lightweight-crypto\xoodyak.h"
+#include "lightweight-crypto/xoodyak.h"
 #include <stdint.h>
 
 template<const uint8_t MacSize>
@@ -15,6 +15,16 @@ class XoodyakHashWrapper final
 public:
 	static constexpr uint8_t DIGEST_LENGTH = XOODYAK_HASH_SIZE;
 
+	/// <summary>
+	/// Linked MAC key, one hash block.
+	/// </summary>
+	static constexpr uint8_t KEY_SIZE = 16;
+
+	/// <summary>
+	/// Hasher state, with a prefix already absorbed.
+	/// </summary>
+	using PrefixState = xoodyak_hash_state_t;
+
 private:
 	static constexpr uint8_t MATCH_MIN_SIZE = sizeof(uint32_t);
 
@@ -61,6 +71,39 @@ public:
 		xoodyak_hash_absorb(&State, source, size);
 	}
 
+	/// <summary>
+	/// Saves the current state, to restore for every message with the same prefix.
+	/// The whole hash state is copied, so a restored message hashes the same as prefix|message.
+	/// </summary>
+	/// <param name="target">Prefix state to save to.</param>
+	void savePrefix(PrefixState& target)
+	{
+		target = State;
+	}
+
+	/// <summary>
+	/// Starts a message from a saved prefix, instead of reset.
+	/// </summary>
+	/// <param name="source">Prefix state, from savePrefix.</param>
+	void restorePrefix(const PrefixState& source)
+	{
+		State = source;
+	}
+
+	/// <summary>
+	/// Linked MAC prefix, keyed by absorbing the MAC key and then the directional address key.
+	/// </summary>
+	/// <param name="target">Prefix state to save to.</param>
+	/// <param name="macKey">sizeof KEY_SIZE.</param>
+	/// <param name="addressKey">sizeof LoLaCryptoDefinition::ADDRESS_KEY_SIZE.</param>
+	void saveMacPrefix(PrefixState& target, const uint8_t* macKey, const uint8_t* addressKey)
+	{
+		reset();
+		update(macKey, KEY_SIZE);
+		update(addressKey, LoLaCryptoDefinition::ADDRESS_KEY_SIZE);
+		savePrefix(target);
+	}
+
 	void clear()
 	{
 		State.s.count = 0;
@@ -76,6 +119,19 @@ public:
 		xoodyak_hash_squeeze(&State, target, size);
 	}
 
+	/// <summary>
+	/// The nonce is absorbed with the message, there's no finalize nonce.
+	/// </summary>
+	void finalize(const uint8_t* nonce, uint8_t* target, const uint8_t size)
+	{
+		finalize(target, size);
+	}
+
+	const bool macMatches(const uint8_t* nonce, const uint8_t* source)
+	{
+		return macMatches(source);
+	}
+
 	const bool macMatches(const uint8_t* source)
 	{
 		xoodyak_hash_squeeze(&State, Match, MacSize);
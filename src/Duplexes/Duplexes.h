@@ -19,6 +19,11 @@ public:
 		return true;
 	}
 
+	virtual const uint32_t GetTimeToRange(const uint32_t timestamp, const uint16_t duration) final
+	{
+		return 0;
+	}
+
 	virtual const uint16_t GetRange() final
 	{
 		return throttlePeriodMicros;
@@ -77,6 +82,26 @@ public:
 			&& (duration <= (DuplexEnd - startRemainder));
 	}
 
+	virtual const uint32_t GetTimeToRange(const uint32_t timestamp, const uint16_t duration) final
+	{
+		const uint_fast16_t startRemainder = timestamp % DuplexPeriodMicros;
+
+		if (startRemainder < DuplexStart)
+		{
+			return DuplexStart - startRemainder;
+		}
+		else if (duration <= (DuplexEnd - DuplexStart)
+			&& startRemainder <= (DuplexEnd - duration))
+		{
+			return 0;
+		}
+		else
+		{
+			// Next slot start.
+			return ((uint32_t)DuplexPeriodMicros - startRemainder) + DuplexStart;
+		}
+	}
+
 	virtual const uint16_t GetRange() final
 	{
 		return (uint16_t)(DuplexEnd - DuplexStart);
@@ -185,6 +210,25 @@ public:
 			&& endRemainder < (End - DeadZoneMicros);
 	}
 
+	virtual const uint32_t GetTimeToRange(const uint32_t timestamp, const uint16_t duration) final
+	{
+		const uint_fast16_t startRemainder = timestamp % DuplexPeriodMicros;
+
+		if (startRemainder < (Start + DeadZoneMicros))
+		{
+			return (Start + DeadZoneMicros) - startRemainder;
+		}
+		else if (IsInRange(timestamp, duration))
+		{
+			return 0;
+		}
+		else
+		{
+			// Next slot start.
+			return ((uint32_t)DuplexPeriodMicros - startRemainder) + Start + DeadZoneMicros;
+		}
+	}
+
 private:
 	uint_fast16_t Start = 0;
 	uint_fast16_t End = DuplexPeriodMicros / Slots;
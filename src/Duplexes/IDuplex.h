@@ -18,6 +18,13 @@ public:
 	/// <returns>True when the duplex is in transmission range, for the given start and duration.</returns>
 	virtual const bool IsInRange(const uint32_t timestamp, const uint16_t duration) { return false; }
 
+	/// <summary>
+	/// </summary>
+	/// <param name="timestamp"></param>
+	/// <param name="duration"></param>
+	/// <returns>Microseconds from timestamp until the duplex is in transmission range for the given duration, 0 if in range now.</returns>
+	virtual const uint32_t GetTimeToRange(const uint32_t timestamp, const uint16_t duration) { return 0; }
+
 	/// <summary>
 	/// </summary>
 	/// <returns>Usable range in microseconds.</returns>
@@ -3,221 +3,287 @@
 #ifndef _LOLA_CRYPTO_PKE_SESSION_h
 #define _LOLA_CRYPTO_PKE_SESSION_h
 
-#include "LoLaCryptoEncoderSession.h"
+#include "../Crypto/LoLaCryptoEncoderSession.h"
 
 /*
 * https://github.com/kmackay/micro-ecc
 */
 #include <uECC.h>
+#include "SlicedEcdh.h"
 
 /// <summary>
-/// Public Key Exchange session based on uECC_secp160r1.
+/// Public Key Exchange (PKE) session based on uECC_secp160r1, access password and key pair.
+/// Public addresses are hashed from each partner's public key,
+///  the ECDH shared secret takes the place of the AM secret key.
+/// Runs a single step per Calculate call, so the caller can yield between steps.
+/// The shared secret is computed in bounded slices and kept for the same partner key,
+///  so re-linking with the same partner only derives the session keys.
+/// Requires micro-ecc with uECC_ENABLE_VLI_API=1.
 /// </summary>
-class LoLaCryptoPkeSession final : public LoLaCryptoEncoderSession
+/// <typeparam name="CryptoBackend">Hasher and cypher policy, see LoLaCryptoBackend.h.</typeparam>
+template<typename CryptoBackend = LoLaCryptoDefaultBackend>
+class LoLaCryptoPkeSession final : public LoLaCryptoEncoderSession<CryptoBackend>
 {
+private:
+	using BaseClass = LoLaCryptoEncoderSession<CryptoBackend>;
+
+	using BaseClass::CryptoHasher;
+	using BaseClass::LocalAddress;
+	using BaseClass::SecretKey;
+	using BaseClass::SecretKeySize;
+	using BaseClass::AccessPassword;
+	using BaseClass::HKDFSize;
+	using BaseClass::SetPartnerAddress;
+	using BaseClass::ClearPartnerAddress;
+	using BaseClass::StartExpandedKey;
+	using BaseClass::CalculateExpandedKeyBlock;
+	using BaseClass::FinishExpandedKey;
+	using BaseClass::CalculateInputKey;
+	using BaseClass::CalculateOutputKey;
+	using BaseClass::CalculateSessionPrefixes;
+
 private:
 	enum class PkeEnum
 	{
+		NoPartner,
+		DecompressingPartnerKey,
+		StartingSecret,
 		CalculatingSecret,
 		CalculatingExpandedKey,
-		CalculatingAddressing,
-		CalculatingLinkingToken,
-		CalculatingSessionToken,
+		CalculatingInputKey,
+		CalculatingOutputKey,
+		CalculatingPrefixes,
 		PkeCached
 	};
 
-	//_______________Public Key Exchange LINK________________
-	//// 
-	///// <summary>
-	///// Abstract struct.
-	///// ||SessionId|CompressedPublicKey||
-	///// </summary>
-	//template<const uint8_t Header>
-	//struct PkeDefinition : public TemplateHeaderDefinition<Header, LoLaLinkDefinition::SESSION_ID_SIZE + LoLaCryptoDefinition::COMPRESSED_KEY_SIZE>
-	//{
-	//	static constexpr uint8_t PAYLOAD_SESSION_ID_INDEX = HeaderDefinition::SUB_PAYLOAD_INDEX;
-	//	static constexpr uint8_t PAYLOAD_PUBLIC_KEY_INDEX = PAYLOAD_SESSION_ID_INDEX + LoLaLinkDefinition::SESSION_ID_SIZE;
-	//}; 
-	///// <summary>
-	///// ||||
-	///// Request server to start a PKE session.
-	///// TODO: Add support for search for specific Device Id.
-	///// </summary>
-	//using PkeSessionRequest = TemplateHeaderDefinition<AmLinkingStartRequest::HEADER + 1, 0>;
-
-	///// <summary>
-	///// ||SessionId|CompressedServerPublicKey||
-	///// </summary>
-	//using PkeSessionAvailable = PkeDefinition<PkeSessionRequest::HEADER + 1>;
-
-	///// <summary>
-	///// ||SessionId|CompressedClientPublicKey||
-	///// </summary>
-	//using PkeLinkingStartRequest = PkeDefinition<AmLinkingStartRequest::HEADER + 1>;
-	////_______________________________________________________
-
-
-	static constexpr uint8_t MATCHING_TOKEN_SIZE = 4;
-
-	////////// Public Key Exchange
-	/// <summary>
-	/// Elliptic-curve DiffieHellman public key exchange.
-	/// SECP 160 R1
-	/// </summary>
-	static constexpr uint8_t PKE_CURVE_SIZE = 160;
+private:
+	uECC_Curve ECC_CURVE; // uECC_secp160r1
 
 	/// <summary>
-	/// Public key, uncompressed.
+	/// secp160r1 takes 41 steps of 4 bits, each a fraction of the full uECC_shared_secret.
 	/// </summary>
-	static constexpr uint8_t PUBLIC_KEY_SIZE = SHARED_KEY_SIZE * 2;
+	SlicedEcdh<4> Ecdh{};
 
-	/// <summary>
-	/// Compressed Public key to be exchanged.
-	/// 161 bits take 21 bytes.
-	/// </summary>
-	static constexpr uint8_t COMPRESSED_KEY_SIZE = SHARED_KEY_SIZE + 1;
+private:
+	uint8_t PartnerCompressedKey[LoLaCryptoDefinition::COMPRESSED_KEY_SIZE]{};
+	uint8_t PartnerPublicKey[LoLaCryptoDefinition::PUBLIC_KEY_SIZE]{};
 
 	/// <summary>
-	/// Private key size.
-	/// 161 bits take 21 bytes.
+	/// ECDH shared secret, the session's secret key.
+	/// Only valid while SecretCached.
 	/// </summary>
-	static constexpr uint8_t PRIVATE_KEY_SIZE = COMPRESSED_KEY_SIZE;
+	uint8_t SharedKey[LoLaCryptoDefinition::SHARED_KEY_SIZE]{};
 
 	/// <summary>
-	/// Shared secret key size in bytes.
+	/// Local public address, hashed from the local public key.
 	/// </summary>
-	static constexpr uint8_t SHARED_KEY_SIZE = PKE_CURVE_SIZE / 8;
+	uint8_t PublicAddress[LoLaLinkDefinition::PUBLIC_ADDRESS_SIZE]{};
 
 private:
-	const uECC_Curve_t* ECC_CURVE; // uECC_secp160r1
+	const uint8_t* LocalPublicKey = nullptr;
+	const uint8_t* LocalPrivateKey = nullptr;
+
+	PkeEnum PkeState = PkeEnum::NoPartner;
 
-private:
 	/// <summary>
-	/// Ephemeral session matching token.
-	/// Only valid if PkeState == PkeCached.
+	/// Expanded key byte index, for the next block.
 	/// </summary>
-	uint8_t CachedToken[MATCHING_TOKEN_SIZE]{};
-
-	PkeEnum PkeState = PkeEnum::CalculatingSecret;
-
-private:
-	uint8_t PartnerPublicKey[PUBLIC_KEY_SIZE]{};
+	uint8_t KeyIndex = 0;
 
 	/// <summary>
-	/// Shared secret key.
+	/// SharedKey is valid for PartnerCompressedKey.
 	/// </summary>
-	uint8_t SecretKey[SHARED_KEY_SIZE]{};
+	bool SecretCached = false;
 
-private:
-	const uint8_t* LocalPublicKey = nullptr;
-	const uint8_t* LocalPrivateKey = nullptr;
+public:
+	LoLaCryptoPkeSession() : BaseClass()
+		, ECC_CURVE(uECC_secp160r1())
+	{}
 
 public:
 	/// <summary>
+	/// Sets the local key pair, in place of the AM address and secret key.
 	/// </summary>
-	/// <param name="expandedKey">sizeof = LoLaLinkDefinition::HKDFSize</param>
 	/// <param name="accessPassword">sizeof = LoLaLinkDefinition::ACCESS_CONTROL_PASSWORD_SIZE</param>
 	/// <param name="publicKey">sizeof = LoLaCryptoDefinition::PUBLIC_KEY_SIZE</param>
-	/// <param name="privateKey">size of = LoLaCryptoDefinition::PRIVATE_KEY_SIZE</param>
-	LoLaCryptoPkeSession(const uint8_t accessPassword[ACCESS_CONTROL_PASSWORD_SIZE],
-		const uint8_t publicKey[PUBLIC_KEY_SIZE],
-		const uint8_t privateKey[PRIVATE_KEY_SIZE])
-		: LoLaCryptoEncoderSession(accessPassword)
-		, ECC_CURVE(uECC_secp160r1())
-		, LocalPublicKey(publicKey)
-		, LocalPrivateKey(privateKey)
+	/// <param name="privateKey">sizeof = LoLaCryptoDefinition::PRIVATE_KEY_SIZE</param>
+	/// <returns>False if any key is missing or the public key isn't on the curve.</returns>
+	const bool SetKeys(const uint8_t accessPassword[LoLaLinkDefinition::ACCESS_CONTROL_PASSWORD_SIZE],
+		const uint8_t publicKey[LoLaCryptoDefinition::PUBLIC_KEY_SIZE],
+		const uint8_t privateKey[LoLaCryptoDefinition::PRIVATE_KEY_SIZE])
 	{
-		uECC_set_rng(0);
+		if (accessPassword == nullptr
+			|| publicKey == nullptr
+			|| privateKey == nullptr
+			|| !uECC_valid_public_key(publicKey, ECC_CURVE))
+		{
+			return false;
+		}
+
+		ResetPke();
+		SecretCached = false;
+
+		LocalPublicKey = publicKey;
+		LocalPrivateKey = privateKey;
+		GetAddressFromPublicKey(LocalPublicKey, PublicAddress);
+
+		LocalAddress = PublicAddress;
+		AccessPassword = accessPassword;
+		SecretKey = SharedKey;
+		SecretKeySize = LoLaCryptoDefinition::SHARED_KEY_SIZE;
+
+		return true;
 	}
 
-public:
-	const bool SessionIsCached()
+	const bool HasPartner()
 	{
-		return PkeState == PkeEnum::PkeCached && SessionTokenMatches(PartnerPublicKey);
+		return PkeState != PkeEnum::NoPartner;
 	}
 
-protected:
-	virtual const LoLaLinkDefinition::LinkType GetLinkType() final
+	const bool Ready()
 	{
-		return LoLaLinkDefinition::LinkType::PublicKeyExchange;
+		return PkeState == PkeEnum::PkeCached;
 	}
 
-public:
-	virtual const bool Setup() final
+	/// <summary>
+	/// Drops the partner, keeps the shared secret cached.
+	/// </summary>
+	void ResetPke()
 	{
-		return LoLaCryptoEncoderSession::Setup() &&
-			LocalPublicKey != nullptr
-			&& LocalPrivateKey != nullptr;
+		Ecdh.Clear();
+		PkeState = PkeEnum::NoPartner;
+		ClearPartnerAddress();
 	}
 
-	virtual void SetSessionId(const uint8_t* sessionId)
+	/// <summary>
+	/// Starts the session with the partner's compressed public key.
+	/// Assumes SessionId and ProtocolId have been set.
+	/// </summary>
+	/// <param name="compressedPublicKey">sizeof = LoLaCryptoDefinition::COMPRESSED_KEY_SIZE</param>
+	void SetPartnerPublicKeyFrom(const uint8_t* compressedPublicKey)
 	{
-		LoLaCryptoEncoderSession::SetSessionId(sessionId);
-		for (uint_fast8_t i = 0; i < MATCHING_TOKEN_SIZE; i++)
+		if (LocalPublicKey == nullptr)
 		{
-			CachedToken[i] = 0;
+			return;
 		}
-	}
 
-	virtual void SetRandomSessionId(LoLaRandom* randomSource) final
-	{
-		LoLaCryptoEncoderSession::SetRandomSessionId(randomSource);
-		for (uint_fast8_t i = 0; i < MATCHING_TOKEN_SIZE; i++)
+		if (memcmp(PartnerCompressedKey, compressedPublicKey, LoLaCryptoDefinition::COMPRESSED_KEY_SIZE) != 0)
 		{
-			CachedToken[i] = 0;
+			SecretCached = false;
+			memcpy(PartnerCompressedKey, compressedPublicKey, LoLaCryptoDefinition::COMPRESSED_KEY_SIZE);
 		}
-	}
 
-	void ResetPke()
-	{
-		PkeState = PkeEnum::CalculatingSecret;
+		Ecdh.Clear();
+		PkeState = PkeEnum::DecompressingPartnerKey;
 	}
 
 	/// <summary>
 	/// Long operations, cannot be done in line with linking protocol.
+	/// Runs a single step per call, so the caller can yield between steps.
+	/// An invalid or colliding partner key drops the partner, see HasPartner.
 	/// </summary>
-	/// <returns></returns>
-	const bool CalculatePke()
+	void Calculate()
 	{
+		if (LocalPublicKey == nullptr)
+		{
+			return;
+		}
+
 		switch (PkeState)
 		{
+		case PkeEnum::NoPartner:
+			break;
+		case PkeEnum::DecompressingPartnerKey:
+			if (!SecretCached)
+			{
+				uECC_decompress(PartnerCompressedKey, PartnerPublicKey, ECC_CURVE);
+				if (!uECC_valid_public_key(PartnerPublicKey, ECC_CURVE)
+					|| PublicKeyCollision())
+				{
+#if defined(DEBUG_LOLA)
+					Serial.println(F("PKE partner key rejected."));
+#endif
+					ResetPke();
+					break;
+				}
+			}
+			SetPartnerAddressFromPublicKey();
+			KeyIndex = 0;
+			if (SecretCached)
+			{
+				PkeState = PkeEnum::CalculatingExpandedKey;
+			}
+			else
+			{
+				PkeState = PkeEnum::StartingSecret;
+			}
+			break;
+		case PkeEnum::StartingSecret:
+			Ecdh.Start(PartnerPublicKey, LocalPrivateKey, ECC_CURVE);
+			PkeState = PkeEnum::CalculatingSecret;
+			break;
 		case PkeEnum::CalculatingSecret:
-			uECC_shared_secret(PartnerPublicKey, LocalPrivateKey, SecretKey, ECC_CURVE);
-			PkeState = PkeEnum::CalculatingExpandedKey;
+			if (Ecdh.Step())
+			{
+				SecretCached = Ecdh.GetSecret(SharedKey);
+				if (SecretCached)
+				{
+					PkeState = PkeEnum::CalculatingExpandedKey;
+				}
+				else
+				{
+					ResetPke();
+				}
+			}
 			break;
 		case PkeEnum::CalculatingExpandedKey:
-			CalculateExpandedKey(SecretKey, SHARED_KEY_SIZE);
-			PkeState = PkeEnum::CalculatingAddressing;
+			if (KeyIndex == 0)
+			{
+				StartExpandedKey();
+			}
+			KeyIndex = CalculateExpandedKeyBlock(KeyIndex);
+			if (KeyIndex >= HKDFSize)
+			{
+				FinishExpandedKey();
+				PkeState = PkeEnum::CalculatingInputKey;
+			}
 			break;
-		case PkeEnum::CalculatingAddressing:
-			CalculateSessionAddressing(
-				LocalPublicKey,
-				PartnerPublicKey,
-				PUBLIC_KEY_SIZE);
-			PkeState = PkeEnum::CalculatingLinkingToken;
+		case PkeEnum::CalculatingInputKey:
+			CalculateInputKey();
+			PkeState = PkeEnum::CalculatingOutputKey;
 			break;
-		case PkeEnum::CalculatingLinkingToken:
-			CalculateLinkingToken(LocalPublicKey,
-				PartnerPublicKey,
-				PUBLIC_KEY_SIZE);
-			PkeState = PkeEnum::CalculatingSessionToken;
+		case PkeEnum::CalculatingOutputKey:
+			CalculateOutputKey();
+			PkeState = PkeEnum::CalculatingPrefixes;
 			break;
-		case PkeEnum::CalculatingSessionToken:
-			CalculateSessionToken(PartnerPublicKey, CachedToken);
+		case PkeEnum::CalculatingPrefixes:
+			CalculateSessionPrefixes();
 			PkeState = PkeEnum::PkeCached;
 			break;
 		case PkeEnum::PkeCached:
-			return true;
 		default:
 			break;
 		}
+	}
+
+	/// <summary>
+	/// Fast operation.
+	/// </summary>
+	/// <param name="target">sizeof = LoLaCryptoDefinition::COMPRESSED_KEY_SIZE</param>
+	void CompressPublicKeyTo(uint8_t* target)
+	{
+		if (LocalPublicKey == nullptr)
+		{
+			return;
+		}
 
-		return false;
+		uECC_compress(LocalPublicKey, target, ECC_CURVE);
 	}
 
+private:
 	const bool PublicKeyCollision()
 	{
-		for (uint_fast8_t i = 0; i < PUBLIC_KEY_SIZE; i++)
+		for (uint_fast8_t i = 0; i < LoLaCryptoDefinition::PUBLIC_KEY_SIZE; i++)
 		{
 			if (LocalPublicKey[i] != PartnerPublicKey[i])
 			{
@@ -227,73 +293,20 @@ public:
 		return true;
 	}
 
-	/// <summary>
-	/// Slow operation, can take a few ms, take care.
-	/// </summary>
-	/// <param name="compressedPublicKey"></param>
-	void DecompressPartnerPublicKeyFrom(const uint8_t* compressedPublicKey)
-	{
-		uECC_decompress(compressedPublicKey, PartnerPublicKey, ECC_CURVE);
-	}
-
-	/// <summary>
-	/// Fast operation.
-	/// </summary>
-	/// <param name="target"></param>
-	void CompressPublicKeyTo(uint8_t* target)
-	{
-		uECC_compress(LocalPublicKey, target, ECC_CURVE);
-	}
-
-private:
-	/// <summary>
-	/// Generates a unique id for this session id and partner.
-	/// Assumes SessionId has been set.
-	/// </summary>
-	/// <param name="partnerPublicKey"></param>
-	/// <param name="token"></param>
-	void CalculateSessionToken(const uint8_t* partnerPublicKey, uint8_t* token)
+	void GetAddressFromPublicKey(const uint8_t* publicKey, uint8_t* address)
 	{
-#if defined(LOLA_USE_POLY1305)
-		ClearNonce();
-		CryptoHasher.reset(Nonce);
-#else
 		CryptoHasher.reset();
-#endif
-		CryptoHasher.update(SessionId, SESSION_ID_SIZE);
-		CryptoHasher.update(partnerPublicKey, PUBLIC_KEY_SIZE);
-#if defined(LOLA_USE_POLY1305)
-		CryptoHasher.finalize(Nonce, token, MATCHING_TOKEN_SIZE);
-#else
-		CryptoHasher.finalize(token, MATCHING_TOKEN_SIZE);
-#endif
+		CryptoHasher.update(publicKey, LoLaCryptoDefinition::PUBLIC_KEY_SIZE);
+		CryptoHasher.finalize(address, LoLaLinkDefinition::PUBLIC_ADDRESS_SIZE);
 		CryptoHasher.clear();
 	}
 
-	/// <summary>
-	/// Assumes SessionId has been set.
-	/// </summary>
-	/// <param name="partnerPublicKey"></param>
-	/// <returns>True if the calculated secrets are already set for this SessionId and PublicKey</returns>
-	const bool SessionTokenMatches(const uint8_t* partnerPublicKey)
+	void SetPartnerAddressFromPublicKey()
 	{
-#if defined(LOLA_USE_POLY1305)
-		ClearNonce();
-		CryptoHasher.reset(Nonce);
-#else
-		CryptoHasher.reset();
-#endif
-		CryptoHasher.update(SessionId, SESSION_ID_SIZE);
-		CryptoHasher.update(partnerPublicKey, PUBLIC_KEY_SIZE);
-
-#if defined(LOLA_USE_POLY1305)
-		const bool match = CryptoHasher.macMatches(Nonce, CachedToken);
-#else
-		const bool match = CryptoHasher.macMatches(CachedToken);
-#endif
-		CryptoHasher.clear();
+		uint8_t partnerAddress[LoLaLinkDefinition::PUBLIC_ADDRESS_SIZE];
 
-		return match;
+		GetAddressFromPublicKey(PartnerPublicKey, partnerAddress);
+		SetPartnerAddress(partnerAddress);
 	}
 };
-#endif
\ No newline at end of file
+#endif
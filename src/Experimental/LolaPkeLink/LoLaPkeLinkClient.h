@@ -3,42 +3,47 @@
 #ifndef _LOLA_PKE_LINK_CLIENT_
 #define _LOLA_PKE_LINK_CLIENT_
 
-#include "..\Abstract\AbstractLoLaLinkClient.h"
-
-#include "..\..\Crypto\LoLaCryptoPkeSession.h"
+#include "../../LoLaLinks/Abstract/AbstractLoLaLinkClient.h"
+#include "../LoLaCryptoPkeSession.h"
 
 /// <summary>
 /// LoLa Public-Key-Exchange Link Client.
 /// Template parameters allow specifying maxlisteners.
+/// Requires micro-ecc with uECC_ENABLE_VLI_API=1.
 /// </summary>
 /// <typeparam name="MaxPacketReceiveListeners"></typeparam>
 /// <typeparam name="MaxLinkListeners"></typeparam>
+/// <typeparam name="DirectDispatch">Constant-time packet dispatch, at the cost of a port table.</typeparam>
+/// <typeparam name="RegistryType">Override the listener registry, i.e. StaticLinkRegistry. Ignores the above parameters.</typeparam>
+/// <typeparam name="CryptoBackend">Hasher and cypher policy for the session, see LoLaCryptoBackend.h.</typeparam>
 template<const uint8_t MaxPacketReceiveListeners = 10,
-	const uint8_t MaxLinkListeners = 10>
-class LoLaPkeLinkClient : public AbstractLoLaLinkClient
+	const uint8_t MaxLinkListeners = 10,
+	const bool DirectDispatch = false,
+	typename RegistryType = LinkRegistry<MaxPacketReceiveListeners, MaxLinkListeners, DirectDispatch>,
+	typename CryptoBackend = LoLaCryptoDefaultBackend>
+class LoLaPkeLinkClient : public AbstractLoLaLinkClient<LoLaCryptoPkeSession<CryptoBackend>>
 {
 private:
-	using BaseClass = AbstractLoLaLinkClient;
+	using BaseClass = AbstractLoLaLinkClient<LoLaCryptoPkeSession<CryptoBackend>>;
 
-	enum class PkeStateEnum : uint8_t
-	{
-		RequestingSession,
-		DecompressingPartnerKey,
-		ValidatingSession,
-		ComputingSecretKey,
-		SessionCached
-	};
+public:
+	using BaseClass::SendPacket;
 
-private:
-	uint8_t PublicCompressedKey[LoLaCryptoDefinition::COMPRESSED_KEY_SIZE]{};
-	uint8_t PartnerCompressedKey[LoLaCryptoDefinition::COMPRESSED_KEY_SIZE]{};
+protected:
+	using BaseClass::IsResumable;
+	using BaseClass::LinkStage;
+	using LinkStageEnum = typename BaseClass::LinkStageEnum;
+	using BaseClass::OnLinkSyncReceived;
+	using BaseClass::OutPacket;
+	using BaseClass::PacketService;
+	using BaseClass::Session;
+	using BaseClass::UnlinkedDuplexCanSend;
+	using BaseClass::UnlinkedPacketThrottle;
 
 private:
-	LinkRegistry<MaxPacketReceiveListeners, MaxLinkListeners> RegistryInstance{};
+	RegistryType RegistryInstance{};
 
-	LoLaCryptoPkeSession Session;
-
-	PkeStateEnum PkeState = PkeStateEnum::RequestingSession;
+	uint8_t PublicCompressedKey[LoLaCryptoDefinition::COMPRESSED_KEY_SIZE]{};
 
 public:
 	LoLaPkeLinkClient(TS::Scheduler& scheduler,
@@ -46,17 +51,24 @@ public:
 		ICycles* cycles,
 		IEntropy* entropy,
 		IDuplex* duplex,
-		IChannelHop* hop,
-		const uint8_t* accessPassword,
-		const uint8_t* publicKey,
-		const uint8_t* privateKey)
-		: BaseClass(scheduler, &RegistryInstance, &Session, transceiver, cycles, entropy, duplex, hop)
-		, Session(accessPassword, publicKey, privateKey)
+		IChannelHop* hop)
+		: BaseClass(scheduler, &RegistryInstance, transceiver, cycles, entropy, duplex, hop)
 	{}
 
-	const bool Setup()
+	/// <summary>
+	/// For registries that bind their services directly, i.e. StaticLinkRegistry::Attach.
+	/// </summary>
+	RegistryType& GetRegistry()
 	{
-		if (Session.Setup())
+		return RegistryInstance;
+	}
+
+	const bool Setup(const uint8_t accessPassword[LoLaLinkDefinition::ACCESS_CONTROL_PASSWORD_SIZE],
+		const uint8_t publicKey[LoLaCryptoDefinition::PUBLIC_KEY_SIZE],
+		const uint8_t privateKey[LoLaCryptoDefinition::PRIVATE_KEY_SIZE])
+	{
+		if (Session.Setup()
+			&& Session.SetKeys(accessPassword, publicKey, privateKey))
 		{
 			Session.CompressPublicKeyTo(PublicCompressedKey);
 
@@ -73,41 +85,100 @@ public:
 	}
 
 protected:
-	virtual void OnUnlinkedPacketReceived(const uint32_t timestamp, const uint8_t* payload, const uint16_t rollingCounter, const uint8_t payloadSize) final
+	void OnServicePairing() final
+	{
+		if (Session.Ready())
+		{
+			if (UnlinkedPacketThrottle())
+			{
+				OutPacket.SetPort(LoLaLinkDefinition::LINK_PORT);
+				OutPacket.SetHeader(Unlinked::PkeLinkingStartRequest::HEADER);
+				Session.CopySessionIdTo(&OutPacket.Payload[Unlinked::PkeLinkingStartRequest::PAYLOAD_SESSION_ID_INDEX]);
+				for (uint_fast8_t i = 0; i < LoLaCryptoDefinition::COMPRESSED_KEY_SIZE; i++)
+				{
+					OutPacket.Payload[Unlinked::PkeLinkingStartRequest::PAYLOAD_PUBLIC_KEY_INDEX + i] = PublicCompressedKey[i];
+				}
+
+				LOLA_RTOS_PAUSE();
+				if (UnlinkedDuplexCanSend(Unlinked::PkeLinkingStartRequest::PAYLOAD_SIZE) &&
+					PacketService.CanSendPacket())
+				{
+					if (SendPacket(OutPacket.Data, Unlinked::PkeLinkingStartRequest::PAYLOAD_SIZE))
+					{
+#if defined(DEBUG_LOLA_LINK)
+						this->Owner();
+						Serial.println(F("Sent PkeLinkingStartRequest"));
+#endif
+					}
+				}
+				LOLA_RTOS_RESUME();
+			}
+		}
+		else if (Session.HasPartner())
+		{
+			Session.Calculate();
+		}
+		else if (UnlinkedPacketThrottle())
+		{
+			LOLA_RTOS_PAUSE();
+			if (UnlinkedDuplexCanSend(Unlinked::PkeSessionRequest::PAYLOAD_SIZE)
+				&& PacketService.CanSendPacket())
+			{
+				OutPacket.SetPort(LoLaLinkDefinition::LINK_PORT);
+				OutPacket.SetHeader(Unlinked::PkeSessionRequest::HEADER);
+				if (SendPacket(OutPacket.Data, Unlinked::PkeSessionRequest::PAYLOAD_SIZE))
+				{
+#if defined(DEBUG_LOLA_LINK)
+					this->Owner();
+					Serial.println(F("Sent PkeSessionRequest"));
+#endif
+				}
+			}
+			LOLA_RTOS_RESUME();
+		}
+		TS::Task::enableDelayed(0);
+	}
+
+	void OnUnlinkedPacketReceived(const uint32_t timestamp, const uint8_t* payload, const uint16_t rollingCounter, const uint8_t payloadSize) final
 	{
 		switch (payload[HeaderDefinition::HEADER_INDEX])
 		{
 		case Unlinked::PkeSessionAvailable::HEADER:
-			if (payloadSize == Unlinked::PkeSessionAvailable::PAYLOAD_SIZE
-				&& IsInSessionCreation())
+			if (payloadSize == Unlinked::PkeSessionAvailable::PAYLOAD_SIZE)
 			{
-				switch (PkeState)
+				switch (LinkStage)
 				{
-				case PkeStateEnum::RequestingSession:;
-					PkeState = PkeStateEnum::DecompressingPartnerKey;
-					Session.SetSessionId(&payload[Unlinked::PkeSessionAvailable::PAYLOAD_SESSION_ID_INDEX]);
-					OnLinkSyncReceived(timestamp);
-					ResetUnlinkedPacketThrottle();
-
-					for (uint_fast8_t i = 0; i < LoLaCryptoDefinition::COMPRESSED_KEY_SIZE; i++)
+				case LinkStageEnum::Pairing:
+					// A repeated reply for the same session doesn't restart the key exchange.
+					if (Session.HasPartner()
+						&& Session.SessionIdMatches(&payload[Unlinked::PkeSessionAvailable::PAYLOAD_SESSION_ID_INDEX]))
 					{
-						PartnerCompressedKey[i] = payload[Unlinked::PkeSessionAvailable::PAYLOAD_PUBLIC_KEY_INDEX + i];
+#if defined(DEBUG_LOLA_LINK)
+						this->Skipped(F("PkeSessionAvailable repeated"));
+#endif
+						return;
 					}
-					TS::Task::enable();
+
+					// Partner key is validated in the first Calculate step.
+					Session.ResetPke();
+					Session.SetSessionId(&payload[Unlinked::PkeSessionAvailable::PAYLOAD_SESSION_ID_INDEX]);
+					Session.SetPartnerPublicKeyFrom(&payload[Unlinked::PkeSessionAvailable::PAYLOAD_PUBLIC_KEY_INDEX]);
 #if defined(DEBUG_LOLA_LINK)
 					this->Owner();
 					Serial.println(F("Found a PKE Session."));
 #endif
+					OnLinkSyncReceived(timestamp);
+					TS::Task::enableDelayed(0);
 					break;
 				default:
-#if defined(DEBUG_LOLA_LINK)
-					this->Skipped(F("SessionAvailable"));
-#endif
+					return;
 					break;
 				}
 			}
 #if defined(DEBUG_LOLA_LINK)
-			else { this->Skipped(F("SessionAvailable")); }
+			else {
+				this->Skipped(F("PkeSessionAvailable"));
+			}
 #endif
 			break;
 		default:
@@ -116,108 +187,24 @@ protected:
 		}
 	}
 
-protected:
-	virtual void ResetSessionCreation() final
+	void UpdateLinkStage(const LinkStageEnum linkStage) final
 	{
-		PkeState = PkeStateEnum::RequestingSession;
-		ResetUnlinkedPacketThrottle();
-		TS::Task::enable();
-	}
+		BaseClass::UpdateLinkStage(linkStage);
 
-	virtual void OnServiceSessionCreation() final
-	{
-		switch (PkeState)
+		switch (linkStage)
 		{
-		case PkeStateEnum::RequestingSession:
-			// Wait longer because reply is big.
-			if (UnlinkedPacketThrottle())
-			{
-				LOLA_RTOS_PAUSE();
-				if (PacketService.CanSendPacket())
-				{
-					OutPacket.SetPort(LoLaLinkDefinition::LINK_PORT);
-					OutPacket.SetHeader(Unlinked::PkeSessionRequest::HEADER);
-					if (SendPacket(OutPacket.Data, Unlinked::PkeSessionRequest::PAYLOAD_SIZE))
-					{
-#if defined(DEBUG_LOLA_LINK)
-						this->Owner();
-						Serial.println(F("Sent Session Start Request."));
-#endif
-					}
-				}
-				LOLA_RTOS_RESUME();
-			}
-			TS::Task::enable();
-			break;
-		case PkeStateEnum::DecompressingPartnerKey:
-			PkeState = PkeStateEnum::ValidatingSession;
-			Session.DecompressPartnerPublicKeyFrom(PartnerCompressedKey);
-			TS::Task::enable();
-			break;
-		case PkeStateEnum::ValidatingSession:
-			if (Session.PublicKeyCollision())
-			{
-#if defined(DEBUG_LOLA_LINK)
-				this->Owner();
-				Serial.println(F("Local and Partner public keys match, link is impossible."));
-#endif
-				PkeState = PkeStateEnum::RequestingSession;
-			}
-			else if (Session.SessionIsCached())
-			{
-#if defined(DEBUG_LOLA_LINK)
-				this->Owner();
-				Serial.println(F("Session token is cached, Linking."));
-#endif
-				PkeState = PkeStateEnum::SessionCached;
-			}
-			else
+		case LinkStageEnum::Searching:
+			if (!IsResumable())
 			{
-#if defined(DEBUG_LOLA_LINK)
-				this->Owner();
-				Serial.println(F("Session token needs refreshing."));
-#endif
 				Session.ResetPke();
-				PkeState = PkeStateEnum::ComputingSecretKey;
 			}
-			TS::Task::enable();
 			break;
-		case PkeStateEnum::ComputingSecretKey:
-			if (Session.CalculatePke())
-			{
-				// PKE calculation took a lot of time, let's reset to start now with a cached key-pair.
-				PkeState = PkeStateEnum::ValidatingSession;
-			}
-			TS::Task::enable();
+		case LinkStageEnum::Pairing:
+			Session.ResetPke();
 			break;
-		case PkeStateEnum::SessionCached:
-			if (UnlinkedPacketThrottle())
-			{
-				OutPacket.SetPort(LoLaLinkDefinition::LINK_PORT);
-				OutPacket.SetHeader(Unlinked::PkeLinkingStartRequest::HEADER);
-				for (uint_fast8_t i = 0; i < LoLaCryptoDefinition::COMPRESSED_KEY_SIZE; i++)
-				{
-					OutPacket.Payload[Unlinked::PkeLinkingStartRequest::PAYLOAD_PUBLIC_KEY_INDEX + i] = PublicCompressedKey[i];
-				}
-				Session.CopySessionIdTo(&OutPacket.Payload[Unlinked::PkeLinkingStartRequest::PAYLOAD_SESSION_ID_INDEX]);
-
-				LOLA_RTOS_PAUSE();
-				if (UnlinkedDuplexCanSend(Unlinked::PkeLinkingStartRequest::PAYLOAD_SIZE) &&
-					PacketService.CanSendPacket())
-				{
-					if (SendPacket(OutPacket.Data, Unlinked::PkeLinkingStartRequest::PAYLOAD_SIZE))
-					{
-#if defined(DEBUG_LOLA_LINK)
-						this->Owner();
-						Serial.println(F("Sent Linking Start Request."));
-#endif
-					}
-				}
-				LOLA_RTOS_RESUME();
-			}
-			TS::Task::enable();
+		default:
 			break;
 		}
 	}
 };
-#endif
\ No newline at end of file
+#endif
@@ -3,49 +3,47 @@
 #ifndef _LOLA_PKE_LINK_SERVER_
 #define _LOLA_PKE_LINK_SERVER_
 
-#include "..\Abstract\AbstractLoLaLinkServer.h"
-
-#include "..\..\Crypto\LoLaCryptoPkeSession.h"
+#include "../../LoLaLinks/Abstract/AbstractLoLaLinkServer.h"
+#include "../LoLaCryptoPkeSession.h"
 
 /// <summary>
 /// LoLa Public-Key-Exchange Link Server.
 /// Template parameters allow specifying maxlisteners.
+/// Requires micro-ecc with uECC_ENABLE_VLI_API=1.
 /// </summary>
 /// <typeparam name="MaxPacketReceiveListeners"></typeparam>
 /// <typeparam name="MaxLinkListeners"></typeparam>
+/// <typeparam name="DirectDispatch">Constant-time packet dispatch, at the cost of a port table.</typeparam>
+/// <typeparam name="RegistryType">Override the listener registry, i.e. StaticLinkRegistry. Ignores the above parameters.</typeparam>
+/// <typeparam name="CryptoBackend">Hasher and cypher policy for the session, see LoLaCryptoBackend.h.</typeparam>
 template<const uint8_t MaxPacketReceiveListeners = 10,
-	const uint8_t MaxLinkListeners = 10>
-class LoLaPkeLinkServer : public AbstractLoLaLinkServer
+	const uint8_t MaxLinkListeners = 10,
+	const bool DirectDispatch = false,
+	typename RegistryType = LinkRegistry<MaxPacketReceiveListeners, MaxLinkListeners, DirectDispatch>,
+	typename CryptoBackend = LoLaCryptoDefaultBackend>
+class LoLaPkeLinkServer : public AbstractLoLaLinkServer<LoLaCryptoPkeSession<CryptoBackend>>
 {
 private:
-	using BaseClass = AbstractLoLaLinkServer;
+	using BaseClass = AbstractLoLaLinkServer<LoLaCryptoPkeSession<CryptoBackend>>;
 
 public:
-	static constexpr uint32_t SERVER_SLEEP_TIMEOUT_MILLIS = 10000;
-
-private:
-	enum class PkeStateEnum : uint8_t
-	{
-		NoPke,
-		DecompressingPartnerKey,
-		ValidatingSession,
-		ComputingSecretKey,
-		SessionCached
-	};
+	using BaseClass::SendPacket;
 
-private:
-	uint8_t PublicCompressedKey[LoLaCryptoDefinition::COMPRESSED_KEY_SIZE]{};
-	uint8_t PartnerCompressedKey[LoLaCryptoDefinition::COMPRESSED_KEY_SIZE]{};
+protected:
+	using BaseClass::IsResumable;
+	using BaseClass::LinkStage;
+	using LinkStageEnum = typename BaseClass::LinkStageEnum;
+	using BaseClass::OutPacket;
+	using BaseClass::PacketService;
+	using BaseClass::Session;
+	using BaseClass::UnlinkedDuplexCanSend;
 
 private:
-	LinkRegistry<MaxPacketReceiveListeners, MaxLinkListeners> RegistryInstance{};
+	RegistryType RegistryInstance{};
 
-	LoLaCryptoPkeSession Session;
-
-	PkeStateEnum PkeState = PkeStateEnum::NoPke;
-
-	bool PkeSessionRequested = false;
+	uint8_t PublicCompressedKey[LoLaCryptoDefinition::COMPRESSED_KEY_SIZE]{};
 
+	bool PkeReplyPending = false;
 
 public:
 	LoLaPkeLinkServer(TS::Scheduler& scheduler,
@@ -53,17 +51,24 @@ public:
 		ICycles* cycles,
 		IEntropy* entropy,
 		IDuplex* duplex,
-		IChannelHop* hop,
-		const uint8_t* accessPassword,
-		const uint8_t* publicKey,
-		const uint8_t* privateKey)
-		: BaseClass(scheduler, &RegistryInstance, &Session, transceiver, cycles, entropy, duplex, hop)
-		, Session(accessPassword, publicKey, privateKey)
+		IChannelHop* hop)
+		: BaseClass(scheduler, &RegistryInstance, transceiver, cycles, entropy, duplex, hop)
 	{}
 
-	const bool Setup()
+	/// <summary>
+	/// For registries that bind their services directly, i.e. StaticLinkRegistry::Attach.
+	/// </summary>
+	RegistryType& GetRegistry()
+	{
+		return RegistryInstance;
+	}
+
+	const bool Setup(const uint8_t accessPassword[LoLaLinkDefinition::ACCESS_CONTROL_PASSWORD_SIZE],
+		const uint8_t publicKey[LoLaCryptoDefinition::PUBLIC_KEY_SIZE],
+		const uint8_t privateKey[LoLaCryptoDefinition::PRIVATE_KEY_SIZE])
 	{
-		if (Session.Setup())
+		if (Session.Setup()
+			&& Session.SetKeys(accessPassword, publicKey, privateKey))
 		{
 			Session.CompressPublicKeyTo(PublicCompressedKey);
 
@@ -80,100 +85,95 @@ public:
 	}
 
 protected:
-	virtual void OnUnlinkedPacketReceived(const uint32_t timestamp, const uint8_t* payload, const uint16_t rollingCounter, const uint8_t payloadSize) final
+	void OnServicePairing() final
 	{
-		switch (payload[HeaderDefinition::HEADER_INDEX])
+		if (Session.Ready())
 		{
-		case Unlinked::PkeSessionRequest::HEADER:
-			if (payloadSize == Unlinked::PkeSessionRequest::PAYLOAD_SIZE)
+			UpdateLinkStage(LinkStageEnum::SwitchingToLinking);
+		}
+		else if (Session.HasPartner())
+		{
+			Session.Calculate();
+		}
+		else if (PkeReplyPending)
+		{
+			OutPacket.SetPort(LoLaLinkDefinition::LINK_PORT);
+			OutPacket.SetHeader(Unlinked::PkeSessionAvailable::HEADER);
+			Session.CopySessionIdTo(&OutPacket.Payload[Unlinked::PkeSessionAvailable::PAYLOAD_SESSION_ID_INDEX]);
+			for (uint_fast8_t i = 0; i < LoLaCryptoDefinition::COMPRESSED_KEY_SIZE; i++)
 			{
-				if (IsInSearchingLink())
+				OutPacket.Payload[Unlinked::PkeSessionAvailable::PAYLOAD_PUBLIC_KEY_INDEX + i] = PublicCompressedKey[i];
+			}
+
+			LOLA_RTOS_PAUSE();
+			if (UnlinkedDuplexCanSend(Unlinked::PkeSessionAvailable::PAYLOAD_SIZE) &&
+				PacketService.CanSendPacket())
+			{
+				PkeReplyPending = false;
+				if (SendPacket(OutPacket.Data, Unlinked::PkeSessionAvailable::PAYLOAD_SIZE))
 				{
-					PkeSessionRequested = true;
-					TS::Task::enable();
 #if defined(DEBUG_LOLA_LINK)
 					this->Owner();
-					Serial.println(F("Session request received."));
+					Serial.println(F("Sent PkeSessionAvailable"));
 #endif
 				}
-				else if (IsInSessionCreation())
+			}
+			LOLA_RTOS_RESUME();
+		}
+
+		TS::Task::enableDelayed(0);
+	}
+
+	void OnUnlinkedPacketReceived(const uint32_t timestamp, const uint8_t* payload, const uint16_t rollingCounter, const uint8_t payloadSize) final
+	{
+		switch (payload[HeaderDefinition::HEADER_INDEX])
+		{
+		case Unlinked::PkeSessionRequest::HEADER:
+			if (payloadSize == Unlinked::PkeSessionRequest::PAYLOAD_SIZE
+				&& (!Session.HasPartner() || LinkStage == LinkStageEnum::Searching))
+			{
+				switch (LinkStage)
 				{
-					if (PkeState == PkeStateEnum::SessionCached)
-					{
-						Session.ResetPke();
-						PkeState = PkeStateEnum::NoPke;
-						StartSearching();
-						PkeSessionRequested = true;
-						TS::Task::enable();
+				case LinkStageEnum::Searching:
+					Session.ResetPke();
+					UpdateLinkStage(LinkStageEnum::Pairing);
+				case LinkStageEnum::Pairing:
+					PkeReplyPending = true;
+					TS::Task::enableDelayed(0);
 #if defined(DEBUG_LOLA_LINK)
-						this->Owner();
-						Serial.println(F("Session request overrode state back to search."));
+					this->Owner();
+					Serial.println(F("PkeSessionRequest received."));
 #endif
-					}
+					break;
+				default:
 #if defined(DEBUG_LOLA_LINK)
-					else
-					{
-						this->Skipped(F("SessionRequest1"));
-						return;
-					}
+					this->Skipped(F("PkeSessionRequest2"));
 #endif
-				}
-#if defined(DEBUG_LOLA_LINK)
-				else
-				{
-
-					this->Skipped(F("SessionRequest2"));
 					return;
+					break;
 				}
-#endif
 			}
 #if defined(DEBUG_LOLA_LINK)
-			else {
-				this->Skipped(F("SessionRequest3"));
-			}
+			else { this->Skipped(F("PkeSessionRequest")); }
 #endif
 			break;
 		case Unlinked::PkeLinkingStartRequest::HEADER:
 			if (payloadSize == Unlinked::PkeLinkingStartRequest::PAYLOAD_SIZE
+				&& LinkStage == LinkStageEnum::Pairing
+				&& !Session.HasPartner()
 				&& Session.SessionIdMatches(&payload[Unlinked::PkeLinkingStartRequest::PAYLOAD_SESSION_ID_INDEX]))
 			{
-				if (IsInSearchingLink())
-				{
-					StartSessionCreationIfNot();
-					TS::Task::enable();
-				}
-				else if (IsInSessionCreation())
-				{
-					switch (PkeState)
-					{
-					case PkeStateEnum::NoPke:
-					case PkeStateEnum::SessionCached:
-						TS::Task::enable();
-						break;
-					default:
-#if defined(DEBUG_LOLA_LINK)
-						this->Skipped(F("LinkingStartRequest1"));
-#endif
-						return;
-					}
-				}
-				else
-				{
 #if defined(DEBUG_LOLA_LINK)
-					this->Skipped(F("LinkingStartRequest2"));
+				this->Owner();
+				Serial.println(F("PkeLinkingStartRequest received"));
 #endif
-					return;
-				}
-
-				for (uint_fast8_t i = 0; i < LoLaCryptoDefinition::COMPRESSED_KEY_SIZE; i++)
-				{
-					PartnerCompressedKey[i] = payload[Unlinked::PkeLinkingStartRequest::PAYLOAD_PUBLIC_KEY_INDEX + i];
-				}
-				PkeState = PkeStateEnum::DecompressingPartnerKey;
+				// Partner key is validated in the first Calculate step.
+				Session.SetPartnerPublicKeyFrom(&payload[Unlinked::PkeLinkingStartRequest::PAYLOAD_PUBLIC_KEY_INDEX]);
+				TS::Task::enableDelayed(0);
 			}
 #if defined(DEBUG_LOLA_LINK)
 			else {
-				this->Skipped(F("LinkingStartRequest3"));
+				this->Skipped(F("PkeLinkingStartRequest"));
 			}
 #endif
 			break;
@@ -183,97 +183,24 @@ protected:
 		}
 	}
 
-protected:
-	virtual void ResetSessionCreation() final
+	void UpdateLinkStage(const LinkStageEnum linkStage) final
 	{
-		PkeState = PkeStateEnum::NoPke;
-		Session.ResetPke();
-	}
+		BaseClass::UpdateLinkStage(linkStage);
 
-	virtual void OnServiceSearchingLink()
-	{
-		if (PkeSessionRequested)
+		switch (linkStage)
 		{
-			OutPacket.SetPort(LoLaLinkDefinition::LINK_PORT);
-			OutPacket.SetHeader(Unlinked::PkeSessionAvailable::HEADER);
-			for (uint_fast8_t i = 0; i < LoLaCryptoDefinition::COMPRESSED_KEY_SIZE; i++)
-			{
-				OutPacket.Payload[Unlinked::PkeSessionAvailable::PAYLOAD_PUBLIC_KEY_INDEX + i] = PublicCompressedKey[i];
-			}
-			Session.CopySessionIdTo(&OutPacket.Payload[Unlinked::PkeSessionAvailable::PAYLOAD_SESSION_ID_INDEX]);
-
-			if (UnlinkedDuplexCanSend(Unlinked::PkeSessionAvailable::PAYLOAD_SIZE))
+		case LinkStageEnum::Searching:
+			if (!IsResumable())
 			{
-				LOLA_RTOS_PAUSE();
-				if (PacketService.CanSendPacket())
-				{
-					PkeSessionRequested = false;
-					if (SendPacket(OutPacket.Data, Unlinked::PkeSessionAvailable::PAYLOAD_SIZE))
-					{
-#if defined(DEBUG_LOLA_LINK)
-						this->Owner();
-						Serial.println(F("Sent PKE Session."));
-#endif
-					}
-				}
-				LOLA_RTOS_RESUME();
-			}
-		}
-		TS::Task::enable();
-	}
-
-	virtual void OnServiceSessionCreation() final
-	{
-		switch (PkeState)
-		{
-		case PkeStateEnum::NoPke:
-		case PkeStateEnum::SessionCached:
-			TS::Task::enable();
-			break;
-		case PkeStateEnum::DecompressingPartnerKey:
-			Session.DecompressPartnerPublicKeyFrom(PartnerCompressedKey);
-			PkeState = PkeStateEnum::ValidatingSession;
-			TS::Task::enable();
-			break;
-		case PkeStateEnum::ValidatingSession:
-			if (Session.PublicKeyCollision())
-			{
-#if defined(DEBUG_LOLA_LINK)
-				this->Owner();
-				Serial.println(F("Local and Partner public keys match, link is impossible."));
-#endif
-				PkeState = PkeStateEnum::NoPke;
-			}
-			else if (Session.SessionIsCached())
-			{
-#if defined(DEBUG_LOLA_LINK)
-				this->Owner();
-				Serial.println(F("Session secrets are cached, let's start linking."));
-#endif
-				StartSwitchToLinking();
-			}
-			else
-			{
-#if defined(DEBUG_LOLA_LINK)
-				this->Owner();
-				Serial.println(F("Session secrets invalidated, caching..."));
-#endif
 				Session.ResetPke();
-				PkeState = PkeStateEnum::ComputingSecretKey;
 			}
-			TS::Task::enable();
 			break;
-		case PkeStateEnum::ComputingSecretKey:
-			if (Session.CalculatePke())
-			{
-				// PKE calculation took a lot of time, let's wait for another start request, now with cached secrets.
-				PkeState = PkeStateEnum::SessionCached;
-			}
-			TS::Task::enable();
+		case LinkStageEnum::Pairing:
+			Session.ResetPke();
 			break;
 		default:
 			break;
 		}
 	}
 };
-#endif
\ No newline at end of file
+#endif
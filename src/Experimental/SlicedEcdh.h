@@ -0,0 +1,347 @@
+// SlicedEcdh.h
+
+#ifndef _SLICED_ECDH_h
+#define _SLICED_ECDH_h
+
+/*
+* https://github.com/kmackay/micro-ecc
+* Requires uECC_ENABLE_VLI_API=1.
+*/
+#include <uECC.h>
+#include <uECC_vli.h>
+
+#if !uECC_ENABLE_VLI_API
+#error "SlicedEcdh requires uECC_ENABLE_VLI_API=1."
+#endif
+
+/// <summary>
+/// ECDH shared secret, computed in bounded steps.
+/// Same co-Z Montgomery ladder as uECC_shared_secret, with the scalar loop unrolled over Step calls,
+///  so the scheduler can run between steps.
+/// Only for curves with a = -3 (secp160r1, secp192r1, secp224r1, secp256r1).
+/// No random initial Z, same as uECC_shared_secret without an RNG set.
+/// </summary>
+/// <typeparam name="BitsPerStep">Scalar bits per Step call. Each bit is one co-Z conjugate addition and one co-Z addition.</typeparam>
+template<const uint8_t BitsPerStep = 4>
+class SlicedEcdh
+{
+private:
+	static_assert(BitsPerStep > 0, "BitsPerStep must be at least 1.");
+
+	/// <summary>
+	/// Largest supported curve, 256 bits.
+	/// </summary>
+	static constexpr uint8_t MAX_WORDS = 32 / sizeof(uECC_word_t);
+
+	static constexpr uint8_t WORD_BITS = sizeof(uECC_word_t) * 8;
+
+	enum class StateEnum : uint8_t
+	{
+		Idle,
+		Ladder,
+		Finishing,
+		Done
+	};
+
+private:
+	uECC_Curve Curve = nullptr;
+
+	uECC_word_t Point[MAX_WORDS * 2]{};
+	uECC_word_t Scalar[MAX_WORDS + 1]{};
+	uECC_word_t Rx[2][MAX_WORDS]{};
+	uECC_word_t Ry[2][MAX_WORDS]{};
+	uECC_word_t Z[MAX_WORDS]{};
+
+	bitcount_t Bit = 0;
+
+	wordcount_t NumWords = 0;
+
+	StateEnum State = StateEnum::Idle;
+
+public:
+	SlicedEcdh() {}
+
+	/// <summary>
+	/// Number of Step calls from Start until Done.
+	/// </summary>
+	static constexpr uint16_t GetStepCount(const uint16_t curveOrderBits)
+	{
+		return ((curveOrderBits - 1 + BitsPerStep - 1) / BitsPerStep) + 1;
+	}
+
+	const bool IsDone() const
+	{
+		return State == StateEnum::Done;
+	}
+
+	const bool IsBusy() const
+	{
+		return State == StateEnum::Ladder
+			|| State == StateEnum::Finishing;
+	}
+
+	/// <summary>
+	/// Drops any calculation in progress.
+	/// </summary>
+	void Clear()
+	{
+		State = StateEnum::Idle;
+		memset(Scalar, 0, sizeof(Scalar));
+		memset(Rx, 0, sizeof(Rx));
+		memset(Ry, 0, sizeof(Ry));
+		memset(Z, 0, sizeof(Z));
+	}
+
+	/// <summary>
+	/// Loads the keys and runs the initial point double.
+	/// </summary>
+	/// <param name="publicKey">Partner's uncompressed public key, sizeof 2 x uECC_curve_num_bytes.</param>
+	/// <param name="privateKey">Local private key, sizeof uECC_curve_num_n_bytes.</param>
+	/// <param name="curve">Curve with a = -3.</param>
+	void Start(const uint8_t* publicKey, const uint8_t* privateKey, uECC_Curve curve)
+	{
+		Clear();
+
+		Curve = curve;
+		NumWords = uECC_curve_num_words(curve);
+
+		const wordcount_t numNWords = uECC_curve_num_n_words(curve);
+		const bitcount_t numNBits = uECC_curve_num_n_bits(curve);
+		const uint8_t numBytes = uECC_curve_num_bytes(curve);
+
+		uECC_vli_bytesToNative(Point, publicKey, numBytes);
+		uECC_vli_bytesToNative(Point + NumWords, publicKey + numBytes, numBytes);
+
+		// Regularize the scalar bit count, so the ladder always runs the same steps.
+		uECC_word_t k1[MAX_WORDS + 1]{};
+		uECC_vli_bytesToNative(k1, privateKey, uECC_curve_num_n_bytes(curve));
+		const bool carry = uECC_vli_add(Scalar, k1, uECC_curve_n(curve), numNWords)
+			|| (numNBits < ((bitcount_t)numNWords * WORD_BITS)
+				&& uECC_vli_testBit(Scalar, numNBits));
+		if (!carry)
+		{
+			uECC_vli_add(k1, Scalar, uECC_curve_n(curve), numNWords);
+			uECC_vli_set(Scalar, k1, numNWords);
+		}
+		memset(k1, 0, sizeof(k1));
+
+		// R1 = 2P, R0 = P, sharing Z.
+		uECC_vli_set(Rx[1], Point, NumWords);
+		uECC_vli_set(Ry[1], Point + NumWords, NumWords);
+		uECC_vli_set(Rx[0], Rx[1], NumWords);
+		uECC_vli_set(Ry[0], Ry[1], NumWords);
+		uECC_vli_clear(Z, NumWords);
+		Z[0] = 1;
+		DoubleJacobian(Rx[1], Ry[1], Z);
+		ApplyZ(Rx[0], Ry[0], Z);
+
+		Bit = numNBits - 1;
+		State = StateEnum::Ladder;
+	}
+
+	/// <summary>
+	/// Runs up to BitsPerStep ladder bits, or the final inversion.
+	/// </summary>
+	/// <returns>True when the shared secret is ready.</returns>
+	const bool Step()
+	{
+		switch (State)
+		{
+		case StateEnum::Ladder:
+			for (uint_fast8_t i = 0; i < BitsPerStep && Bit > 0; i++)
+			{
+				const uint8_t nb = !uECC_vli_testBit(Scalar, Bit);
+				XYcZ_addC(Rx[1 - nb], Ry[1 - nb], Rx[nb], Ry[nb]);
+				XYcZ_add(Rx[nb], Ry[nb], Rx[1 - nb], Ry[1 - nb]);
+				Bit--;
+			}
+			if (Bit == 0)
+			{
+				State = StateEnum::Finishing;
+			}
+			break;
+		case StateEnum::Finishing:
+			Finish();
+			State = StateEnum::Done;
+			break;
+		case StateEnum::Done:
+			return true;
+		case StateEnum::Idle:
+		default:
+			break;
+		}
+
+		return State == StateEnum::Done;
+	}
+
+	/// <summary>
+	/// Copies the shared secret (x coordinate) and clears the working state.
+	/// </summary>
+	/// <param name="secret">sizeof uECC_curve_num_bytes.</param>
+	/// <returns>False if not done or the result is the point at infinity.</returns>
+	const bool GetSecret(uint8_t* secret)
+	{
+		if (State != StateEnum::Done)
+		{
+			return false;
+		}
+
+		const bool valid = !(uECC_vli_isZero(Rx[0], NumWords) && uECC_vli_isZero(Ry[0], NumWords));
+		uECC_vli_nativeToBytes(secret, uECC_curve_num_bytes(Curve), Rx[0]);
+		Clear();
+
+		return valid;
+	}
+
+private:
+	/// <summary>
+	/// Last scalar bit, then back to affine coordinates with a single inversion.
+	/// </summary>
+	void Finish()
+	{
+		const uECC_word_t* p = uECC_curve_p(Curve);
+		const uint8_t nb = !uECC_vli_testBit(Scalar, 0);
+
+		XYcZ_addC(Rx[1 - nb], Ry[1 - nb], Rx[nb], Ry[nb]);
+
+		// Final 1/Z.
+		uECC_vli_modSub(Z, Rx[1], Rx[0], p, NumWords);
+		uECC_vli_modMult_fast(Z, Z, Ry[1 - nb], Curve);
+		uECC_vli_modMult_fast(Z, Z, Point, Curve);
+		uECC_vli_modInv(Z, Z, p, NumWords);
+		uECC_vli_modMult_fast(Z, Z, Point + NumWords, Curve);
+		uECC_vli_modMult_fast(Z, Z, Rx[1 - nb], Curve);
+
+		XYcZ_add(Rx[nb], Ry[nb], Rx[1 - nb], Ry[1 - nb]);
+		ApplyZ(Rx[0], Ry[0], Z);
+	}
+
+	/// <summary>
+	/// (x, y) => (x * z^2, y * z^3)
+	/// </summary>
+	void ApplyZ(uECC_word_t* x, uECC_word_t* y, const uECC_word_t* z)
+	{
+		uECC_word_t t1[MAX_WORDS];
+
+		uECC_vli_modSquare_fast(t1, z, Curve);
+		uECC_vli_modMult_fast(x, x, t1, Curve);
+		uECC_vli_modMult_fast(t1, t1, z, Curve);
+		uECC_vli_modMult_fast(y, y, t1, Curve);
+	}
+
+	/// <summary>
+	/// Jacobian point double, for a = -3.
+	/// (x, y, z) => 2(x, y, z)
+	/// </summary>
+	void DoubleJacobian(uECC_word_t* x, uECC_word_t* y, uECC_word_t* z)
+	{
+		const uECC_word_t* p = uECC_curve_p(Curve);
+		uECC_word_t t4[MAX_WORDS];
+		uECC_word_t t5[MAX_WORDS];
+
+		if (uECC_vli_isZero(z, NumWords))
+		{
+			return;
+		}
+
+		uECC_vli_modSquare_fast(t4, y, Curve);
+		uECC_vli_modMult_fast(t5, x, t4, Curve);
+		uECC_vli_modSquare_fast(t4, t4, Curve);
+		uECC_vli_modMult_fast(y, y, z, Curve);
+		uECC_vli_modSquare_fast(z, z, Curve);
+
+		uECC_vli_modAdd(x, x, z, p, NumWords);
+		uECC_vli_modAdd(z, z, z, p, NumWords);
+		uECC_vli_modSub(z, x, z, p, NumWords);
+		uECC_vli_modMult_fast(x, x, z, Curve);
+
+		uECC_vli_modAdd(z, x, x, p, NumWords);
+		uECC_vli_modAdd(x, x, z, p, NumWords);
+		if (uECC_vli_testBit(x, 0))
+		{
+			const uECC_word_t carry = uECC_vli_add(x, x, p, NumWords);
+			uECC_vli_rshift1(x, NumWords);
+			x[NumWords - 1] |= carry << (WORD_BITS - 1);
+		}
+		else
+		{
+			uECC_vli_rshift1(x, NumWords);
+		}
+
+		uECC_vli_modSquare_fast(z, x, Curve);
+		uECC_vli_modSub(z, z, t5, p, NumWords);
+		uECC_vli_modSub(z, z, t5, p, NumWords);
+		uECC_vli_modSub(t5, t5, z, p, NumWords);
+		uECC_vli_modMult_fast(x, x, t5, Curve);
+		uECC_vli_modSub(t4, x, t4, p, NumWords);
+
+		uECC_vli_set(x, z, NumWords);
+		uECC_vli_set(z, y, NumWords);
+		uECC_vli_set(y, t4, NumWords);
+	}
+
+	/// <summary>
+	/// Co-Z addition.
+	/// P => P', Q => P + Q
+	/// </summary>
+	void XYcZ_add(uECC_word_t* x1, uECC_word_t* y1, uECC_word_t* x2, uECC_word_t* y2)
+	{
+		const uECC_word_t* p = uECC_curve_p(Curve);
+		uECC_word_t t5[MAX_WORDS];
+
+		uECC_vli_modSub(t5, x2, x1, p, NumWords);
+		uECC_vli_modSquare_fast(t5, t5, Curve);
+		uECC_vli_modMult_fast(x1, x1, t5, Curve);
+		uECC_vli_modMult_fast(x2, x2, t5, Curve);
+		uECC_vli_modSub(y2, y2, y1, p, NumWords);
+		uECC_vli_modSquare_fast(t5, y2, Curve);
+
+		uECC_vli_modSub(t5, t5, x1, p, NumWords);
+		uECC_vli_modSub(t5, t5, x2, p, NumWords);
+		uECC_vli_modSub(x2, x2, x1, p, NumWords);
+		uECC_vli_modMult_fast(y1, y1, x2, Curve);
+		uECC_vli_modSub(x2, x1, t5, p, NumWords);
+		uECC_vli_modMult_fast(y2, y2, x2, Curve);
+		uECC_vli_modSub(y2, y2, y1, p, NumWords);
+
+		uECC_vli_set(x2, t5, NumWords);
+	}
+
+	/// <summary>
+	/// Co-Z conjugate addition.
+	/// P => P - Q, Q => P + Q
+	/// </summary>
+	void XYcZ_addC(uECC_word_t* x1, uECC_word_t* y1, uECC_word_t* x2, uECC_word_t* y2)
+	{
+		const uECC_word_t* p = uECC_curve_p(Curve);
+		uECC_word_t t5[MAX_WORDS];
+		uECC_word_t t6[MAX_WORDS];
+		uECC_word_t t7[MAX_WORDS];
+
+		uECC_vli_modSub(t5, x2, x1, p, NumWords);
+		uECC_vli_modSquare_fast(t5, t5, Curve);
+		uECC_vli_modMult_fast(x1, x1, t5, Curve);
+		uECC_vli_modMult_fast(x2, x2, t5, Curve);
+		uECC_vli_modAdd(t5, y2, y1, p, NumWords);
+		uECC_vli_modSub(y2, y2, y1, p, NumWords);
+
+		uECC_vli_modSub(t6, x2, x1, p, NumWords);
+		uECC_vli_modMult_fast(y1, y1, t6, Curve);
+		uECC_vli_modAdd(t6, x1, x2, p, NumWords);
+		uECC_vli_modSquare_fast(x2, y2, Curve);
+		uECC_vli_modSub(x2, x2, t6, p, NumWords);
+
+		uECC_vli_modSub(t7, x1, x2, p, NumWords);
+		uECC_vli_modMult_fast(y2, y2, t7, Curve);
+		uECC_vli_modSub(y2, y2, y1, p, NumWords);
+
+		uECC_vli_modSquare_fast(t7, t5, Curve);
+		uECC_vli_modSub(t7, t7, t6, p, NumWords);
+		uECC_vli_modSub(t6, t7, x1, p, NumWords);
+		uECC_vli_modMult_fast(t6, t6, t5, Curve);
+		uECC_vli_modSub(y1, t6, y1, p, NumWords);
+
+		uECC_vli_set(x1, t7, NumWords);
+	}
+};
+#endif
@@ -5,20 +5,20 @@
 
 #include <LoLaDefinitions.h>
 
-#include "Link\ILoLaLink.h"
-#include "Link\LoLaLinkDefinition.h"
-#include "Link\LoLaPacketDefinition.h"
+#include "Link/ILoLaLink.h"
+#include "Link/LoLaLinkDefinition.h"
+#include "Link/LoLaPacketDefinition.h"
 
 /// Base Link Services for extension.
-#include "Services\Template\TemplateLinkService.h"
-#include "Services\Discovery\DiscoveryDefinitions.h"
-#include "Services\Discovery\AbstractDiscoveryService.h"
-#include "Services\Delivery\AbstractDeliveryService.h"
+#include "Services/Template/TemplateLinkService.h"
+#include "Services/Discovery/DiscoveryDefinitions.h"
+#include "Services/Discovery/AbstractDiscoveryService.h"
+#include "Services/Delivery/AbstractDeliveryService.h"
 ///
 
 /// Ready-to-use Link Services
 #include <ISurfaceInclude.h>
-#include "Services\Surface\SurfaceReader.h"
-#include "Services\Surface\SurfaceWriter.h"
+#include "Services/Surface/SurfaceReader.h"
+#include "Services/Surface/SurfaceWriter.h"
 ///
 #endif
\ No newline at end of file
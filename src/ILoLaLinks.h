@@ -46,7 +46,7 @@
 
 
 /// Available Link Modules
-#include "LoLaLinks\LolaAddressMatchLink/LoLaAddressMatchLinkServer.h"
-#include "LoLaLinks\LolaAddressMatchLink/LoLaAddressMatchLinkClient.h"
+#include "LoLaLinks/LolaAddressMatchLink/LolaAddressMatchLinkServer.h"
+#include "LoLaLinks/LolaAddressMatchLink/LolaAddressMatchLinkClient.h"
 ///
 #endif
\ No newline at end of file
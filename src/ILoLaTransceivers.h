@@ -5,9 +5,12 @@
 
 /// Available Transceiver Drivers
 #include "LoLaTransceivers/VirtualTransceiver/VirtualTransceiver.h"
+#include "LoLaTransceivers/VirtualTransceiver/VirtualMedium.h"
+#if !defined(LOLA_HOST_PLATFORM)
 #include "LoLaTransceivers/UartTransceiver/UartTransceiver.h"
 #include "LoLaTransceivers/nRF24Transceiver/nRF24Transceiver.h"
 #include "LoLaTransceivers/Si446xTransceiver/Si446xTransceiver.h"
+#endif
 //#include "LoLaTransceivers\Sx12Transceiver\Sx12Transceiver.h"
 #if defined(ARDUINO_ARCH_ESP8266)
 #include "LoLaTransceivers/EspNowTransceiver/Esp8266NowTransceiver.h"
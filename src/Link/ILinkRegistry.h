@@ -39,15 +39,32 @@ public:
 	virtual void NotifyPacketListener(const uint32_t timestamp, const uint8_t* payload, const uint8_t payloadSize, const uint8_t port) { }
 };
 
+/// <summary>
+/// Fixed size listener registry.
+/// Packet dispatch scans the registered ports,
+///  or looks up a direct port-indexed table, at the cost of one byte per port.
+/// </summary>
+/// <typeparam name="MaxPacketListeners"></typeparam>
+/// <typeparam name="MaxLinkListeners"></typeparam>
+/// <typeparam name="DirectDispatch">Constant-time packet dispatch, for nodes with many services.</typeparam>
 template<const uint8_t MaxPacketListeners = 10,
-	const uint8_t MaxLinkListeners = 10>
+	const uint8_t MaxLinkListeners = 10,
+	const bool DirectDispatch = false>
 class LinkRegistry : public ILinkRegistry
 {
+private:
+	static constexpr uint16_t PORT_TABLE_SIZE = DirectDispatch ? (uint16_t)UINT8_MAX + 1 : 1;
+
 private:
 	ILinkPacketListener* PacketListeners[MaxPacketListeners]{};
 	ILinkListener* LinkListeners[MaxLinkListeners]{};
 	uint8_t PacketListenerPorts[MaxPacketListeners]{};
 
+	/// <summary>
+	/// Listener index + 1 for each port, 0 if not registered.
+	/// </summary>
+	uint8_t PortTable[PORT_TABLE_SIZE]{};
+
 	uint8_t PacketListenersCount = 0;
 	uint8_t LinkListenersCount = 0;
 
@@ -92,22 +109,23 @@ public:
 		if (listener != nullptr
 			&& (PacketListenersCount < MaxPacketListeners))
 		{
-			for (uint_fast8_t i = 0; i < PacketListenersCount; i++)
+			if (GetListenerIndex(port) < PacketListenersCount)
 			{
-				if (PacketListenerPorts[i] == port)
-				{
 #if defined(DEBUG_LOLA)
-					Serial.print(F("Port "));
-					Serial.print(port);
-					Serial.println(F(" already registered."));
+				Serial.print(F("Port "));
+				Serial.print(port);
+				Serial.println(F(" already registered."));
 #endif
-					return false;
-				}
+				return false;
 			}
 
 			PacketListeners[PacketListenersCount] = listener;
 			PacketListenerPorts[PacketListenersCount] = port;
 			PacketListenersCount++;
+			if (DirectDispatch)
+			{
+				PortTable[port] = PacketListenersCount;
+			}
 
 			return true;
 		}
@@ -127,19 +145,39 @@ public:
 
 	virtual void NotifyPacketListener(const uint32_t timestamp, const uint8_t* payload, const uint8_t payloadSize, const uint8_t port) final
 	{
+		const uint8_t index = GetListenerIndex(port);
+
+		if (index < PacketListenersCount)
+		{
+			PacketListeners[index]->OnPacketReceived(
+				timestamp,
+				payload,
+				payloadSize,
+				port);
+		}
+	}
+
+private:
+	/// <summary>
+	/// </summary>
+	/// <param name="port"></param>
+	/// <returns>Listener index, UINT8_MAX if port isn't registered.</returns>
+	const uint8_t GetListenerIndex(const uint8_t port) const
+	{
+		if (DirectDispatch)
+		{
+			return (uint8_t)(PortTable[port] - 1);
+		}
+
 		for (uint_fast8_t i = 0; i < PacketListenersCount; i++)
 		{
 			if (port == PacketListenerPorts[i])
 			{
-				PacketListeners[i]->OnPacketReceived(
-					timestamp,
-					payload,
-					payloadSize,
-					port);
-
-				break;
+				return i;
 			}
 		}
+
+		return UINT8_MAX;
 	}
 };
 #endif
\ No newline at end of file
@@ -30,6 +30,57 @@ public:
 	virtual void OnPacketReceived(const uint32_t timestamp, const uint8_t* payload, const uint8_t payloadSize, const uint8_t port) {}
 };
 
+/// <summary>
+/// Send request, queued on the link's transmit arbiter.
+/// Request fields are set by the requester before queueing,
+/// and must not be changed while queued.
+/// </summary>
+class ILinkSendRequest
+{
+public:
+	/// <summary>
+	/// Intrusive queue, owned by the arbiter while the request is queued.
+	/// </summary>
+	ILinkSendRequest* NextRequest = nullptr;
+
+	/// <summary>
+	/// micros() timestamp of the request.
+	/// </summary>
+	uint32_t SendStart = 0;
+
+	/// <summary>
+	/// Max wait in microseconds, after which the request is overdue and jumps the queue.
+	/// 0 for no deadline.
+	/// </summary>
+	uint32_t SendDeadline = 0;
+
+	/// <summary>
+	/// For reference values see RequestPriority.
+	/// </summary>
+	uint8_t SendPriority = 0;
+
+	uint8_t SendPayloadSize = 0;
+
+	/// <summary>
+	/// Service ports can be aggregated with other requests in the same packet. Link port is always sent alone.
+	/// </summary>
+	uint8_t SendPort = 0;
+
+public:
+	/// <summary>
+	/// The arbiter picked this request for the open slot.
+	/// Last chance to update payload right before transmission.
+	/// For zero-copy, the data can be written straight into the link's GetSendBuffer().
+	/// </summary>
+	/// <returns>Packet data (port and payload) to send.</returns>
+	virtual const uint8_t* OnSendGranted() { return nullptr; }
+
+	/// <summary>
+	/// The request was sent and removed from the arbiter.
+	/// </summary>
+	virtual void OnSendRequestDone() {}
+};
+
 class ILoLaLink
 {
 public:
@@ -84,13 +135,43 @@ public:
 	/// <returns>True if a Link time packet be sent now.</returns>
 	virtual const bool CanSendPacket(const uint8_t payloadSize) { return false; }
 
+	/// <summary>
+	/// How long until CanSendPacket() might be true, based on the duplex slot and transmitter state.
+	/// </summary>
+	/// <param name="payloadSize"></param>
+	/// <returns>Wait period in microseconds, 0 if a Link time packet might be sent now.</returns>
+	virtual const uint32_t GetSendWait(const uint8_t payloadSize) { return 0; }
+
 	/// <summary>
 	/// Send packet through link using transceiver.
+	/// If data is the link's GetSendBuffer(), the packet is encoded in place.
 	/// </summary>
+	/// <param name="data">Packet data (port and payload).</param>
 	/// <param name="payloadSize"></param>
 	/// <returns>True on successfull transmission.</returns>
 	virtual const bool SendPacket(const uint8_t* data, const uint8_t payloadSize) { return false; }
 
+	/// <summary>
+	/// Zero-copy send: borrow the link's raw out buffer, to write the packet data (port and payload) in place.
+	/// Only valid after a true CanSendPacket(), until the following SendPacket() with the same buffer.
+	/// </summary>
+	/// <returns>Packet data section, for up to LoLaPacketDefinition::MAX_PAYLOAD_SIZE of payload.</returns>
+	virtual uint8_t* GetSendBuffer() { return nullptr; }
+
+
+	/// <summary>
+	/// Queue a send request on the link's transmit arbiter.
+	/// The link picks the best pending request when the duplex slot opens.
+	/// </summary>
+	/// <param name="request"></param>
+	/// <returns>True if the request was queued.</returns>
+	virtual const bool RequestSend(ILinkSendRequest* request) { return false; }
+
+	/// <summary>
+	/// Remove a send request from the transmit arbiter, if queued.
+	/// </summary>
+	/// <param name="request"></param>
+	virtual void CancelSend(ILinkSendRequest* request) {}
 
 	/// <summary>
 	/// Register link status listener.
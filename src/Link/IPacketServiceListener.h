@@ -30,10 +30,11 @@ public:
 	/// <summary>
 	/// The Packet Service has a received packet ready to consume.
 	/// </summary>
+	/// <param name="data">Raw packet data, only valid during the call. Can be decoded in place.</param>
 	/// <param name="receiveTimestamp">micros() timestamp of packet start.</param>
-	/// <param name="data">Raw packet data is provided separately, to avoid a repeating field.</param>
 	/// <param name="packetSize"></param>
-	virtual void OnReceived(const uint32_t receiveTimestamp, const uint8_t packetSize, const uint8_t rssi) { }
+	/// <param name="rssi">Normalized RX RSSI [0:255].</param>
+	virtual void OnReceived(uint8_t* data, const uint32_t receiveTimestamp, const uint8_t packetSize, const uint8_t rssi) { }
 
 
 	/// <summary>
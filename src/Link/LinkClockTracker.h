@@ -6,7 +6,7 @@
 #include <stdint.h>
 #include "LoLaLinkDefinition.h"
 
-#include "Quality\QualityFilters.h"
+#include "Quality/QualityFilters.h"
 
 class LinkServerClockTracker
 {
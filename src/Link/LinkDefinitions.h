@@ -24,6 +24,16 @@ namespace LinkDefinitions
 		static constexpr uint8_t PAYLOAD_SERVER_ADDRESS_INDEX = PAYLOAD_SESSION_ID_INDEX + LoLaLinkDefinition::SESSION_ID_SIZE;
 	};
 
+	/// <summary>
+	/// ||SessionId|CompressedPublicKey||
+	/// </summary>
+	template<const uint8_t Header>
+	struct PkeBroadcastDefinition : public TemplateHeaderDefinition<Header, LoLaLinkDefinition::SESSION_ID_SIZE + LoLaCryptoDefinition::COMPRESSED_KEY_SIZE>
+	{
+		static constexpr uint8_t PAYLOAD_SESSION_ID_INDEX = HeaderDefinition::SUB_PAYLOAD_INDEX;
+		static constexpr uint8_t PAYLOAD_PUBLIC_KEY_INDEX = PAYLOAD_SESSION_ID_INDEX + LoLaLinkDefinition::SESSION_ID_SIZE;
+	};
+
 	/// <summary>
 	/// Abstract struct.
 	/// ||RequestId||
@@ -100,6 +110,33 @@ namespace LinkDefinitions
 		public:
 			static constexpr uint8_t PAYLOAD_SESSION_TOKEN_INDEX = BaseClass::PAYLOAD_REQUEST_ID_INDEX + 1;
 		};
+
+		/// <summary>
+		/// ||ResumeToken||
+		/// Client request to resume the lost linked session, without re-pairing.
+		/// </summary>
+		struct ResumeRequest : public TemplateHeaderDefinition<LinkingTimedSwitchOverAck::HEADER + 1, LoLaLinkDefinition::LINKING_TOKEN_SIZE>
+		{
+			static constexpr uint8_t PAYLOAD_TOKEN_INDEX = HeaderDefinition::SUB_PAYLOAD_INDEX;
+		};
+
+		//_____________Public Key Exchange LINK______________
+		/// <summary>
+		/// ||||
+		/// Request server to start a PKE session.
+		/// </summary>
+		using PkeSessionRequest = TemplateHeaderDefinition<ResumeRequest::HEADER + 1, 0>;
+
+		/// <summary>
+		/// ||SessionId|ServerCompressedPublicKey||
+		/// </summary>
+		using PkeSessionAvailable = PkeBroadcastDefinition<PkeSessionRequest::HEADER + 1>;
+
+		/// <summary>
+		/// ||SessionId|ClientCompressedPublicKey||
+		/// </summary>
+		using PkeLinkingStartRequest = PkeBroadcastDefinition<PkeSessionAvailable::HEADER + 1>;
+		//_______________________________________________________
 	};
 
 	struct Linking
@@ -226,6 +263,26 @@ namespace LinkDefinitions
 		{
 			static constexpr uint8_t PAYLOAD_ERROR_INDEX = HeaderDefinition::SUB_PAYLOAD_INDEX;
 		};
+
+		/// <summary>
+		/// Server's rekey contribution and the agreed switch over second.
+		/// ||SwitchSecond|ServerSeed||
+		/// </summary>
+		struct RekeyRequest : public TemplateHeaderDefinition<ClockTuneReply::HEADER + 1, sizeof(uint32_t) + LoLaCryptoDefinition::REKEY_SEED_SIZE>
+		{
+			static constexpr uint8_t PAYLOAD_SECOND_INDEX = HeaderDefinition::SUB_PAYLOAD_INDEX;
+			static constexpr uint8_t PAYLOAD_SEED_INDEX = PAYLOAD_SECOND_INDEX + sizeof(uint32_t);
+		};
+
+		/// <summary>
+		/// Client's rekey contribution, for the echoed switch over second.
+		/// ||SwitchSecond|ClientSeed||
+		/// </summary>
+		struct RekeyReply : public TemplateHeaderDefinition<RekeyRequest::HEADER + 1, sizeof(uint32_t) + LoLaCryptoDefinition::REKEY_SEED_SIZE>
+		{
+			static constexpr uint8_t PAYLOAD_SECOND_INDEX = HeaderDefinition::SUB_PAYLOAD_INDEX;
+			static constexpr uint8_t PAYLOAD_SEED_INDEX = PAYLOAD_SECOND_INDEX + sizeof(uint32_t);
+		};
 	};
 };
 #endif
\ No newline at end of file
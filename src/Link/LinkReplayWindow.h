@@ -0,0 +1,134 @@
+// LinkReplayWindow.h
+
+#ifndef _LINK_REPLAY_WINDOW_h
+#define _LINK_REPLAY_WINDOW_h
+
+#include <stdint.h>
+#include "LoLaLinkDefinition.h"
+
+/// <summary>
+/// Sliding window anti-replay, over the implicit receive counter.
+/// Link will tolerate some dropped packets by forwarding the rolling counter,
+///  and out of order packets within the window, each accepted only once.
+/// Skipped counters are only accounted as lost when they leave the window unreceived,
+///  so a late packet is never counted as both lost and received.
+/// </summary>
+class LinkReplayWindow
+{
+private:
+	static_assert(LoLaLinkDefinition::RX_REPLAY_WINDOW_SIZE > 0 && LoLaLinkDefinition::RX_REPLAY_WINDOW_SIZE <= 32, "Replay window must fit in 32 bits.");
+
+	static constexpr uint32_t REPLAY_WINDOW_MASK = UINT32_MAX >> (32 - LoLaLinkDefinition::RX_REPLAY_WINDOW_SIZE);
+
+private:
+	/// <summary>
+	/// Rolling packet counter, latest accepted, with implicit high bits.
+	/// </summary>
+	uint32_t ReceiveCounter = 0;
+
+	/// <summary>
+	/// Anti-replay bitmap, bit n is set if counter (ReceiveCounter - n) was received.
+	/// </summary>
+	uint32_t Window = 0;
+
+	/// <summary>
+	/// The first accepted encrypted packet sets the implicit counter reference.
+	/// </summary>
+	bool Anchored = false;
+
+public:
+	/// <summary>
+	/// The next accepted encrypted packet sets the implicit counter reference,
+	///  its high bits are zero. Partner's send counter must also restart below INT16_MAX.
+	/// </summary>
+	void Reset()
+	{
+		Anchored = false;
+	}
+
+	/// <summary>
+	/// Extends the packet id with the implicit high bits,
+	///  to the nearest counter from the latest accepted.
+	/// </summary>
+	/// <param name="id">Packet id, the counter's low 16 bits.</param>
+	/// <returns>Implicit counter.</returns>
+	const uint32_t GetReceivingCounter(const uint16_t id) const
+	{
+		if (!Anchored)
+		{
+			return id;
+		}
+
+		return ReceiveCounter + (int16_t)(id - (uint16_t)ReceiveCounter);
+	}
+
+	/// <summary>
+	/// </summary>
+	/// <param name="counter">Received counter, from GetReceivingCounter.</param>
+	/// <param name="receiveLost">Counters that left the window unreceived. 0 when invalid.</param>
+	/// <returns>True on valid counter.</returns>
+	const bool Validate(const uint32_t counter, uint16_t& receiveLost)
+	{
+		const uint32_t counterRoll = counter - ReceiveCounter;
+		receiveLost = 0;
+
+		if (!Anchored)
+		{
+			// First packet sets the reference, nothing before it is accepted.
+			Anchored = true;
+			ReceiveCounter = counter;
+			Window = REPLAY_WINDOW_MASK;
+
+			return true;
+		}
+
+		if (counterRoll < (uint16_t)INT16_MAX
+			&& counterRoll > 0)
+		{
+			// Counter ahead, slide window.
+			if (counterRoll >= LoLaLinkDefinition::RX_REPLAY_WINDOW_SIZE)
+			{
+				receiveLost = counterRoll - GetSetCount(Window);
+				Window = 1;
+			}
+			else
+			{
+				receiveLost = counterRoll - GetSetCount(Window >> (LoLaLinkDefinition::RX_REPLAY_WINDOW_SIZE - counterRoll));
+				Window = ((Window << counterRoll) | 1) & REPLAY_WINDOW_MASK;
+			}
+
+			// Counter accepted, update local tracker.
+			ReceiveCounter = counter;
+
+			return true;
+		}
+		else
+		{
+			// Counter behind, accept once if inside window.
+			const uint32_t counterAge = ReceiveCounter - counter;
+			if (counterAge < LoLaLinkDefinition::RX_REPLAY_WINDOW_SIZE
+				&& (Window & ((uint32_t)1 << counterAge)) == 0)
+			{
+				Window |= (uint32_t)1 << counterAge;
+
+				return true;
+			}
+
+			return false;
+		}
+	}
+
+private:
+	static const uint8_t GetSetCount(uint32_t bits)
+	{
+		uint8_t count = 0;
+		while (bits != 0)
+		{
+			bits &= bits - 1;
+			count++;
+		}
+
+		return count;
+	}
+};
+#endif
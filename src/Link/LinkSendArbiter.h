@@ -0,0 +1,456 @@
+// LinkSendArbiter.h
+
+#ifndef _LINK_SEND_ARBITER_h
+#define _LINK_SEND_ARBITER_h
+
+#define _TASK_OO_CALLBACKS
+#include <TSchedulerDeclarations.hpp>
+
+#include "ILoLaLink.h"
+#include "LoLaLinkDefinition.h"
+#include "../Clock/Time.h"
+
+/// <summary>
+/// Link-owned transmit arbiter.
+/// Services queue their send requests, and a single task picks the best candidate
+///  when the link can send, instead of every service polling the link.
+/// Candidates become eligible when their priority score is reached (based on link congestion),
+///  or immediately when overdue.
+/// Ranking: overdue first, then lowest priority value, then oldest request.
+/// Service requests eligible in the same pass are aggregated into one packet, if they fit.
+/// Between sends, the task sleeps until the next eligibility, deadline or duplex slot, instead of polling.
+/// </summary>
+class LinkSendArbiter : private TS::Task
+{
+private:
+	static constexpr uint16_t PRIORITY_NEGATIVE_SCALE = 275;
+	static constexpr uint8_t PRIORITY_POSITIVE_SCALE = 15;
+	static constexpr uint8_t PRIORITY_PERIOD_SCALE = 2;
+
+	/// <summary>
+	/// Every sub-frame has at least a 1 byte payload (header).
+	/// </summary>
+	static constexpr uint8_t AGGREGATE_MAX_COUNT = LoLaPacketDefinition::MAX_PAYLOAD_SIZE / (LoLaLinkDefinition::AGGREGATE_SUB_HEADER_SIZE + 1);
+
+private:
+	ILoLaLink* LoLaLink;
+
+	ILinkSendRequest* Requests = nullptr;
+
+	/// <summary>
+	/// Requests granted in the current pass.
+	/// </summary>
+	ILinkSendRequest* Batch[AGGREGATE_MAX_COUNT]{};
+	uint8_t BatchCount = 0;
+
+public:
+	LinkSendArbiter(TS::Scheduler& scheduler, ILoLaLink* loLaLink)
+		: TS::Task(TASK_IMMEDIATE, TASK_FOREVER, &scheduler, false)
+		, LoLaLink(loLaLink)
+	{}
+
+	/// <summary>
+	/// Queue request, if not already queued.
+	/// </summary>
+	/// <param name="request"></param>
+	/// <returns>True if the request is queued.</returns>
+	const bool Enqueue(ILinkSendRequest* request)
+	{
+		if (request == nullptr)
+		{
+			return false;
+		}
+
+		ILinkSendRequest** tail = &Requests;
+		while (*tail != nullptr)
+		{
+			if (*tail == request)
+			{
+				return true;
+			}
+			tail = &(*tail)->NextRequest;
+		}
+
+		request->NextRequest = nullptr;
+		*tail = request;
+
+		Wake();
+
+		return true;
+	}
+
+	/// <summary>
+	/// Remove request, if queued.
+	/// </summary>
+	/// <param name="request"></param>
+	void Cancel(ILinkSendRequest* request)
+	{
+		ILinkSendRequest** node = &Requests;
+		while (*node != nullptr)
+		{
+			if (*node == request)
+			{
+				*node = request->NextRequest;
+				request->NextRequest = nullptr;
+				return;
+			}
+			node = &(*node)->NextRequest;
+		}
+	}
+
+	/// <summary>
+	/// Resume arbitration, if any request is pending.
+	/// Cuts short any pending sleep, the new request may be eligible sooner.
+	/// </summary>
+	void Wake()
+	{
+		if (Requests != nullptr)
+		{
+			TS::Task::enable();
+		}
+	}
+
+	virtual bool Callback() final
+	{
+		if (Requests == nullptr
+			|| !LoLaLink->HasLink())
+		{
+			// Woken up by a new request or when link is acquired.
+			TS::Task::disable();
+			return false;
+		}
+
+		ILinkSendRequest* candidate = GetCandidate(false);
+
+		if (candidate == nullptr)
+		{
+			// Sleep until the first request becomes eligible.
+			return WaitFor(GetEligibleWait());
+		}
+
+		LOLA_RTOS_PAUSE();
+		if (!LoLaLink->CanSendPacket(candidate->SendPayloadSize))
+		{
+			LOLA_RTOS_RESUME();
+
+			// Sleep until the duplex slot opens or the transmitter is free.
+			return WaitFor(LoLaLink->GetSendWait(candidate->SendPayloadSize));
+		}
+
+		bool sent = false;
+
+		if (GetAggregate(candidate) > 0)
+		{
+			sent = SendAggregate();
+		}
+		else
+		{
+			// Send is available, last moment callback before transmission.
+			const uint8_t* data = candidate->OnSendGranted();
+
+			// Transmit packet.
+			sent = data != nullptr && LoLaLink->SendPacket(data, candidate->SendPayloadSize);
+		}
+		LOLA_RTOS_RESUME();
+
+		if (sent)
+		{
+			for (uint_fast8_t i = 0; i < BatchCount; i++)
+			{
+				Cancel(Batch[i]);
+				Batch[i]->OnSendRequestDone();
+			}
+		}
+		else
+		{
+			// Transmit failed on Transceiver, try again until time-out.
+#if defined(DEBUG_LOLA)
+			Serial.println(F("Tx Failed."));
+#endif
+		}
+
+		return true;
+	}
+
+private:
+	/// <summary>
+	/// Fills the batch with the candidate and the best eligible requests that fit in the same packet.
+	/// </summary>
+	/// <param name="candidate">Granted request.</param>
+	/// <returns>Aggregate payload size, 0 if the candidate is sent alone.</returns>
+	const uint8_t GetAggregate(ILinkSendRequest* candidate)
+	{
+		Batch[0] = candidate;
+		BatchCount = 1;
+
+		if (!IsAggregatable(candidate))
+		{
+			return 0;
+		}
+
+		uint8_t aggregateSize = LoLaLinkDefinition::AGGREGATE_SUB_HEADER_SIZE + candidate->SendPayloadSize;
+
+		while (BatchCount < AGGREGATE_MAX_COUNT)
+		{
+			ILinkSendRequest* next = GetCandidate(true);
+
+			if (next == nullptr)
+			{
+				break;
+			}
+
+			const uint16_t nextSize = (uint16_t)aggregateSize + LoLaLinkDefinition::AGGREGATE_SUB_HEADER_SIZE + next->SendPayloadSize;
+			if (nextSize > LoLaPacketDefinition::MAX_PAYLOAD_SIZE
+				|| !LoLaLink->CanSendPacket(nextSize))
+			{
+				// Ranking order is kept, the next request goes in the next packet.
+				break;
+			}
+
+			Batch[BatchCount++] = next;
+			aggregateSize = nextSize;
+		}
+
+		if (BatchCount > 1)
+		{
+			return aggregateSize;
+		}
+
+		return 0;
+	}
+
+	/// <summary>
+	/// Packs the batch's sub-frames straight into the link's send buffer, and sends it.
+	/// A request that declines its grant is dropped from the batch and stays queued, the rest is still sent.
+	/// </summary>
+	/// <returns>True if sent.</returns>
+	const bool SendAggregate()
+	{
+		static constexpr uint8_t PortIndex = (uint8_t)LoLaPacketDefinition::IndexEnum::Port - (uint8_t)LoLaPacketDefinition::IndexEnum::Data;
+		static constexpr uint8_t PayloadIndex = (uint8_t)LoLaPacketDefinition::IndexEnum::Payload - (uint8_t)LoLaPacketDefinition::IndexEnum::Data;
+
+		uint8_t* buffer = LoLaLink->GetSendBuffer();
+
+		if (buffer == nullptr)
+		{
+			return false;
+		}
+
+		buffer[PortIndex] = LoLaLinkDefinition::AGGREGATE_PORT;
+
+		uint8_t offset = PayloadIndex;
+		uint8_t granted = 0;
+		for (uint_fast8_t i = 0; i < BatchCount; i++)
+		{
+			// Last moment callback before transmission.
+			const uint8_t* data = Batch[i]->OnSendGranted();
+
+			if (data == nullptr)
+			{
+				continue;
+			}
+
+			const uint8_t payloadSize = Batch[i]->SendPayloadSize;
+			buffer[offset] = data[PortIndex];
+			buffer[offset + 1] = payloadSize;
+			memcpy(&buffer[offset + LoLaLinkDefinition::AGGREGATE_SUB_HEADER_SIZE], &data[PayloadIndex], payloadSize);
+			offset += LoLaLinkDefinition::AGGREGATE_SUB_HEADER_SIZE + payloadSize;
+
+			// Only granted requests are completed on send.
+			Batch[granted++] = Batch[i];
+		}
+		BatchCount = granted;
+
+		if (BatchCount == 0)
+		{
+			return false;
+		}
+
+		return LoLaLink->SendPacket(buffer, offset - PayloadIndex);
+	}
+
+	/// <summary>
+	/// Only service ports are aggregated, link packets depend on their own send timing.
+	/// </summary>
+	static const bool IsAggregatable(const ILinkSendRequest* request)
+	{
+		return request->SendPort <= LoLaLinkDefinition::MAX_DEFINITION_PORT;
+	}
+
+	const bool IsInBatch(const ILinkSendRequest* request) const
+	{
+		for (uint_fast8_t i = 0; i < BatchCount; i++)
+		{
+			if (Batch[i] == request)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/// <summary>
+	/// Best eligible request, if any.
+	/// </summary>
+	/// <param name="aggregating">Only aggregatable requests, not yet in the batch.</param>
+	ILinkSendRequest* GetCandidate(const bool aggregating)
+	{
+		const uint32_t timestamp = micros();
+		const uint32_t txElapsed = LoLaLink->GetSendElapsed();
+
+		ILinkSendRequest* best = nullptr;
+		uint32_t bestElapsed = 0;
+		bool bestOverdue = false;
+
+		for (ILinkSendRequest* request = Requests; request != nullptr; request = request->NextRequest)
+		{
+			if (aggregating
+				&& (!IsAggregatable(request) || IsInBatch(request)))
+			{
+				continue;
+			}
+
+			const uint32_t elapsed = timestamp - request->SendStart;
+			const bool overdue = request->SendDeadline > 0 && elapsed >= request->SendDeadline;
+
+			if (!overdue
+				&& GetPriorityScore(txElapsed, elapsed) < request->SendPriority)
+			{
+				continue;
+			}
+
+			if (best == nullptr
+				|| (overdue && !bestOverdue)
+				|| (overdue == bestOverdue
+					&& (request->SendPriority < best->SendPriority
+						|| (request->SendPriority == best->SendPriority && elapsed > bestElapsed))))
+			{
+				best = request;
+				bestElapsed = elapsed;
+				bestOverdue = overdue;
+			}
+		}
+
+		return best;
+	}
+
+	/// <summary>
+	/// Delays the next pass by the whole milliseconds of wait.
+	/// A sub-millisecond remainder is polled on the following passes, so the wake up is never late.
+	/// </summary>
+	/// <param name="waitMicros">Time until the next possible send, in microseconds.</param>
+	/// <returns>False if the task is delayed (idle).</returns>
+	const bool WaitFor(const uint32_t waitMicros)
+	{
+		if (waitMicros >= ONE_MILLI_MICROS)
+		{
+			TS::Task::delay(waitMicros / ONE_MILLI_MICROS);
+			return false;
+		}
+
+		return true;
+	}
+
+	/// <summary>
+	/// Earliest time a request becomes eligible, either by deadline or by priority score.
+	/// A send in the meantime resets the transmit elapsed, that only delays eligibility further.
+	/// </summary>
+	/// <returns>Wait period in microseconds.</returns>
+	const uint32_t GetEligibleWait()
+	{
+		const uint32_t timestamp = micros();
+		const uint32_t txElapsed = LoLaLink->GetSendElapsed();
+		const uint32_t priorityPeriod = LoLaLink->GetPacketThrottlePeriod() * PRIORITY_PERIOD_SCALE;
+		const uint32_t requestDivisor = (uint32_t)1 + (priorityPeriod / PRIORITY_NEGATIVE_SCALE);
+		const uint32_t txDivisor = (uint32_t)1 + (priorityPeriod / PRIORITY_POSITIVE_SCALE);
+
+		uint32_t wait = UINT32_MAX;
+
+		for (ILinkSendRequest* request = Requests; request != nullptr; request = request->NextRequest)
+		{
+			const uint32_t elapsed = timestamp - request->SendStart;
+
+			if (request->SendDeadline > 0)
+			{
+				if (elapsed >= request->SendDeadline)
+				{
+					return 0;
+				}
+				else if ((request->SendDeadline - elapsed) < wait)
+				{
+					wait = request->SendDeadline - elapsed;
+				}
+			}
+
+			// Score reaches priority no sooner than (elapsed + t) / requestDivisor + (txElapsed + t) / txDivisor >= priority.
+			// Both elapsed terms are bounded by a score below UINT8_MAX, so the products fit.
+			if (elapsed >= (UINT8_MAX * requestDivisor)
+				|| txElapsed >= (UINT8_MAX * txDivisor))
+			{
+				return 0;
+			}
+
+			const uint32_t target = (uint32_t)request->SendPriority * requestDivisor * txDivisor;
+			const uint32_t current = (elapsed * txDivisor) + (txElapsed * requestDivisor);
+			uint32_t scoreWait = 0;
+
+			if (target > current)
+			{
+				scoreWait = ((target - current) + requestDivisor + txDivisor - 1) / (requestDivisor + txDivisor);
+			}
+
+			// Integer score steps lag the estimate by at most one step.
+			while (scoreWait < wait
+				&& GetPriorityScore(txElapsed + scoreWait, elapsed + scoreWait) < request->SendPriority)
+			{
+				const uint32_t requestStep = requestDivisor - ((elapsed + scoreWait) % requestDivisor);
+				const uint32_t txStep = txDivisor - ((txElapsed + scoreWait) % txDivisor);
+
+				if (requestStep < txStep)
+				{
+					scoreWait += requestStep;
+				}
+				else
+				{
+					scoreWait += txStep;
+				}
+			}
+
+			if (scoreWait < wait)
+			{
+				wait = scoreWait;
+			}
+		}
+
+		return wait;
+	}
+
+	/// <summary>
+	/// Calculates the priority score, to match with the request priority.
+	/// </summary>
+	/// <param name="txElapsed">Elapsed since last transmition ended, in microseconds.</param>
+	/// <param name="requestElapsed">Elapsed since the Send Request started, in microseconds.</param>
+	/// <returns>Abstract priority Score.</returns>
+	const uint8_t GetPriorityScore(const uint32_t txElapsed, const uint32_t requestElapsed) const
+	{
+		const uint32_t priorityPeriod = LoLaLink->GetPacketThrottlePeriod() * PRIORITY_PERIOD_SCALE;
+		const uint32_t scoreRequest = requestElapsed / ((uint32_t)1 + (priorityPeriod / PRIORITY_NEGATIVE_SCALE));
+		const uint32_t scoreTx = txElapsed / ((uint32_t)1 + (priorityPeriod / PRIORITY_POSITIVE_SCALE));
+
+		if (scoreRequest >= UINT8_MAX)
+		{
+			return UINT8_MAX;
+		}
+		else if (scoreTx >= UINT8_MAX
+			|| scoreTx >= ((uint32_t)UINT8_MAX - scoreRequest))
+		{
+			return UINT8_MAX;
+		}
+		else
+		{
+			return ((uint8_t)scoreRequest) + ((uint8_t)scoreTx);
+		}
+	}
+};
+#endif
@@ -12,7 +12,8 @@ namespace LoLaCryptoDefinition
 	enum class MacType : uint8_t
 	{
 		Xoodyak = 0x88,
-		Poly1305 = 0x13
+		Poly1305 = 0x13,
+		Ascon128 = 0xA5
 	};
 
 	/// Ascon (Cryptographic Cypher function).
@@ -22,18 +23,6 @@ namespace LoLaCryptoDefinition
 	static constexpr uint8_t CYPHER_KEY_SIZE = 16;
 	static constexpr uint8_t CYPHER_IV_SIZE = 16;
 
-#if defined(LOLA_USE_POLY1305)
-	/// Poly1305 (Cryptographic Hash function).
-	/// MIT licensed.
-	/// 16 byte (128 bit) bit digest.
-	/// </summary>
-#else
-	/// Xoodyak (Cryptographic Hash function).
-	/// Creative Commons Attribution 4.0 International License.
-	/// 32 byte (256 bit) bit digest.
-	/// </summary>
-#endif
-
 	/// <summary>
 	/// Channel PRNG entropy/key size.
 	/// </summary>
@@ -45,24 +34,74 @@ namespace LoLaCryptoDefinition
 	/// </summary>
 	static constexpr uint8_t TIME_TOKEN_KEY_SIZE = 4;
 
+	/// <summary>
+	/// Fresh contribution from each partner, for an in-band session rekey.
+	/// </summary>
+	static constexpr uint8_t REKEY_SEED_SIZE = 8;
+
+	/// <summary>
+	/// Size of the implicit packet counter.
+	/// Only the low LoLaPacketDefinition::ID_SIZE bytes are sent as the packet id,
+	///  the high bytes are tracked on both ends and never transmitted.
+	/// </summary>
+	static constexpr uint8_t COUNTER_SIZE = sizeof(uint32_t);
+
 	/// <summary>
 	/// Cypher Tag (Nonce) content indexes.
 	/// </summary>
 	static constexpr uint8_t CYPHER_TAG_TIMESTAMP_INDEX = 0;
 	static constexpr uint8_t CYPHER_TAG_ID_INDEX = CYPHER_TAG_TIMESTAMP_INDEX + TIME_TOKEN_KEY_SIZE;
-	static constexpr uint8_t CYPHER_TAG_SIZE = CYPHER_TAG_ID_INDEX + LoLaPacketDefinition::ID_SIZE;
+	static constexpr uint8_t CYPHER_TAG_SIZE = CYPHER_TAG_ID_INDEX + COUNTER_SIZE;
 
 	/// <summary>
 	/// Implicit addressing key size.
+	/// Fills the cypher IV after the tag, it is not the MAC key.
 	/// </summary>
 	static constexpr uint8_t ADDRESS_KEY_SIZE = CYPHER_IV_SIZE - CYPHER_TAG_SIZE;
 
+	/// <summary>
+	/// Minimum linked MAC key size, for every crypto backend.
+	/// 16 bytes (128 bit), the same strength as the cypher key.
+	/// </summary>
+	static constexpr uint8_t MAC_KEY_MIN_SIZE = 16;
+
+	/// <summary>
+	/// Elliptic-curve Diffie-Hellman public key exchange, on secp160r1.
+	/// </summary>
+	static constexpr uint8_t PKE_CURVE_SIZE = 160;
+
+	/// <summary>
+	/// Shared secret key size in bytes.
+	/// </summary>
+	static constexpr uint8_t SHARED_KEY_SIZE = PKE_CURVE_SIZE / 8;
+
+	/// <summary>
+	/// Public key, uncompressed.
+	/// </summary>
+	static constexpr uint8_t PUBLIC_KEY_SIZE = SHARED_KEY_SIZE * 2;
+
+	/// <summary>
+	/// Compressed Public key to be exchanged.
+	/// 161 bits take 21 bytes.
+	/// </summary>
+	static constexpr uint8_t COMPRESSED_KEY_SIZE = SHARED_KEY_SIZE + 1;
+
+	/// <summary>
+	/// Private key size.
+	/// 161 bits take 21 bytes.
+	/// </summary>
+	static constexpr uint8_t PRIVATE_KEY_SIZE = COMPRESSED_KEY_SIZE;
+
 	/// <summary>
 	/// The raw keys that are used during runtime encryption.
 	/// These are filled in with HKDF from the shared secret key.
 	/// </summary>
-	struct ExpandedKeyStruct
+	/// <typeparam name="MacKeySize">Dedicated MAC key size, from the crypto backend.</typeparam>
+	template<const uint8_t MacKeySize>
+	struct TemplateExpandedKeyStruct
 	{
+		static_assert(MacKeySize >= MAC_KEY_MIN_SIZE, "MAC key is too short.");
+
 		/// <summary>
 		/// Cypher Key.
 		/// </summary>
@@ -73,19 +112,15 @@ namespace LoLaCryptoDefinition
 		/// </summary>
 		uint8_t CypherIvSeed[ADDRESS_KEY_SIZE];
 
-#if defined(LOLA_USE_POLY1305)
 		/// <summary>
-		/// MAC key for Poly1305 (16 bytes).
+		/// Linked MAC key.
 		/// </summary>
-		uint8_t MacKey[CYPHER_IV_SIZE];
-#endif
+		uint8_t MacKey[MacKeySize];
 
 		/// <summary>
 		/// Channel PRNG seed.
 		/// </summary>
 		uint8_t ChannelSeed[CHANNEL_KEY_SIZE];
 	};
-
-	static constexpr uint8_t HKDFSize = sizeof(ExpandedKeyStruct);
 };
 #endif
\ No newline at end of file
@@ -13,7 +13,21 @@ namespace LoLaLinkDefinition
 	/// Top port is reserved for Link.
 	/// </summary>
 	static constexpr uint8_t LINK_PORT = UINT8_MAX;
-	static constexpr uint8_t MAX_DEFINITION_PORT = LINK_PORT - 1;
+
+	/// <summary>
+	/// Port reserved for aggregated frames: several service sub-frames packed in one packet.
+	/// Payload: ||Port0|Size0|Payload0..|Port1|Size1|Payload1..||
+	/// </summary>
+	static constexpr uint8_t AGGREGATE_PORT = LINK_PORT - 1;
+	static constexpr uint8_t AGGREGATE_SUB_HEADER_SIZE = 2;
+
+	static constexpr uint8_t MAX_DEFINITION_PORT = AGGREGATE_PORT - 1;
+
+	/// <summary>
+	/// Anti-replay window, in packet counts.
+	/// Packets up to RX_REPLAY_WINDOW_SIZE - 1 counts behind the latest are accepted once, out of order.
+	/// </summary>
+	static constexpr uint8_t RX_REPLAY_WINDOW_SIZE = 32;
 
 	/// <summary>
 	/// 24 bit session id.
@@ -84,6 +98,12 @@ namespace LoLaLinkDefinition
 	static constexpr uint8_t LINK_STAGE_TIMEOUT_DUPLEX_COUNT = 50;
 	static constexpr uint32_t LINK_STAGE_TIMEOUT_MIN_MICROS = 1000000;
 
+	/// <summary>
+	/// How many received packets can wait for the link to process them.
+	/// Absorbs bursts from fast transceivers. Must be a power of 2.
+	/// </summary>
+	static constexpr uint8_t RX_QUEUE_SIZE = 4;
+
 	/// <summary>
 	/// Duplex periods over this value are too long for LoLa to work effectively.
 	/// </summary>
@@ -94,6 +114,46 @@ namespace LoLaLinkDefinition
 	/// </summary>
 	static constexpr uint32_t REPORT_UPDATE_PERIOD_MICROS = 432100;
 
+	/// <summary>
+	/// Linked session key is ratcheted in-band (Server initiated), every period.
+	/// Configurable with LOLA_REKEY_PERIOD_SECONDS, 0 disables the rekey.
+	/// </summary>
+#if defined(LOLA_REKEY_PERIOD_SECONDS)
+	static constexpr uint32_t REKEY_PERIOD_SECONDS = LOLA_REKEY_PERIOD_SECONDS;
+#else
+	static constexpr uint32_t REKEY_PERIOD_SECONDS = 900;
+#endif
+
+	/// <summary>
+	/// Rekey switch over second is scheduled this far ahead of the request.
+	/// Longer than the longest link timeout,
+	///  so a partner that can't complete the exchange in time has already dropped the link.
+	/// </summary>
+	static constexpr uint8_t REKEY_SWITCH_DELAY_SECONDS = 4;
+
+	/// <summary>
+	/// Rekey request resend period, until the partner's reply arrives.
+	/// </summary>
+	static constexpr uint32_t REKEY_RESEND_PERIOD_MICROS = REPORT_UPDATE_PERIOD_MICROS / 8;
+
+	/// <summary>
+	/// After a link loss, the session is kept for this long, to resume without re-pairing.
+	/// Configurable with LOLA_RESUME_DURATION_MILLIS, 0 disables the resume.
+	/// Packet counters keep running through the resume, so partners must send
+	///  less than INT16_MAX packets between the link loss and the resume.
+	/// </summary>
+#if defined(LOLA_RESUME_DURATION_MILLIS)
+	static constexpr uint32_t RESUME_DURATION_MICROS = (uint32_t)LOLA_RESUME_DURATION_MILLIS * 1000;
+#else
+	static constexpr uint32_t RESUME_DURATION_MICROS = 3000000;
+#endif
+
+	/// <summary>
+	/// Resume request waits this many duplex periods for the switch over, before trying again.
+	/// Covers one pre-link duplex slot of the Server, which has a period of duplexPeriod x 2.
+	/// </summary>
+	static constexpr uint8_t RESUME_WAIT_DUPLEX_COUNT = 4;
+
 	/// <summary>
 	/// Limit the possible pre-link Advertising channels, BLE style.
 	/// Spreads the pipes across the whole channel spectrum.
@@ -117,6 +177,16 @@ namespace LoLaLinkDefinition
 		return (uint32_t)duplexPeriod * LINKING_TRANSITION_DUPLEX_COUNT;
 	}
 
+	/// <summary>
+	/// Resume wait depends on duplex period.
+	/// </summary>
+	/// <param name="duplexPeriod"></param>
+	/// <returns>Resume request wait duration in microseconds.</returns>
+	static constexpr uint32_t GetResumeWaitDuration(const uint16_t duplexPeriod)
+	{
+		return (uint32_t)duplexPeriod * RESUME_WAIT_DUPLEX_COUNT;
+	}
+
 	/// <summary>
 	/// Linking stages timeout depends on duplex period.
 	/// </summary>
@@ -136,5 +206,7 @@ namespace LoLaLinkDefinition
 	{
 		return LINK_STAGE_TIMEOUT_MIN_MICROS + (uint32_t)duplexPeriod * LINK_STAGE_TIMEOUT_DUPLEX_COUNT;
 	}
+
+	static_assert(((uint32_t)REKEY_SWITCH_DELAY_SECONDS * 1000000) > (LINK_STAGE_TIMEOUT_MIN_MICROS + (uint32_t)DUPLEX_PERIOD_MAX_MICROS * LINK_STAGE_TIMEOUT_DUPLEX_COUNT), "Rekey switch over must outlast the link timeout.");
 };
 #endif
\ No newline at end of file
@@ -31,6 +31,8 @@ struct LoLaLinkStatus
 	uint16_t RxDropRate = 0;
 	uint16_t TxDropRate = 0;
 
+	uint16_t RekeyCount = 0;
+
 #if defined(DEBUG_LOLA) || defined(DEBUG_LOLA_LINK)
 	void Log(Print& stream)
 	{
@@ -58,6 +60,8 @@ struct LoLaLinkStatus
 		stream.println(Quality.Age);
 		stream.print(F("\tSync Clock: "));
 		stream.println(Quality.ClockSync);
+		stream.print(F("\tRekey Count: "));
+		stream.println(RekeyCount);
 
 		stream.println();
 	}
@@ -211,6 +215,8 @@ public:
 		stream.println(Quality.Age);
 		stream.print(F("\tSync Clock: "));
 		stream.println(Quality.ClockSync);
+		stream.print(F("\tRekey Count: "));
+		stream.println(RekeyCount);
 
 		stream.println();
 	}
@@ -45,10 +45,26 @@ namespace LoLaPacketDefinition
 	static constexpr uint8_t MIN_PACKET_SIZE = (uint8_t)IndexEnum::MinPacketSize;
 
 	/// <summary>
-	/// Packet is limited to reduce buffer sizes,
-	/// and fixed to 32 which is the security limit of our stream key.
+	/// Default packet size, fits every supported transceiver.
 	/// </summary>
-	static constexpr uint8_t MAX_PACKET_TOTAL_SIZE = 32;
+	static constexpr uint8_t DEFAULT_PACKET_TOTAL_SIZE = 32;
+
+	/// <summary>
+	/// Packet is limited to reduce buffer sizes.
+	/// Configurable with LOLA_MAX_PACKET_SIZE [DEFAULT_PACKET_TOTAL_SIZE;UINT8_MAX],
+	///  for transceivers that carry larger frames.
+	/// Security limits don't depend on packet size:
+	///  MAC forgery chance is per packet (MAC_SIZE) and nonce uniqueness is per packet id and token,
+	///  while Ascon's data limit per key is far beyond any packet size.
+	/// </summary>
+#if defined(LOLA_MAX_PACKET_SIZE)
+	static_assert(LOLA_MAX_PACKET_SIZE <= UINT8_MAX, "LOLA_MAX_PACKET_SIZE must fit in a byte.");
+	static constexpr uint8_t MAX_PACKET_TOTAL_SIZE = LOLA_MAX_PACKET_SIZE;
+#else
+	static constexpr uint8_t MAX_PACKET_TOTAL_SIZE = DEFAULT_PACKET_TOTAL_SIZE;
+#endif
+
+	static_assert(MAX_PACKET_TOTAL_SIZE >= DEFAULT_PACKET_TOTAL_SIZE, "Link protocol requires at least DEFAULT_PACKET_TOTAL_SIZE.");
 
 
 	static constexpr uint8_t MAX_PAYLOAD_SIZE = MAX_PACKET_TOTAL_SIZE - (uint8_t)IndexEnum::Payload;
@@ -7,22 +7,43 @@
 #define _TASK_OO_CALLBACKS
 #include <TSchedulerDeclarations.hpp>
 
+#include <LoLaDefinitions.h>
 #include "LoLaTransceivers/ILoLaTransceiver.h"
 #include "IPacketServiceListener.h"
+#include "../Clock/CycleCounter.h"
 
+#if defined(LOLA_RTOS_PLATFORM) || defined(LOLA_HOST_PLATFORM)
+// Producer and consumer may run on different cores, ring indexes need hardware ordering.
+#include <atomic>
+#define LOLA_RX_RING_ATOMIC
+#endif
 
 /// <summary>
 /// Packet send and receive service, with a single IPacketServiceListener for receive.
 /// Interfaces directly with and abstracts ILoLaTransceiver.
 /// Properties:
 ///		Content abstract.
-///		Pushes input packets straight to Link buffer, so transceiver is free to receive more while the service processes it.
+///		Queues input packets in a lock-free ring, so transceiver is free to receive more while the service processes them.
+///		Zero-copy receive: transceivers can read straight into a ring slot, which the listener decodes in place.
 /// </summary>
+/// <typeparam name="RxSlotCount">Receive ring capacity, in packets. Must be a power of 2.</typeparam>
+template<const uint8_t RxSlotCount>
 class LoLaPacketService : public virtual ILoLaTransceiverListener, private TS::Task
 {
 private:
 	using SendResultEnum = IPacketServiceListener::SendResultEnum;
 
+	static_assert(RxSlotCount > 0 && RxSlotCount <= 128 && (RxSlotCount & (RxSlotCount - 1)) == 0,
+		"RxSlotCount must be a power of 2, up to 128.");
+
+	struct RxSlotStruct
+	{
+		uint8_t Data[LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE];
+		uint32_t Timestamp;
+		uint8_t Size;
+		uint8_t Rssi;
+	};
+
 	enum StateEnum
 	{
 		Done,
@@ -31,21 +52,33 @@ private:
 		SendingError
 	};
 
-	static constexpr uint8_t SEND_CHECK_PERIOD_MILLIS = 1;
-	static constexpr uint8_t SEND_TIMEOUT_TOLERANCE_MILLIS = 1;
+	static constexpr uint16_t SEND_TIMEOUT_TOLERANCE_MICROS = 1000;
 
 private:
 	IPacketServiceListener* ServiceListener;
 
-	uint8_t* RawInPacket = nullptr;
+	/// <summary>
+	/// Send timeout deadline is tracked on the link's cyclestamp.
+	/// </summary>
+	CycleCounter* Clock;
+
 	uint8_t* RawOutPacket = nullptr;
 
-	uint32_t SendOutTimestamp = 0;
-	uint8_t SendOutSize = 0;
+	uint32_t SendOutCyclestamp = 0;
+	uint32_t SendOutTimeout = 0;
 
-	volatile uint32_t ReceiveTimestamp = 0;
-	volatile uint8_t PendingReceiveSize = 0;
-	volatile uint8_t PendingReceiveRssi = 0;
+	/// <summary>
+	/// Single producer (OnRx) single consumer (Callback) ring.
+	/// Free running indexes: RxHead is only written by the producer, RxTail only by the consumer.
+	/// </summary>
+	RxSlotStruct RxSlots[RxSlotCount]{};
+#if defined(LOLA_RX_RING_ATOMIC)
+	std::atomic<uint8_t> RxHead{ 0 };
+	std::atomic<uint8_t> RxTail{ 0 };
+#else
+	volatile uint8_t RxHead = 0;
+	volatile uint8_t RxTail = 0;
+#endif
 
 	volatile StateEnum State = StateEnum::Done;
 
@@ -56,20 +89,20 @@ public:
 	LoLaPacketService(TS::Scheduler& scheduler,
 		IPacketServiceListener* serviceListener,
 		ILoLaTransceiver* transceiver,
-		uint8_t* rawInPacket,
+		CycleCounter* clock,
 		uint8_t* rawOutPacket)
 		: ILoLaTransceiverListener()
 		, TS::Task(TASK_IMMEDIATE, TASK_FOREVER, &scheduler, false)
 		, ServiceListener(serviceListener)
-		, RawInPacket(rawInPacket)
+		, Clock(clock)
 		, RawOutPacket(rawOutPacket)
 		, Transceiver(transceiver)
 	{}
 
 	const bool Setup()
 	{
-		if (RawInPacket != nullptr &&
-			RawOutPacket != nullptr &&
+		if (RawOutPacket != nullptr &&
+			Clock != nullptr &&
 			ServiceListener != nullptr &&
 			Transceiver != nullptr &&
 			Transceiver->SetupListener(this))
@@ -96,10 +129,10 @@ public:
 			ServiceListener->OnSendComplete(SendResultEnum::Success);
 			break;
 		case StateEnum::Sending:
-			if (millis() - SendOutTimestamp >
-				(SEND_TIMEOUT_TOLERANCE_MILLIS
-					+ ((Transceiver->GetTimeToAir(SendOutSize)
-						+ Transceiver->GetDurationInAir(SendOutSize)) / ONE_MILLI_MICROS)))
+		{
+			// Only runs on the timeout deadline, OnTx or an early wake-up for receive.
+			const uint32_t elapsed = Clock->GetDurationCyclestamp(SendOutCyclestamp, Clock->GetCyclestamp());
+			if (elapsed >= SendOutTimeout)
 			{
 				// Send timeout.
 				State = StateEnum::Done;
@@ -108,9 +141,11 @@ public:
 			}
 			else
 			{
-				TS::Task::delay(SEND_CHECK_PERIOD_MILLIS);
+				// Re-arm for the remaining duration.
+				TS::Task::delay(GetDelayMillis(SendOutTimeout - elapsed));
 			}
-			break;
+		}
+		break;
 		case StateEnum::SendingError:
 			TS::Task::enable();
 			State = StateEnum::Done;
@@ -124,11 +159,15 @@ public:
 			break;
 		}
 
-		if (PendingReceiveSize > 0)
+		const uint8_t tail = RxLoad(RxTail);
+		if (RxAcquire(RxHead) != tail)
 		{
-			ServiceListener->OnReceived(ReceiveTimestamp, PendingReceiveSize, PendingReceiveRssi);
+			// One packet per pass, the task runs again while the ring has more.
+			RxSlotStruct& slot = RxSlots[tail & (RxSlotCount - 1)];
+			ServiceListener->OnReceived(slot.Data, slot.Timestamp, slot.Size, slot.Rssi);
 
-			PendingReceiveSize = 0;
+			// Release the slot only after it's read.
+			RxRelease(RxTail, tail + 1);
 			TS::Task::enable();
 			return true;
 		}
@@ -181,10 +220,14 @@ public:
 #endif
 		if (Transceiver->Tx(RawOutPacket, size, channel))
 		{
-			SendOutTimestamp = millis();
-			SendOutSize = size;
+			SendOutCyclestamp = Clock->GetCyclestamp();
+			SendOutTimeout = SEND_TIMEOUT_TOLERANCE_MICROS
+				+ Transceiver->GetTimeToAir(size)
+				+ Transceiver->GetDurationInAir(size);
 			State = StateEnum::Sending;
-			TS::Task::enable();
+
+			// Timeout is armed once, OnTx wakes the task on completion.
+			TS::Task::enableDelayed(GetDelayMillis(SendOutTimeout));
 
 			return true;
 		}
@@ -230,7 +273,7 @@ public:
 public:
 	/// <summary>
 	/// Handles incoming packets.
-	/// Checks for busy status and forwards the packet to the listener.
+	/// Queues the packet for the listener, if there is a free slot.
 	/// </summary>
 	/// <param name="data">Raw packet data.</param>
 	/// <param name="receiveTimestamp">Accurate timestamp (micros()) of incoming packet start.</param>
@@ -239,17 +282,61 @@ public:
 	/// <returns>True if packet was successfully consumed. False, try again later.</returns>
 	virtual const bool OnRx(const uint8_t* data, const uint32_t receiveTimestamp, const uint8_t packetSize, const uint8_t rssi) final
 	{
-		if (PendingReceiveSize > 0)
+		uint8_t* buffer = GetRxBuffer();
+
+		if (buffer == nullptr
+			|| packetSize > LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE)
 		{
-			// We still have a pending packet, refuse this one for now.
+			// All slots are pending, refuse this one for now.
 			return false;
 		}
 
-		// Double buffer input packet, so we don't miss any in the meanwhile.
-		memcpy((void*)RawInPacket, (const void*)data, (size_t)packetSize);
-		PendingReceiveSize = packetSize;
-		ReceiveTimestamp = receiveTimestamp;
-		PendingReceiveRssi = rssi;
+		// Copy input packet to the free slot, so we don't miss any in the meanwhile.
+		memcpy((void*)buffer, (const void*)data, (size_t)packetSize);
+
+		return OnRxBuffer(receiveTimestamp, packetSize, rssi);
+	}
+
+	/// <summary>
+	/// Lends the free head slot, if any.
+	/// </summary>
+	/// <returns>Slot buffer, nullptr if all slots are pending.</returns>
+	virtual uint8_t* GetRxBuffer() final
+	{
+		const uint8_t head = RxLoad(RxHead);
+
+		if ((uint8_t)(head - RxAcquire(RxTail)) >= RxSlotCount)
+		{
+			return nullptr;
+		}
+
+		return RxSlots[head & (RxSlotCount - 1)].Data;
+	}
+
+	/// <summary>
+	/// Commits the lent head slot.
+	/// </summary>
+	/// <param name="receiveTimestamp">Accurate timestamp (micros()) of incoming packet start.</param>
+	/// <param name="packetSize">[MIN_PACKET_SIZE;MAX_PACKET_TOTAL_SIZE]</param>
+	/// <param name="rssi">Normalized RX RSSI [0:255].</param>
+	/// <returns>True if packet was successfully consumed.</returns>
+	virtual const bool OnRxBuffer(const uint32_t receiveTimestamp, const uint8_t packetSize, const uint8_t rssi) final
+	{
+		const uint8_t head = RxLoad(RxHead);
+
+		if ((uint8_t)(head - RxAcquire(RxTail)) >= RxSlotCount
+			|| packetSize > LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE)
+		{
+			return false;
+		}
+
+		RxSlotStruct& slot = RxSlots[head & (RxSlotCount - 1)];
+		slot.Timestamp = receiveTimestamp;
+		slot.Size = packetSize;
+		slot.Rssi = rssi;
+
+		// Publish the slot only after it's written.
+		RxRelease(RxHead, head + 1);
 
 		TS::Task::enable();
 
@@ -274,5 +361,69 @@ public:
 			break;
 		}
 	}
+
+private:
+	/// <summary>
+	/// Task delay covering the whole duration.
+	/// </summary>
+	/// <param name="duration">Duration in us.</param>
+	/// <returns>Duration in ms, rounded up.</returns>
+	static const uint32_t GetDelayMillis(const uint32_t duration)
+	{
+		return (duration + ONE_MILLI_MICROS - 1) / ONE_MILLI_MICROS;
+	}
+
+#if defined(LOLA_RX_RING_ATOMIC)
+	/// <summary>
+	/// Own index, only written by this side.
+	/// </summary>
+	static const uint8_t RxLoad(const std::atomic<uint8_t>& index)
+	{
+		return index.load(std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// Other side's index, slot accesses are not reordered before it.
+	/// </summary>
+	static const uint8_t RxAcquire(const std::atomic<uint8_t>& index)
+	{
+		return index.load(std::memory_order_acquire);
+	}
+
+	/// <summary>
+	/// Slot accesses are visible to the other side before the index update.
+	/// </summary>
+	static void RxRelease(std::atomic<uint8_t>& index, const uint8_t value)
+	{
+		index.store(value, std::memory_order_release);
+	}
+#else
+	/// <summary>
+	/// Single core: the ISR sees memory in program order, a compiler barrier is enough.
+	/// </summary>
+	static void RxBarrier()
+	{
+		__asm__ __volatile__("" ::: "memory");
+	}
+
+	static const uint8_t RxLoad(const volatile uint8_t& index)
+	{
+		return index;
+	}
+
+	static const uint8_t RxAcquire(const volatile uint8_t& index)
+	{
+		const uint8_t value = index;
+		RxBarrier();
+
+		return value;
+	}
+
+	static void RxRelease(volatile uint8_t& index, const uint8_t value)
+	{
+		RxBarrier();
+		index = value;
+	}
+#endif
 };
 #endif
\ No newline at end of file
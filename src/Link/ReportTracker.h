@@ -6,7 +6,7 @@
 
 #include <stdint.h>
 #include "LoLaLinkDefinition.h"
-#include "Quality\LinkQualityTracker.h"
+#include "Quality/LinkQualityTracker.h"
 
 class ReportTracker : public LinkQualityTracker
 {
@@ -0,0 +1,221 @@
+// StaticLinkRegistry.h
+
+#ifndef _STATIC_LINK_REGISTRY_h
+#define _STATIC_LINK_REGISTRY_h
+
+#include "ILinkRegistry.h"
+#include "LoLaLinkDefinition.h"
+
+/// <summary>
+/// Compile-time list of services, one port per service.
+/// Dispatch unrolls into a chain of constant port compares,
+///  with calls on the concrete service type, so final overrides are not virtual.
+/// </summary>
+template<typename... Services>
+class StaticServiceList
+{
+public:
+	static constexpr bool HasPort(const uint8_t port)
+	{
+		return false;
+	}
+
+	void Attach() {}
+
+	const bool IsLinkListener(const ILinkListener* listener) const
+	{
+		return false;
+	}
+
+	const bool IsPacketListener(const ILinkPacketListener* listener, const uint8_t port) const
+	{
+		return false;
+	}
+
+	void NotifyLinkListeners(const bool hasLink) {}
+
+	void NotifyPacketListener(const uint32_t timestamp, const uint8_t* payload, const uint8_t payloadSize, const uint8_t port) {}
+};
+
+template<typename Service, typename... Rest>
+class StaticServiceList<Service, Rest...>
+{
+private:
+	using NextList = StaticServiceList<Rest...>;
+
+	static_assert(!NextList::HasPort(Service::PORT), "Service port already listed.");
+	static_assert(Service::PORT <= LoLaLinkDefinition::MAX_DEFINITION_PORT, "Service port is reserved.");
+
+private:
+	Service* Instance = nullptr;
+
+	NextList Next{};
+
+public:
+	static constexpr bool HasPort(const uint8_t port)
+	{
+		return port == Service::PORT || NextList::HasPort(port);
+	}
+
+	void Attach(Service* service, Rest*... rest)
+	{
+		Instance = service;
+		Next.Attach(rest...);
+	}
+
+	const bool IsLinkListener(const ILinkListener* listener) const
+	{
+		return (Instance != nullptr && static_cast<const ILinkListener*>(Instance) == listener)
+			|| Next.IsLinkListener(listener);
+	}
+
+	const bool IsPacketListener(const ILinkPacketListener* listener, const uint8_t port) const
+	{
+		if (port == Service::PORT)
+		{
+			return Instance != nullptr && static_cast<const ILinkPacketListener*>(Instance) == listener;
+		}
+
+		return Next.IsPacketListener(listener, port);
+	}
+
+	void NotifyLinkListeners(const bool hasLink)
+	{
+		if (Instance != nullptr)
+		{
+			Instance->OnLinkStateUpdated(hasLink);
+		}
+		Next.NotifyLinkListeners(hasLink);
+	}
+
+	void NotifyPacketListener(const uint32_t timestamp, const uint8_t* payload, const uint8_t payloadSize, const uint8_t port)
+	{
+		if (port == Service::PORT)
+		{
+			if (Instance != nullptr)
+			{
+				Instance->OnPacketReceived(timestamp, payload, payloadSize, port);
+			}
+		}
+		else
+		{
+			Next.NotifyPacketListener(timestamp, payload, payloadSize, port);
+		}
+	}
+};
+
+/// <summary>
+/// Registry for a set of services known at compile time.
+/// Only keeps one pointer per service, no port arrays.
+/// Services must expose their PORT and be link listeners (see AbstractDiscoveryService).
+/// Instances are attached before their Setup, which then only validates their registration.
+/// Virtual dispatch is left for the link's own port and for non-service link listeners.
+/// </summary>
+/// <typeparam name="MaxLinkListeners">Extra link listeners, outside of the Services list.</typeparam>
+/// <typeparam name="Services">Service types, each on its own port.</typeparam>
+template<const uint8_t MaxLinkListeners,
+	typename... Services>
+class StaticLinkRegistry : public ILinkRegistry
+{
+private:
+	StaticServiceList<Services...> ServiceList{};
+
+	ILinkPacketListener* LinkPacketListener = nullptr;
+
+	ILinkListener* LinkListeners[MaxLinkListeners > 0 ? MaxLinkListeners : 1]{};
+	uint8_t LinkListenersCount = 0;
+
+public:
+	StaticLinkRegistry() : ILinkRegistry() {}
+
+	const bool Setup()
+	{
+		return true;
+	}
+
+	/// <summary>
+	/// Bind the service instances, in the same order as the Services list.
+	/// </summary>
+	void Attach(Services*... services)
+	{
+		ServiceList.Attach(services...);
+	}
+
+	virtual const bool RegisterLinkListener(ILinkListener* listener) final
+	{
+		if (listener == nullptr)
+		{
+			return false;
+		}
+
+		if (ServiceList.IsLinkListener(listener))
+		{
+			return true;
+		}
+
+		for (uint_fast8_t i = 0; i < LinkListenersCount; i++)
+		{
+			if (LinkListeners[i] == listener)
+			{
+				return false;
+			}
+		}
+
+		if (LinkListenersCount < MaxLinkListeners)
+		{
+			LinkListeners[LinkListenersCount++] = listener;
+
+			return true;
+		}
+
+		return false;
+	}
+
+	virtual const bool RegisterPacketListener(ILinkPacketListener* listener, const uint8_t port) final
+	{
+		if (listener == nullptr)
+		{
+			return false;
+		}
+
+		if (port == LoLaLinkDefinition::LINK_PORT)
+		{
+			if (LinkPacketListener == nullptr)
+			{
+				LinkPacketListener = listener;
+
+				return true;
+			}
+
+			return false;
+		}
+
+		return ServiceList.IsPacketListener(listener, port);
+	}
+
+	virtual void NotifyLinkListeners(const bool hasLink) final
+	{
+		ServiceList.NotifyLinkListeners(hasLink);
+
+		for (uint_fast8_t i = 0; i < LinkListenersCount; i++)
+		{
+			LinkListeners[i]->OnLinkStateUpdated(hasLink);
+		}
+	}
+
+	virtual void NotifyPacketListener(const uint32_t timestamp, const uint8_t* payload, const uint8_t payloadSize, const uint8_t port) final
+	{
+		if (port == LoLaLinkDefinition::LINK_PORT)
+		{
+			if (LinkPacketListener != nullptr)
+			{
+				LinkPacketListener->OnPacketReceived(timestamp, payload, payloadSize, port);
+			}
+		}
+		else
+		{
+			ServiceList.NotifyPacketListener(timestamp, payload, payloadSize, port);
+		}
+	}
+};
+#endif
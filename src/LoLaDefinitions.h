@@ -12,7 +12,25 @@
 #endif
 
 #if defined(LOLA_USE_POLY1305)
-// Use Poly1305 hash, instead of Xoodyak.
+// Default crypto backend is Poly1305CryptoBackend, instead of XoodyakCryptoBackend.
+#endif
+
+#if defined(LOLA_USE_ASCON_AEAD)
+// Default crypto backend is wrapped in AsconAeadCryptoBackend.
+// Linked packets are authenticated by the Ascon-128 AEAD tag, instead of a separate MAC.
+// The tag is only checked after decryption, so forged packets are no longer rejected early.
+#endif
+
+#if defined(LOLA_MAX_PACKET_SIZE)
+// Override max packet size, for transceivers with larger frames.
+#endif
+
+#if defined(LOLA_REKEY_PERIOD_SECONDS)
+// Override the linked session rekey period, 0 disables the rekey.
+#endif
+
+#if defined(LOLA_RESUME_DURATION_MILLIS)
+// Override how long a lost link's session can be resumed, 0 disables the resume.
 #endif
 
 #if !defined(ARDUINO)
@@ -32,6 +50,11 @@
 #define LOLA_RTOS_PAUSE()	vTaskSuspendAll()
 #define LOLA_RTOS_RESUME()	xTaskResumeAll()
 #define LOLA_RTOS_INTERRUPT IRAM_ATTR
+#elif defined(LOLA_HOST_PLATFORM)
+// Native POSIX host build, single threaded with Arduino/TaskScheduler shim.
+#define LOLA_RTOS_PAUSE()	((void)0)
+#define LOLA_RTOS_RESUME()	((void)0)
+#define LOLA_RTOS_INTERRUPT
 #else
 #error Platform not suported.
 #endif
@@ -4,15 +4,16 @@
 #define _ABSTRACT_LOLA_
 
 
-#include "../../Link\ILoLaLink.h"
-#include "../../Link\ILinkRegistry.h"
-#include "../../Link\LoLaLinkDefinition.h"
+#include "../../Link/ILoLaLink.h"
+#include "../../Link/ILinkRegistry.h"
+#include "../../Link/StaticLinkRegistry.h"
+#include "../../Link/LoLaLinkDefinition.h"
 
 #include "../../Link/PacketEventEnum.h"
 #include "../../Link/LoLaPacketService.h"
 
 #include "../../Clock/LinkClock.h"
-#include "../../Crypto/LoLaCryptoAmSession.h"
+#include "../../Crypto/LoLaCryptoEncoderSession.h"
 
 #include "../../Services/Template/TemplateLinkService.h"
 
@@ -21,6 +22,8 @@
 /// as it will handle pre-link Packet as well as use link time packets for link upkeep.
 /// As a partial abstract class, it implements ILoLaLink Listeners public register.
 /// </summary>
+/// <typeparam name="SessionType">Link session, i.e. LoLaCryptoAmSession.</typeparam>
+template<typename SessionType>
 class AbstractLoLa : public virtual ILoLaLink
 	, public virtual IPacketServiceListener
 	, protected TemplateLinkService<LoLaPacketDefinition::MAX_PAYLOAD_SIZE>
@@ -51,7 +54,7 @@ protected:
 
 protected:
 	// Packet service instance;
-	LoLaPacketService PacketService;
+	LoLaPacketService<LoLaLinkDefinition::RX_QUEUE_SIZE> PacketService;
 
 	// Listener registry interface.
 	ILinkRegistry* Registry;
@@ -59,15 +62,12 @@ protected:
 	// The outgoing content is encrypted and MAC'd here before being sent to the Transceiver for transmission.
 	uint8_t RawOutPacket[LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE]{};
 
-	// The incoming encrypted and MAC'd packet is stored here before validated, and decrypted to InData.
-	uint8_t RawInPacket[LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE]{};
-
 protected:
 	// Rx/Tx Transceiver for PHY.
 	ILoLaTransceiver* Transceiver;
 
 	// Expandable session encoder.
-	LoLaCryptoAmSession Session{};
+	SessionType Session{};
 
 protected:
 	// Duplex, Channel Hop and Cryptography depend on a synchronized clock between Server and Client.
@@ -100,7 +100,7 @@ public:
 		: ILoLaLink()
 		, IPacketServiceListener()
 		, BaseClass(scheduler, this)
-		, PacketService(scheduler, this, transceiver, RawInPacket, RawOutPacket)
+		, PacketService(scheduler, this, transceiver, &SyncClock, RawOutPacket)
 		, Registry(linkRegistry)
 		, Transceiver(transceiver)
 		, SyncClock(scheduler, cycles)
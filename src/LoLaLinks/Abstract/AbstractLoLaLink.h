@@ -12,10 +12,36 @@ using namespace LinkDefinitions;
 /// <summary>
 /// 
 /// </summary>
-class AbstractLoLaLink : public AbstractLoLaLinkPacket
+template<typename SessionType>
+class AbstractLoLaLink : public AbstractLoLaLinkPacket<SessionType>
 {
 private:
-	using BaseClass = AbstractLoLaLinkPacket;
+	using BaseClass = AbstractLoLaLinkPacket<SessionType>;
+
+public:
+	using BaseClass::GetPacketThrottlePeriod;
+	using BaseClass::HasLink;
+
+protected:
+	using BaseClass::CacheResume;
+	using BaseClass::CanRequestSend;
+	using BaseClass::ClearResume;
+	using BaseClass::GetLinkingStageTimeoutDuration;
+	using BaseClass::GetStageElapsed;
+	using BaseClass::HasResumeExpired;
+	using BaseClass::IsResumable;
+	using BaseClass::LinkStage;
+	using LinkStageEnum = typename BaseClass::LinkStageEnum;
+	using BaseClass::LinkTimestamp;
+	using BaseClass::OutPacket;
+	using BaseClass::RandomSource;
+	using BaseClass::ReceivedCounter;
+	using BaseClass::Registry;
+	using BaseClass::RequestSendPacket;
+	using BaseClass::SentCounter;
+	using BaseClass::Session;
+	using BaseClass::SyncClock;
+	using BaseClass::Transceiver;
 
 private:
 	/// <summary>
@@ -49,6 +75,11 @@ protected:
 	/// <returns>True if a clock sync update is due or pending to send.</returns>
 	virtual const bool CheckForClockTuneUpdate() { return false; }
 
+	/// <summary>
+	/// </summary>
+	/// <returns>True if a rekey packet is due to send.</returns>
+	virtual const bool CheckForRekeyUpdate() { return false; }
+
 	virtual const uint8_t GetClockQuality() { return 0; }
 
 public:
@@ -93,6 +124,7 @@ public:
 		linkStatus.Quality.TxDrop = QualityTracker.GetTxDropQuality();
 		linkStatus.Quality.ClockSync = GetClockQuality();
 		linkStatus.Quality.Age = QualityTracker.GetLastValidReceivedAgeQuality();
+		linkStatus.RekeyCount = Session.GetRekeyCount();
 
 		SyncClock.GetTimestampMonotonic(LinkTimestamp);
 		linkStatus.DurationSeconds = Timestamp::GetElapsedSeconds(LinkStartTimestamp, LinkTimestamp);
@@ -206,19 +238,33 @@ protected:
 		switch (linkStage)
 		{
 		case LinkStageEnum::Disabled:
+			ClearResume();
 			SyncClock.Stop();
 			break;
 		case LinkStageEnum::Booting:
 			SyncClock.Start();
 			SyncClock.ShiftSubSeconds(RandomSource.GetRandomLong());
 			break;
+		case LinkStageEnum::Sleeping:
+		case LinkStageEnum::Pairing:
+			ClearResume();
+			break;
 		case LinkStageEnum::Searching:
-			SyncClock.ShiftSeconds(RandomSource.GetRandomLong());
+			if (LinkStage == LinkStageEnum::Linked)
+			{
+				CacheResume();
+			}
+			if (!IsResumable())
+			{
+				SyncClock.ShiftSeconds(RandomSource.GetRandomLong());
+			}
+			Session.ClearRekey();
 			break;
 		case LinkStageEnum::Authenticating:
 			QualityTracker.ResetRssiQuality();
 			break;
 		case LinkStageEnum::Linked:
+			ClearResume();
 			SyncClock.GetTimestampMonotonic(LinkStartTimestamp);
 			QualityTracker.Reset(micros());
 			break;
@@ -302,6 +348,16 @@ protected:
 #endif
 				UpdateLinkStage(LinkStageEnum::Sleeping);
 			}
+			else if (HasResumeExpired())
+			{
+#if defined(DEBUG_LOLA_LINK)
+				this->Owner();
+				Serial.println(F("Resume expired."));
+#endif
+				// Restart searching for a new session.
+				ClearResume();
+				UpdateLinkStage(LinkStageEnum::Searching);
+			}
 			else
 			{
 				OnServiceSearching();
@@ -362,6 +418,12 @@ protected:
 				// Zero quality age means link has timed out.
 				UpdateLinkStage(LinkStageEnum::Searching);
 			}
+			else if (Session.IsRekeyLate()
+				&& Session.CalculateRekey())
+			{
+				// Linked packets are held back until the next keys are ready.
+				TS::Task::enable();
+			}
 			else if (CheckForReportUpdate())
 			{
 				// Report takes priority over clock, as it refers to counters and RSSI.
@@ -372,6 +434,15 @@ protected:
 			{
 				TS::Task::enable();
 			}
+			else if (CheckForRekeyUpdate())
+			{
+				TS::Task::enable();
+			}
+			else if (Session.CalculateRekey())
+			{
+				// One hash pass per run, the next keys are ready before the switch over.
+				TS::Task::enable();
+			}
 			else
 			{
 				TS::Task::enableDelayed(LINK_CHECK_PERIOD);
@@ -461,7 +532,7 @@ private:
 			measure *= 4;
 		}
 
-		return GetProgressPriority<RequestPriority::IRREGULAR, RequestPriority::RESERVED_FOR_LINK>(measure);
+		return BaseClass::template GetProgressPriority<RequestPriority::IRREGULAR, RequestPriority::RESERVED_FOR_LINK>(measure);
 	}
 };
 #endif
\ No newline at end of file
@@ -9,10 +9,37 @@
 #include "../../Link/LinkClockSync.h"
 #include "../../Link/PreLinkDuplex.h"
 
-class AbstractLoLaLinkClient : public AbstractLoLaLink
+template<typename SessionType>
+class AbstractLoLaLinkClient : public AbstractLoLaLink<SessionType>
 {
 private:
-	using BaseClass = AbstractLoLaLink;
+	using BaseClass = AbstractLoLaLink<SessionType>;
+
+public:
+	using BaseClass::SendPacket;
+
+protected:
+	using BaseClass::ArrayToInt32;
+	using BaseClass::ArrayToUInt32;
+	using BaseClass::CanRequestSend;
+	using BaseClass::Duplex;
+	using BaseClass::GetOnAirDuration;
+	using BaseClass::GetSendDuration;
+	using BaseClass::GetStageElapsed;
+	using BaseClass::IsResumable;
+	using BaseClass::LinkStage;
+	using LinkStageEnum = typename BaseClass::LinkStageEnum;
+	using BaseClass::LinkTimestamp;
+	using BaseClass::OutPacket;
+	using BaseClass::PacketService;
+	using BaseClass::RandomSource;
+	using BaseClass::RequestSendPacket;
+	using BaseClass::ResetUnlinkedPacketThrottle;
+	using BaseClass::Session;
+	using BaseClass::SetAdvertisingChannel;
+	using BaseClass::SyncClock;
+	using BaseClass::UInt32ToArray;
+	using BaseClass::UnlinkedPacketThrottle;
 
 private:
 	static constexpr uint8_t CHANNEL_SEARCH_TRY_COUNT = 3;
@@ -32,8 +59,12 @@ private:
 	uint8_t SearchChannel = 0;
 	uint8_t SearchChannelTryCount = 0;
 
+	uint8_t RekeySeed[LoLaCryptoDefinition::REKEY_SEED_SIZE]{};
+	uint32_t RekeySecond = 0;
+
 	bool AuthenticationReplyPending = false;
 	bool ClockAccepted = false;
+	bool RekeyReplyPending = false;
 
 #if defined(DEBUG_LOLA_LINK)
 	struct LinkingLogStruct
@@ -122,6 +153,29 @@ protected:
 		return false;
 	}
 
+	/// <summary>
+	/// Client replies to every Server rekey request, with the same contribution.
+	/// </summary>
+	/// <returns>True if a rekey reply is pending to send.</returns>
+	const bool CheckForRekeyUpdate() final
+	{
+		if (RekeyReplyPending
+			&& CanRequestSend())
+		{
+			OutPacket.SetPort(LoLaLinkDefinition::LINK_PORT);
+			OutPacket.SetHeader(Linked::RekeyReply::HEADER);
+			UInt32ToArray(RekeySecond, &OutPacket.Payload[Linked::RekeyReply::PAYLOAD_SECOND_INDEX]);
+			memcpy(&OutPacket.Payload[Linked::RekeyReply::PAYLOAD_SEED_INDEX], RekeySeed, LoLaCryptoDefinition::REKEY_SEED_SIZE);
+
+			if (RequestSendPacket(Linked::RekeyReply::PAYLOAD_SIZE, RequestPriority::REGULAR))
+			{
+				RekeyReplyPending = false;
+			}
+		}
+
+		return RekeyReplyPending;
+	}
+
 	void OnPreSend() final
 	{
 		if (OutPacket.GetPort() == LoLaLinkDefinition::LINK_PORT
@@ -152,7 +206,15 @@ protected:
 #if defined(DEBUG_LOLA_LINK) 
 			LinkingLog.Start = micros();
 #endif
-			SearchChannel = RandomSource.GetRandomShort();
+			if (IsResumable())
+			{
+				// Resume tries sweep the advertising channels.
+				SearchChannel++;
+			}
+			else
+			{
+				SearchChannel = RandomSource.GetRandomShort();
+			}
 			SetAdvertisingChannel(SearchChannel);
 			SearchChannelTryCount = 0;
 			ResetUnlinkedPacketThrottle();
@@ -179,6 +241,9 @@ protected:
 		case LinkStageEnum::ClockSyncing:
 			ClockAccepted = false;
 			break;
+		case LinkStageEnum::SwitchingToLinked:
+			StateTransition.Clear();
+			break;
 		case LinkStageEnum::Linked:
 #if defined(DEBUG_LOLA_LINK)
 			LinkingLog.Linking = micros() - LinkingLog.Start;
@@ -198,6 +263,7 @@ protected:
 			Serial.println(F(" ms"));
 #endif
 			ClockTracker.Reset(micros());
+			RekeyReplyPending = false;
 			break;
 		default:
 			break;
@@ -361,7 +427,6 @@ protected:
 				&& LinkStage == LinkStageEnum::Pairing
 				&& Session.PairingTokenMatches(&payload[Unlinked::LinkingTimedSwitchOver::PAYLOAD_SESSION_TOKEN_INDEX]))
 			{
-				SetReceiveCounter(rollingCounter);	// Save last received counter, ready for switch for next stage.
 				StateTransition.OnReceived(timestamp, &payload[Unlinked::LinkingTimedSwitchOver::PAYLOAD_TIME_INDEX]);
 				SyncSequence = payload[Unlinked::LinkingTimedSwitchOver::PAYLOAD_REQUEST_ID_INDEX];
 				TS::Task::enableDelayed(0);
@@ -545,6 +610,16 @@ protected:
 				else {
 					this->Skipped(F("ClockTuneReply"));
 				}
+#endif
+				break;
+			case Linked::RekeyRequest::HEADER:
+				if (payloadSize == Linked::RekeyRequest::PAYLOAD_SIZE)
+				{
+					OnRekeyRequestReceived(&payload[Linked::RekeyRequest::PAYLOAD_SEED_INDEX]
+						, ArrayToUInt32(&payload[Linked::RekeyRequest::PAYLOAD_SECOND_INDEX]));
+				}
+#if defined(DEBUG_LOLA_LINK)
+				else { this->Skipped(F("RekeyRequest")); }
 #endif
 				break;
 			default:
@@ -555,6 +630,48 @@ protected:
 	}
 
 private:
+	/// <summary>
+	/// The Client agrees on the first request for a switch over second,
+	///  repeated requests only repeat the reply.
+	/// </summary>
+	/// <param name="serverSeed"></param>
+	/// <param name="switchSecond"></param>
+	void OnRekeyRequestReceived(const uint8_t* serverSeed, const uint32_t switchSecond)
+	{
+		if (Session.HasRekeyPending())
+		{
+			if (switchSecond == RekeySecond)
+			{
+				RekeyReplyPending = true;
+				TS::Task::enableDelayed(0);
+			}
+#if defined(DEBUG_LOLA_LINK)
+			else { this->Skipped(F("RekeyRequest")); }
+#endif
+			return;
+		}
+
+		SyncClock.GetTimestamp(LinkTimestamp);
+		const int32_t delay = (int32_t)(switchSecond - LinkTimestamp.Seconds);
+
+		if (delay > 0
+			&& delay <= LoLaLinkDefinition::REKEY_SWITCH_DELAY_SECONDS)
+		{
+			RandomSource.GetRandomStreamCrypto(RekeySeed, LoLaCryptoDefinition::REKEY_SEED_SIZE);
+			RekeySecond = switchSecond;
+			Session.SetRekey(serverSeed, RekeySeed, switchSecond);
+			RekeyReplyPending = true;
+			TS::Task::enableDelayed(0);
+#if defined(DEBUG_LOLA_LINK)
+			this->Owner();
+			Serial.println(F("Rekey agreed."));
+#endif
+		}
+#if defined(DEBUG_LOLA_LINK)
+		else { this->Skipped(F("RekeyRequest")); }
+#endif
+	}
+
 	const uint32_t GetClockSyncRetryPeriod()
 	{
 		return Duplex->GetPeriod();
@@ -572,12 +689,16 @@ private:
 			measure *= 2;
 		}
 
-		return GetProgressPriority<RequestPriority::IRREGULAR, RequestPriority::RESERVED_FOR_LINK>(measure);
+		return BaseClass::template GetProgressPriority<RequestPriority::IRREGULAR, RequestPriority::RESERVED_FOR_LINK>(measure);
 	}
 
 	void OnServiceSearching() final
 	{
-		if (UnlinkedPacketThrottle())
+		if (IsResumable())
+		{
+			OnServiceResuming();
+		}
+		else if (UnlinkedPacketThrottle())
 		{
 			if (SearchChannelTryCount >= CHANNEL_SEARCH_TRY_COUNT)
 			{
@@ -608,6 +729,38 @@ private:
 		TS::Task::enableDelayed(0);
 	}
 
+	/// <summary>
+	/// Sends a resume request and waits for the Server's switch over, on the cached session.
+	/// Each try starts on the next advertising channel.
+	/// </summary>
+	void OnServiceResuming()
+	{
+		if (UnlinkedPacketThrottle())
+		{
+			LOLA_RTOS_PAUSE();
+			if (PacketService.CanSendPacket())
+			{
+				SyncClock.GetTimestamp(LinkTimestamp);
+				LinkTimestamp.ShiftSubSeconds(GetSendDuration(Unlinked::ResumeRequest::PAYLOAD_SIZE));
+
+				OutPacket.SetPort(LoLaLinkDefinition::LINK_PORT);
+				OutPacket.SetHeader(Unlinked::ResumeRequest::HEADER);
+				Session.GetResumeToken(LinkTimestamp.Seconds, &OutPacket.Payload[Unlinked::ResumeRequest::PAYLOAD_TOKEN_INDEX]);
+				if (SendPacket(OutPacket.Data, Unlinked::ResumeRequest::PAYLOAD_SIZE))
+				{
+#if defined(DEBUG_LOLA_LINK)
+					this->Owner();
+					Serial.print(F("Sent Resume @ "));
+					Serial.println(LoLaLinkDefinition::GetAdvertisingChannel(ChannelHopper->GetChannel()));
+#endif
+					UpdateLinkStage(LinkStageEnum::SwitchingToLinked);
+				}
+			}
+			LOLA_RTOS_RESUME();
+		}
+		TS::Task::enableDelayed(0);
+	}
+
 	void OnServiceSwitchingToLinking() final
 	{
 		if (StateTransition.HasTimedOut(micros()))
@@ -648,7 +801,19 @@ private:
 
 	void OnServiceSwitchingToLinked() final
 	{
-		if (StateTransition.HasTimedOut(micros()))
+		if (!StateTransition.HasAcknowledge())
+		{
+			// Only a resume waits for the Server's switch over.
+			if (GetStageElapsed() > LoLaLinkDefinition::GetResumeWaitDuration(Duplex->GetPeriod()))
+			{
+#if defined(DEBUG_LOLA_LINK)
+				this->Owner();
+				Serial.println(F("Resume not answered."));
+#endif
+				UpdateLinkStage(LinkStageEnum::Searching);
+			}
+		}
+		else if (StateTransition.HasTimedOut(micros()))
 		{
 			if (StateTransition.HasAcknowledge())
 			{
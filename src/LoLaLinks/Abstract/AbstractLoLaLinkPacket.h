@@ -6,6 +6,7 @@
 #include "../../Duplexes/IDuplex.h"
 #include "../../ChannelHoppers/IChannelHop.h"
 #include "../../Link/LoLaLinkSession.h"
+#include "../../Link/LinkSendArbiter.h"
 
 #include "AbstractLoLaReceiver.h"
 
@@ -14,12 +15,31 @@
 /// Implements channel management.
 /// As a partial abstract class, it implements the following ILoLaLink calls:
 ///		- CanSendPacket.
+///		- RequestSend/CancelSend.
 ///		- GetRxChannel.
 /// </summary>
-class AbstractLoLaLinkPacket : public virtual IChannelHop::IHopListener, public AbstractLoLaReceiver
+template<typename SessionType>
+class AbstractLoLaLinkPacket : public virtual IChannelHop::IHopListener, public AbstractLoLaReceiver<SessionType>
 {
 private:
-	using BaseClass = AbstractLoLaReceiver;
+	using BaseClass = AbstractLoLaReceiver<SessionType>;
+
+protected:
+	using BaseClass::GetOnAirDuration;
+	using BaseClass::GetSendDuration;
+	using BaseClass::LinkStage;
+	using LinkStageEnum = typename BaseClass::LinkStageEnum;
+	using BaseClass::OutPacket;
+	using BaseClass::PacketService;
+	using BaseClass::ReceivedCounter;
+	using BaseClass::Registry;
+	using BaseClass::ResetReceiveCounter;
+	using BaseClass::SentCounter;
+	using BaseClass::Session;
+	using BaseClass::SetSendCalibration;
+	using BaseClass::SetSendCounter;
+	using BaseClass::SyncClock;
+	using BaseClass::Transceiver;
 
 #if defined(F_CPU)
 	static constexpr uint32_t CPU_CLOCK = F_CPU;
@@ -54,8 +74,19 @@ protected:
 	Timestamp LinkTimestamp{};
 
 private:
+	/// <summary>
+	/// Picks the next service send request, when the duplex slot is open.
+	/// </summary>
+	LinkSendArbiter SendArbiter;
+
 	uint32_t StageStartTime = 0;
 
+	/// <summary>
+	/// Lost link's session is kept for a resume, until the resume duration expires.
+	/// </summary>
+	uint32_t ResumeStart = 0;
+	bool ResumeCached = false;
+
 	const bool IsLinkHopper;
 
 public:
@@ -72,6 +103,7 @@ public:
 		, Duplex(duplex)
 		, ChannelHopper(hop)
 		, LinkTimestamp()
+		, SendArbiter(scheduler, this)
 		, IsLinkHopper(hop->GetHopPeriod() != IChannelHop::NOT_A_HOPPER)
 	{
 	}
@@ -231,6 +263,35 @@ public:
 			&& PacketService.CanSendPacket();
 	}
 
+	const uint32_t GetSendWait(const uint8_t payloadSize) final
+	{
+		if (LinkStage != LinkStageEnum::Linked)
+		{
+			return 0;
+		}
+
+		const uint32_t slotWait = Duplex->GetTimeToRange(SyncClock.GetRollingMicros() + GetSendDuration(payloadSize), GetOnAirDuration(payloadSize));
+
+		if (slotWait == 0
+			&& !PacketService.CanSendPacket())
+		{
+			// Transmission in progress, check again after the shortest packet.
+			return GetOnAirDuration(0);
+		}
+
+		return slotWait;
+	}
+
+	const bool RequestSend(ILinkSendRequest* request) final
+	{
+		return SendArbiter.Enqueue(request);
+	}
+
+	void CancelSend(ILinkSendRequest* request) final
+	{
+		SendArbiter.Cancel(request);
+	}
+
 	/// <summary>
 	/// IPacketServiceListener overrides.
 	/// </summary>
@@ -290,9 +351,15 @@ protected:
 			case LinkStageEnum::Disabled:
 				TS::Task::disable();
 				break;
+			case LinkStageEnum::Authenticating:
+				// Encrypted stages start the implicit counter high bits at zero, on both ends.
+				// Starting below INT16_MAX, the partner's first accepted packet can't have wrapped yet.
+				SetSendCounter((uint16_t)RandomSource.GetRandomLong() & INT16_MAX);
+				ResetReceiveCounter();
+				TS::Task::enable();
+				break;
 			case LinkStageEnum::Sleeping:
 			case LinkStageEnum::Pairing:
-			case LinkStageEnum::Authenticating:
 			case LinkStageEnum::ClockSyncing:
 			case LinkStageEnum::SwitchingToLinking:
 			case LinkStageEnum::SwitchingToLinked:
@@ -301,8 +368,12 @@ protected:
 			case LinkStageEnum::Searching:
 				ChannelHopper->OnLinkStopped();
 				RandomSource.RandomReseed();
-				SetSendCounter((uint16_t)RandomSource.GetRandomLong());
-				SetReceiveCounter((uint16_t)RandomSource.GetRandomLong());
+				if (!ResumeCached)
+				{
+					SetSendCounter((uint16_t)RandomSource.GetRandomLong());
+					ResetReceiveCounter();
+				}
+				// Else counters keep running, the resumed session never reuses a nonce.
 				PacketService.RefreshChannel();
 				break;
 			case LinkStageEnum::Linked:
@@ -316,6 +387,7 @@ protected:
 
 				// Notify services that link is ready.
 				Registry->NotifyLinkListeners(true);
+				SendArbiter.Wake();
 				TS::Task::enable();
 				break;
 			default:
@@ -380,6 +452,31 @@ protected:
 		return micros() - StageStartTime;
 	}
 
+	/// <summary>
+	/// Keeps the linked session (keys, partner, clock and counters) after a link loss.
+	/// </summary>
+	void CacheResume()
+	{
+		ResumeCached = LoLaLinkDefinition::RESUME_DURATION_MICROS > 0;
+		ResumeStart = micros();
+	}
+
+	void ClearResume()
+	{
+		ResumeCached = false;
+	}
+
+	const bool IsResumable() const
+	{
+		return ResumeCached;
+	}
+
+	const bool HasResumeExpired()
+	{
+		return ResumeCached
+			&& (micros() - ResumeStart) > LoLaLinkDefinition::RESUME_DURATION_MICROS;
+	}
+
 	void SetAdvertisingChannel(const uint8_t channel)
 	{
 		ChannelHopper->SetChannel(channel);
@@ -429,8 +526,13 @@ private:
 				return false;
 			}
 		}
-		const uint32_t shortDuration = (micros() - start) / CALIBRATION_ROUNDS;
+		uint32_t shortDuration = (micros() - start) / CALIBRATION_ROUNDS;
 		LOLA_RTOS_RESUME();
+		if (shortDuration == 0)
+		{
+			// Fast platforms encode in under 1 us, clamp to timer resolution.
+			shortDuration = 1;
+		}
 		LOLA_RTOS_PAUSE();
 		start = micros();
 		for (uint_fast16_t i = 0; i < CALIBRATION_ROUNDS; i++)
@@ -9,10 +9,35 @@
 #include "../../Link/LinkClockTracker.h"
 #include "../../Link/PreLinkDuplex.h"
 
-class AbstractLoLaLinkServer : public AbstractLoLaLink
+template<typename SessionType>
+class AbstractLoLaLinkServer : public AbstractLoLaLink<SessionType>
 {
 private:
-	using BaseClass = AbstractLoLaLink;
+	using BaseClass = AbstractLoLaLink<SessionType>;
+
+public:
+	using BaseClass::SendPacket;
+
+protected:
+	using BaseClass::ArrayToUInt32;
+	using BaseClass::CanRequestSend;
+	using BaseClass::GetOnAirDuration;
+	using BaseClass::GetSendDuration;
+	using BaseClass::Int32ToArray;
+	using BaseClass::IsResumable;
+	using BaseClass::LinkStage;
+	using LinkStageEnum = typename BaseClass::LinkStageEnum;
+	using BaseClass::LinkTimestamp;
+	using BaseClass::OutPacket;
+	using BaseClass::PacketService;
+	using BaseClass::RandomSource;
+	using BaseClass::RequestSendPacket;
+	using BaseClass::ResetUnlinkedPacketThrottle;
+	using BaseClass::Session;
+	using BaseClass::SetAdvertisingChannel;
+	using BaseClass::SyncClock;
+	using BaseClass::UInt32ToArray;
+	using BaseClass::UnlinkedPacketThrottle;
 
 private:
 	static constexpr uint32_t SEARCH_CHANNEL_LINGER_DURATION = 250 * ONE_MILLI_MICROS;
@@ -26,6 +51,12 @@ private:
 
 	PreLinkMasterDuplex LinkingDuplex;
 
+	uint8_t RekeySeed[LoLaCryptoDefinition::REKEY_SEED_SIZE]{};
+	uint32_t RekeySecond = 0;
+	uint32_t RekeyStartSecond = 0;
+	uint32_t RekeyLastSent = 0;
+	bool RekeyRequesting = false;
+
 	uint32_t ChannelSearchStart = 0;
 	uint8_t SyncSequence = 0;
 	bool ClientAuthenticated = false;
@@ -87,7 +118,10 @@ protected:
 			break;
 		case LinkStageEnum::Searching:
 			ChannelSearchStart = micros();
-			NewSession();
+			if (!IsResumable())
+			{
+				NewSession();
+			}
 			SearchReplyPending = false;
 			ResetUnlinkedPacketThrottle();
 			break;
@@ -109,6 +143,9 @@ protected:
 		case LinkStageEnum::ClockSyncing:
 			break;
 		case LinkStageEnum::Linked:
+			SyncClock.GetTimestamp(LinkTimestamp);
+			RekeyStartSecond = LinkTimestamp.Seconds;
+			RekeyRequesting = false;
 			break;
 		default:
 			break;
@@ -301,7 +338,15 @@ protected:
 				this->Owner();
 				Serial.println(F("StateTransition failed."));
 #endif
-				UpdateLinkStage(LinkStageEnum::Pairing);
+				if (IsResumable())
+				{
+					// Wait for the next resume request.
+					UpdateLinkStage(LinkStageEnum::Searching);
+				}
+				else
+				{
+					UpdateLinkStage(LinkStageEnum::Pairing);
+				}
 			}
 		}
 		else if (StateTransition.IsSendRequested(micros())
@@ -356,6 +401,68 @@ protected:
 		return false;
 	}
 
+	/// <summary>
+	/// Server starts the rekey every period and resends its request until the Client replies.
+	/// Both switch to the next key at the agreed second.
+	/// </summary>
+	/// <returns>True if a rekey request is due to send.</returns>
+	const bool CheckForRekeyUpdate() final
+	{
+		if (LoLaLinkDefinition::REKEY_PERIOD_SECONDS == 0
+			|| Session.HasRekeyPending())
+		{
+			return false;
+		}
+
+		SyncClock.GetTimestamp(LinkTimestamp);
+
+		if (RekeyRequesting)
+		{
+			if ((int32_t)(LinkTimestamp.Seconds - RekeySecond) >= 0)
+			{
+				// No reply before the switch over, link will time out if the partner switched alone.
+				RekeyRequesting = false;
+				RekeyStartSecond = LinkTimestamp.Seconds;
+#if defined(DEBUG_LOLA_LINK)
+				this->Owner();
+				Serial.println(F("Rekey timed out."));
+#endif
+				return false;
+			}
+		}
+		else if ((LinkTimestamp.Seconds - RekeyStartSecond) >= LoLaLinkDefinition::REKEY_PERIOD_SECONDS)
+		{
+			RandomSource.GetRandomStreamCrypto(RekeySeed, LoLaCryptoDefinition::REKEY_SEED_SIZE);
+			RekeySecond = LinkTimestamp.Seconds + LoLaLinkDefinition::REKEY_SWITCH_DELAY_SECONDS;
+			RekeyLastSent = micros() - LoLaLinkDefinition::REKEY_RESEND_PERIOD_MICROS;
+			RekeyRequesting = true;
+		}
+		else
+		{
+			return false;
+		}
+
+		if (micros() - RekeyLastSent >= LoLaLinkDefinition::REKEY_RESEND_PERIOD_MICROS)
+		{
+			if (CanRequestSend())
+			{
+				OutPacket.SetPort(LoLaLinkDefinition::LINK_PORT);
+				OutPacket.SetHeader(Linked::RekeyRequest::HEADER);
+				UInt32ToArray(RekeySecond, &OutPacket.Payload[Linked::RekeyRequest::PAYLOAD_SECOND_INDEX]);
+				memcpy(&OutPacket.Payload[Linked::RekeyRequest::PAYLOAD_SEED_INDEX], RekeySeed, LoLaCryptoDefinition::REKEY_SEED_SIZE);
+
+				if (RequestSendPacket(Linked::RekeyRequest::PAYLOAD_SIZE, RequestPriority::REGULAR))
+				{
+					RekeyLastSent = micros();
+				}
+			}
+
+			return true;
+		}
+
+		return false;
+	}
+
 	virtual void OnUnlinkedPacketReceived(const uint32_t timestamp, const uint8_t* payload, const uint16_t rollingCounter, const uint8_t payloadSize)
 	{
 		switch (payload[HeaderDefinition::HEADER_INDEX])
@@ -378,6 +485,23 @@ protected:
 			else {
 				this->Skipped(F("SearchRequest"));
 			}
+#endif
+			break;
+		case Unlinked::ResumeRequest::HEADER:
+			if (payloadSize == Unlinked::ResumeRequest::PAYLOAD_SIZE
+				&& LinkStage == LinkStageEnum::Searching
+				&& IsResumable()
+				&& ResumeTokenMatches(timestamp, &payload[Unlinked::ResumeRequest::PAYLOAD_TOKEN_INDEX]))
+			{
+				// Skip straight to the encrypted switch over, with the cached session.
+				UpdateLinkStage(LinkStageEnum::SwitchingToLinked);
+#if defined(DEBUG_LOLA_LINK)
+				this->Owner();
+				Serial.println(F("Resume request accepted."));
+#endif
+			}
+#if defined(DEBUG_LOLA_LINK)
+			else { this->Skipped(F("ResumeRequest")); }
 #endif
 			break;
 		case Unlinked::LinkingTimedSwitchOverAck::HEADER:
@@ -386,7 +510,6 @@ protected:
 				&& Session.PairingTokenMatches(&payload[Unlinked::LinkingTimedSwitchOverAck::PAYLOAD_SESSION_TOKEN_INDEX])
 				&& SyncSequence == payload[Unlinked::LinkingTimedSwitchOverAck::PAYLOAD_REQUEST_ID_INDEX])
 			{
-				SetReceiveCounter(rollingCounter);	// Save last received counter, ready for switch for next stage.
 				StateTransition.OnReceived();
 				TS::Task::enableDelayed(0);
 
@@ -560,6 +683,24 @@ protected:
 				}
 #if defined(DEBUG_LOLA_LINK)
 				else { this->Skipped(F("ClockTuneRequest")); }
+#endif
+				break;
+			case Linked::RekeyReply::HEADER:
+				if (payloadSize == Linked::RekeyReply::PAYLOAD_SIZE
+					&& RekeyRequesting
+					&& ArrayToUInt32(&payload[Linked::RekeyReply::PAYLOAD_SECOND_INDEX]) == RekeySecond)
+				{
+					RekeyRequesting = false;
+					RekeyStartSecond = RekeySecond;
+					Session.SetRekey(RekeySeed, &payload[Linked::RekeyReply::PAYLOAD_SEED_INDEX], RekeySecond);
+					memset(RekeySeed, 0, LoLaCryptoDefinition::REKEY_SEED_SIZE);
+#if defined(DEBUG_LOLA_LINK)
+					this->Owner();
+					Serial.println(F("Rekey agreed."));
+#endif
+				}
+#if defined(DEBUG_LOLA_LINK)
+				else { this->Skipped(F("RekeyReply")); }
 #endif
 				break;
 			default:
@@ -585,7 +726,24 @@ private:
 			measure *= 3;
 		}
 
-		return GetProgressPriority<RequestPriority::REGULAR, RequestPriority::RESERVED_FOR_LINK>(measure);
+		return BaseClass::template GetProgressPriority<RequestPriority::REGULAR, RequestPriority::RESERVED_FOR_LINK>(measure);
+	}
+
+	/// <summary>
+	/// Client's token is from when it was sent, so the previous second is also accepted.
+	/// </summary>
+	/// <param name="receiveTimestamp"></param>
+	/// <param name="resumeToken"></param>
+	/// <returns>True if the token matches the cached session.</returns>
+	const bool ResumeTokenMatches(const uint32_t receiveTimestamp, const uint8_t* resumeToken)
+	{
+		LOLA_RTOS_PAUSE();
+		SyncClock.GetTimestamp(LinkTimestamp);
+		LinkTimestamp.ShiftSubSeconds(-(int32_t)(micros() - receiveTimestamp));
+		LOLA_RTOS_RESUME();
+
+		return Session.ResumeTokenMatches(LinkTimestamp.Seconds, resumeToken)
+			|| Session.ResumeTokenMatches(LinkTimestamp.Seconds - 1, resumeToken);
 	}
 
 	void NewSession()
@@ -4,24 +4,28 @@
 #define _ABSTRACT_LOLA_RECEIVER_
 
 #include "AbstractLoLaSender.h"
+#include "../../Link/LinkReplayWindow.h"
 
-class AbstractLoLaReceiver : public AbstractLoLaSender
+template<typename SessionType>
+class AbstractLoLaReceiver : public AbstractLoLaSender<SessionType>
 {
 private:
-	using BaseClass = AbstractLoLaSender;
+	using BaseClass = AbstractLoLaSender<SessionType>;
 
-private:
-	// The incoming plaintext content is decrypted to here, from the RawInPacket.
-	uint8_t InData[LoLaPacketDefinition::GetDataSize(LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE)]{};
+protected:
+	using BaseClass::LinkStage;
+	using LinkStageEnum = typename BaseClass::LinkStageEnum;
+	using BaseClass::OnEvent;
+	using BaseClass::RawOutPacket;
+	using BaseClass::Registry;
+	using BaseClass::Session;
+	using BaseClass::SyncClock;
 
 private:
 	Timestamp RxTimestamp{};
 
 private:
-	/// <summary>
-	/// Rolling packet counter.
-	/// </summary>
-	uint16_t ReceiveCounter = 0;
+	LinkReplayWindow ReplayWindow{};
 
 protected:
 	uint16_t ReceivedCounter = 0;
@@ -61,19 +65,22 @@ public:
 
 public:
 	/// <summary>
-	/// RawInPacket packet is validated for:
+	/// Received packet is validated for:
 	/// - Data integrity.
 	/// - Source authenticity.
 	/// - Replay/Echo denied.
-	/// And decoded into InData.
+	/// And decoded in place, so listeners get the payload straight from the receive queue.
+	/// <param name="data">Raw packet from the PacketService receive queue.</param>
 	/// <param name="receiveTimestamp">micros() timestamp of packet start.</param>
 	/// <param name="packetSize"></param>
 	/// <param name="rssi"></param>
-	void OnReceived(const uint32_t receiveTimestamp, const uint8_t packetSize, const uint8_t rssi) final
+	void OnReceived(uint8_t* data, const uint32_t receiveTimestamp, const uint8_t packetSize, const uint8_t rssi) final
 	{
 		const uint8_t receivingDataSize = LoLaPacketDefinition::GetDataSize(packetSize);
+		uint8_t* inData = &data[(uint8_t)LoLaPacketDefinition::IndexEnum::Data];
 
-		uint16_t receivingCounter = 0;
+		uint32_t receivingCounter = 0;
+		uint16_t rollingCounter = 0;
 		uint16_t receivingLost = 0;
 
 		switch (LinkStage)
@@ -86,14 +93,14 @@ public:
 		case LinkStageEnum::SwitchingToLinking:
 			// Update MAC without implicit addressing or token.
 			// Addressing must be explicit in payload.
-			if (Session.DecodeInPacket(RawInPacket, InData, receivingCounter, receivingDataSize))
+			if (Session.DecodeInPacket(data, inData, rollingCounter, receivingDataSize))
 			{
 				// Check for valid port.
-				if (InData[(uint8_t)LoLaPacketDefinition::IndexEnum::Port - (uint8_t)LoLaPacketDefinition::IndexEnum::Data] == LoLaLinkDefinition::LINK_PORT)
+				if (data[(uint8_t)LoLaPacketDefinition::IndexEnum::Port] == LoLaLinkDefinition::LINK_PORT)
 				{
 					OnUnlinkedPacketReceived(receiveTimestamp,
-						&InData[(uint8_t)LoLaPacketDefinition::IndexEnum::Payload - (uint8_t)LoLaPacketDefinition::IndexEnum::Data],
-						receivingCounter,
+						&data[(uint8_t)LoLaPacketDefinition::IndexEnum::Payload],
+						rollingCounter,
 						LoLaPacketDefinition::GetPayloadSize(packetSize));
 				}
 				else
@@ -110,14 +117,15 @@ public:
 		case LinkStageEnum::ClockSyncing:
 		case LinkStageEnum::SwitchingToLinked:
 			// Update MAC with implicit addressing but without token.
-			if (Session.DecodeInPacket(RawInPacket, InData, 0, receivingCounter, receivingDataSize))
+			receivingCounter = GetReceivingCounter(data);
+			if (Session.DecodeInPacket(data, inData, 0, receivingCounter, receivingDataSize))
 			{
 				// Validate counter and check for valid port.
-				if (InData[(uint8_t)LoLaPacketDefinition::IndexEnum::Port - (uint8_t)LoLaPacketDefinition::IndexEnum::Data] == LoLaLinkDefinition::LINK_PORT
-					&& ValidateCounter(receivingCounter, receivingLost))
+				if (data[(uint8_t)LoLaPacketDefinition::IndexEnum::Port] == LoLaLinkDefinition::LINK_PORT
+					&& ReplayWindow.Validate(receivingCounter, receivingLost))
 				{
 					OnLinkingPacketReceived(receiveTimestamp,
-						&InData[(uint8_t)LoLaPacketDefinition::IndexEnum::Payload - (uint8_t)LoLaPacketDefinition::IndexEnum::Data],
+						&data[(uint8_t)LoLaPacketDefinition::IndexEnum::Payload],
 						LoLaPacketDefinition::GetPayloadSize(packetSize));
 
 					OnPacketReceivedOk(rssi, receivingLost);
@@ -137,15 +145,35 @@ public:
 			SyncClock.GetTimestamp(RxTimestamp);
 			RxTimestamp.ShiftSubSeconds(-((int32_t)(micros() - receiveTimestamp)));
 			LOLA_RTOS_RESUME();
-			if (Session.DecodeInPacket(RawInPacket, InData, RxTimestamp.Seconds, receivingCounter, receivingDataSize))
+			receivingCounter = GetReceivingCounter(data);
+			if (!Session.CheckRekey(RxTimestamp.Seconds))
+			{
+				// Next keys aren't ready, wake up the link to finish them.
+				TS::Task::enable();
+			}
+			else if (Session.DecodeInPacket(data, inData, RxTimestamp.Seconds, receivingCounter, receivingDataSize))
 			{
 				// Validate counter and check for valid port.
-				if (ValidateCounter(receivingCounter, receivingLost))
+				if (data[(uint8_t)LoLaPacketDefinition::IndexEnum::Port] == LoLaLinkDefinition::AGGREGATE_PORT
+					&& !ValidateAggregate(&data[(uint8_t)LoLaPacketDefinition::IndexEnum::Payload], LoLaPacketDefinition::GetPayloadSize(packetSize)))
+				{
+					OnEvent(PacketEventEnum::ReceiveRejectedHeader);
+				}
+				else if (ReplayWindow.Validate(receivingCounter, receivingLost))
 				{
-					Registry->NotifyPacketListener(receiveTimestamp,
-						&InData[(uint8_t)LoLaPacketDefinition::IndexEnum::Payload - (uint8_t)LoLaPacketDefinition::IndexEnum::Data],
-						LoLaPacketDefinition::GetPayloadSize(packetSize),
-						InData[(uint8_t)LoLaPacketDefinition::IndexEnum::Port - (uint8_t)LoLaPacketDefinition::IndexEnum::Data]);
+					if (data[(uint8_t)LoLaPacketDefinition::IndexEnum::Port] == LoLaLinkDefinition::AGGREGATE_PORT)
+					{
+						NotifyAggregate(receiveTimestamp,
+							&data[(uint8_t)LoLaPacketDefinition::IndexEnum::Payload],
+							LoLaPacketDefinition::GetPayloadSize(packetSize));
+					}
+					else
+					{
+						Registry->NotifyPacketListener(receiveTimestamp,
+							&data[(uint8_t)LoLaPacketDefinition::IndexEnum::Payload],
+							LoLaPacketDefinition::GetPayloadSize(packetSize),
+							data[(uint8_t)LoLaPacketDefinition::IndexEnum::Port]);
+					}
 
 					ReceivedCounter++;
 					OnPacketReceivedOk(rssi, receivingLost);
@@ -166,48 +194,86 @@ public:
 	}
 
 protected:
-	void SetReceiveCounter(const uint16_t counter)
+	/// <summary>
+	/// The next accepted encrypted packet sets the implicit counter reference,
+	///  its high bits are zero. Partner's send counter must also restart below INT16_MAX.
+	/// </summary>
+	void ResetReceiveCounter()
 	{
-		ReceiveCounter = counter;
+		ReplayWindow.Reset();
 	}
 
 	const bool MockReceiveFailPacket(const uint32_t receiveTimestamp, const uint8_t* data, const uint8_t payloadSize)
 	{
 		const uint8_t packetSize = LoLaPacketDefinition::GetTotalSize(payloadSize);
 
-		uint16_t receivingCounter = 0;
+		const uint32_t receivingCounter = GetReceivingCounter(data);
 
 		SyncClock.GetTimestamp(RxTimestamp);
 		RxTimestamp.ShiftSubSeconds(-((int32_t)(micros() - receiveTimestamp)));
 
 		// (Fail to) Decrypt packet with token based on time.
-		return Session.DecodeInPacket(data, RawInPacket, RxTimestamp.Seconds, receivingCounter, LoLaPacketDefinition::GetDataSize(packetSize));
+		// A rejected packet is never delivered, the out packet buffer is only a placeholder.
+		return Session.DecodeInPacket(data, RawOutPacket, RxTimestamp.Seconds, receivingCounter, LoLaPacketDefinition::GetDataSize(packetSize));
 	}
 
 private:
 	/// <summary>
-	/// Link will tolerate some dropped packets by forwarding the rolling counter.
+	/// Aggregated frame must be fully consumed by well formed service sub-frames.
+	/// Every sub-frame carries at least 1 byte of payload (header).
 	/// </summary>
-	/// <param name="counter">Received counter.</param>
-	/// <param name="receiveLost">Resulting counter roll. [1 ; INT16_MAX] for typical operation, 0 when invalid.</param>
-	/// <returns>True on valid counter.</returns>
-	const bool ValidateCounter(const uint16_t counter, uint16_t& receiveLost)
+	/// <param name="payload">Aggregate payload.</param>
+	/// <param name="payloadSize"></param>
+	/// <returns>True if all sub-frames are valid.</returns>
+	static const bool ValidateAggregate(const uint8_t* payload, const uint8_t payloadSize)
 	{
-		const uint16_t counterRoll = counter - ReceiveCounter;
-		if (counterRoll < (uint16_t)INT16_MAX
-			&& counterRoll > 0
-			)
+		uint8_t offset = 0;
+		while (offset < payloadSize)
 		{
-			// Counter accepted, update local tracker.
-			ReceiveCounter = counter;
-			receiveLost = counterRoll - 1;
-			return true;
+			if (((uint16_t)offset + LoLaLinkDefinition::AGGREGATE_SUB_HEADER_SIZE) > payloadSize
+				|| payload[offset] > LoLaLinkDefinition::MAX_DEFINITION_PORT
+				|| payload[offset + 1] == 0
+				|| ((uint16_t)offset + LoLaLinkDefinition::AGGREGATE_SUB_HEADER_SIZE + payload[offset + 1]) > payloadSize)
+			{
+				return false;
+			}
+			offset += LoLaLinkDefinition::AGGREGATE_SUB_HEADER_SIZE + payload[offset + 1];
 		}
-		else
+
+		return offset > 0;
+	}
+
+	/// <summary>
+	/// Fans out a validated aggregated frame, as if each sub-frame was its own packet.
+	/// </summary>
+	/// <param name="receiveTimestamp"></param>
+	/// <param name="payload">Aggregate payload.</param>
+	/// <param name="payloadSize"></param>
+	void NotifyAggregate(const uint32_t receiveTimestamp, const uint8_t* payload, const uint8_t payloadSize)
+	{
+		uint8_t offset = 0;
+		while (offset < payloadSize)
 		{
-			receiveLost = 0;
-			return false;
+			const uint8_t subSize = payload[offset + 1];
+			Registry->NotifyPacketListener(receiveTimestamp,
+				&payload[offset + LoLaLinkDefinition::AGGREGATE_SUB_HEADER_SIZE],
+				subSize,
+				payload[offset]);
+			offset += LoLaLinkDefinition::AGGREGATE_SUB_HEADER_SIZE + subSize;
 		}
 	}
+
+	/// <summary>
+	/// Extends the packet id with the implicit high bits,
+	///  to the nearest counter from the latest accepted.
+	/// </summary>
+	/// <param name="data">Raw packet.</param>
+	/// <returns>Implicit counter.</returns>
+	const uint32_t GetReceivingCounter(const uint8_t* data) const
+	{
+		const uint16_t id = ((uint16_t)data[(uint8_t)LoLaPacketDefinition::IndexEnum::Id + 1] << 8) | data[(uint8_t)LoLaPacketDefinition::IndexEnum::Id];
+
+		return ReplayWindow.GetReceivingCounter(id);
+	}
 };
 #endif
\ No newline at end of file
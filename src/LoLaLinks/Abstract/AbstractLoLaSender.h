@@ -5,10 +5,20 @@
 
 #include "AbstractLoLa.h"
 
-class AbstractLoLaSender : public AbstractLoLa
+template<typename SessionType>
+class AbstractLoLaSender : public AbstractLoLa<SessionType>
 {
 private:
-	using BaseClass = AbstractLoLa;
+	using BaseClass = AbstractLoLa<SessionType>;
+
+protected:
+	using BaseClass::LinkStage;
+	using LinkStageEnum = typename BaseClass::LinkStageEnum;
+	using BaseClass::PacketService;
+	using BaseClass::RawOutPacket;
+	using BaseClass::Session;
+	using BaseClass::SyncClock;
+	using BaseClass::Transceiver;
 
 private:
 	Timestamp TxTimestamp{};
@@ -19,8 +29,8 @@ private:
 	uint16_t SendShortDurationMicros = 0;
 	uint16_t SendVariableDurationMicros = 0;
 
-	// Rolling counter.
-	uint16_t SendCounter = 0;
+	// Rolling counter, with implicit high bits.
+	uint32_t SendCounter = 0;
 
 protected:
 	uint16_t SentCounter = 0;
@@ -42,6 +52,18 @@ public:
 		return micros() - SentTimestamp;
 	}
 
+	uint8_t* GetSendBuffer() final
+	{
+		return &RawOutPacket[(uint8_t)LoLaPacketDefinition::IndexEnum::Data];
+	}
+
+	/// <summary>
+	/// Encodes data into RawOutPacket and sends it.
+	/// Data from GetSendBuffer() is encoded in place.
+	/// </summary>
+	/// <param name="data">Packet data (port and payload).</param>
+	/// <param name="payloadSize"></param>
+	/// <returns>True on successfull transmission.</returns>
 	const bool SendPacket(const uint8_t* data, const uint8_t payloadSize) final
 	{
 		SyncClock.GetTimestamp(TxTimestamp);
@@ -57,7 +79,7 @@ public:
 		case LinkStageEnum::Pairing:
 		case LinkStageEnum::SwitchingToLinking:
 			// Encode packet with no encryption.
-			Session.EncodeOutPacket(data, RawOutPacket, SendCounter, dataSize);
+			Session.EncodeOutPacket(data, RawOutPacket, (uint16_t)SendCounter, dataSize);
 			break;
 		case LinkStageEnum::Authenticating:
 		case LinkStageEnum::ClockSyncing:
@@ -66,6 +88,14 @@ public:
 			Session.EncodeOutPacket(data, RawOutPacket, 0, SendCounter, dataSize);
 			break;
 		case LinkStageEnum::Linked:
+			// Switch to the next session key, if the rekey is due.
+			if (!Session.CheckRekey(TxTimestamp.Seconds))
+			{
+				// Next keys aren't ready, wake up the link to finish them.
+				TS::Task::enable();
+				return false;
+			}
+
 			// Encrypt packet with token based on time.
 			Session.EncodeOutPacket(data, RawOutPacket, TxTimestamp.Seconds, SendCounter, dataSize);
 			break;
@@ -121,7 +151,7 @@ protected:
 	}
 
 protected:
-	void SetSendCounter(const uint16_t counter)
+	void SetSendCounter(const uint32_t counter)
 	{
 		SendCounter = counter;
 	}
@@ -4,6 +4,7 @@
 #define _LOLA_ADDRESS_MATCH_LINK_CLIENT_
 
 #include "../Abstract/AbstractLoLaLinkClient.h"
+#include "../../Crypto/LoLaCryptoAmSession.h"
 
 /// <summary>
 /// LoLa Address Match Link Client.
@@ -11,15 +12,35 @@
 /// </summary>
 /// <typeparam name="MaxPacketReceiveListeners"></typeparam>
 /// <typeparam name="MaxLinkListeners"></typeparam>
+/// <typeparam name="DirectDispatch">Constant-time packet dispatch, at the cost of a port table.</typeparam>
+/// <typeparam name="RegistryType">Override the listener registry, i.e. StaticLinkRegistry. Ignores the above parameters.</typeparam>
+/// <typeparam name="CryptoBackend">Hasher and cypher policy for the session, see LoLaCryptoBackend.h.</typeparam>
 template<const uint8_t MaxPacketReceiveListeners = 10,
-	const uint8_t MaxLinkListeners = 10>
-class LoLaAddressMatchLinkClient : public AbstractLoLaLinkClient
+	const uint8_t MaxLinkListeners = 10,
+	const bool DirectDispatch = false,
+	typename RegistryType = LinkRegistry<MaxPacketReceiveListeners, MaxLinkListeners, DirectDispatch>,
+	typename CryptoBackend = LoLaCryptoDefaultBackend>
+class LoLaAddressMatchLinkClient : public AbstractLoLaLinkClient<LoLaCryptoAmSession<CryptoBackend>>
 {
 private:
-	using BaseClass = AbstractLoLaLinkClient;
+	using BaseClass = AbstractLoLaLinkClient<LoLaCryptoAmSession<CryptoBackend>>;
+
+public:
+	using BaseClass::SendPacket;
+
+protected:
+	using BaseClass::IsResumable;
+	using BaseClass::LinkStage;
+	using LinkStageEnum = typename BaseClass::LinkStageEnum;
+	using BaseClass::OnLinkSyncReceived;
+	using BaseClass::OutPacket;
+	using BaseClass::PacketService;
+	using BaseClass::Session;
+	using BaseClass::UnlinkedDuplexCanSend;
+	using BaseClass::UnlinkedPacketThrottle;
 
 private:
-	LinkRegistry<MaxPacketReceiveListeners, MaxLinkListeners> RegistryInstance{};
+	RegistryType RegistryInstance{};
 
 public:
 	LoLaAddressMatchLinkClient(TS::Scheduler& scheduler,
@@ -31,6 +52,14 @@ public:
 		: BaseClass(scheduler, &RegistryInstance, transceiver, cycles, entropy, duplex, hop)
 	{}
 
+	/// <summary>
+	/// For registries that bind their services directly, i.e. StaticLinkRegistry::Attach.
+	/// </summary>
+	RegistryType& GetRegistry()
+	{
+		return RegistryInstance;
+	}
+
 	const bool Setup(const uint8_t localAddress[LoLaLinkDefinition::PUBLIC_ADDRESS_SIZE],
 		const uint8_t accessPassword[LoLaLinkDefinition::ACCESS_CONTROL_PASSWORD_SIZE],
 		const uint8_t secretKey[LoLaLinkDefinition::SECRET_KEY_SIZE])
@@ -157,6 +186,11 @@ protected:
 		switch (linkStage)
 		{
 		case LinkStageEnum::Searching:
+			if (!IsResumable())
+			{
+				Session.ResetAm();
+			}
+			break;
 		case LinkStageEnum::Pairing:
 			Session.ResetAm();
 			break;
@@ -12,15 +12,33 @@
 /// </summary>
 /// <typeparam name="MaxPacketReceiveListeners"></typeparam>
 /// <typeparam name="MaxLinkListeners"></typeparam>
+/// <typeparam name="DirectDispatch">Constant-time packet dispatch, at the cost of a port table.</typeparam>
+/// <typeparam name="RegistryType">Override the listener registry, i.e. StaticLinkRegistry. Ignores the above parameters.</typeparam>
+/// <typeparam name="CryptoBackend">Hasher and cypher policy for the session, see LoLaCryptoBackend.h.</typeparam>
 template<const uint8_t MaxPacketReceiveListeners = 10,
-	const uint8_t MaxLinkListeners = 10>
-class LoLaAddressMatchLinkServer : public AbstractLoLaLinkServer
+	const uint8_t MaxLinkListeners = 10,
+	const bool DirectDispatch = false,
+	typename RegistryType = LinkRegistry<MaxPacketReceiveListeners, MaxLinkListeners, DirectDispatch>,
+	typename CryptoBackend = LoLaCryptoDefaultBackend>
+class LoLaAddressMatchLinkServer : public AbstractLoLaLinkServer<LoLaCryptoAmSession<CryptoBackend>>
 {
 private:
-	using BaseClass = AbstractLoLaLinkServer;
+	using BaseClass = AbstractLoLaLinkServer<LoLaCryptoAmSession<CryptoBackend>>;
+
+public:
+	using BaseClass::SendPacket;
+
+protected:
+	using BaseClass::IsResumable;
+	using BaseClass::LinkStage;
+	using LinkStageEnum = typename BaseClass::LinkStageEnum;
+	using BaseClass::OutPacket;
+	using BaseClass::PacketService;
+	using BaseClass::Session;
+	using BaseClass::UnlinkedDuplexCanSend;
 
 private:
-	LinkRegistry<MaxPacketReceiveListeners, MaxLinkListeners> RegistryInstance{};
+	RegistryType RegistryInstance{};
 
 	bool AmReplyPending = false;
 
@@ -34,6 +52,14 @@ public:
 		: BaseClass(scheduler, &RegistryInstance, transceiver, cycles, entropy, duplex, hop)
 	{}
 
+	/// <summary>
+	/// For registries that bind their services directly, i.e. StaticLinkRegistry::Attach.
+	/// </summary>
+	RegistryType& GetRegistry()
+	{
+		return RegistryInstance;
+	}
+
 	const bool Setup(const uint8_t localAddress[LoLaLinkDefinition::PUBLIC_ADDRESS_SIZE],
 		const uint8_t accessPassword[LoLaLinkDefinition::ACCESS_CONTROL_PASSWORD_SIZE],
 		const uint8_t secretKey[LoLaLinkDefinition::SECRET_KEY_SIZE])
@@ -96,7 +122,7 @@ protected:
 		{
 		case Unlinked::AmSessionRequest::HEADER:
 			if (payloadSize == Unlinked::AmSessionRequest::PAYLOAD_SIZE
-				&& !Session.HasPartner())
+				&& (!Session.HasPartner() || LinkStage == LinkStageEnum::Searching))
 			{
 				switch (LinkStage)
 				{
@@ -156,6 +182,11 @@ protected:
 		switch (linkStage)
 		{
 		case LinkStageEnum::Searching:
+			if (!IsResumable())
+			{
+				Session.ResetAm();
+			}
+			break;
 		case LinkStageEnum::Pairing:
 			Session.ResetAm();
 			break;
@@ -28,6 +28,8 @@ class EspNowTransceiver final
 private:
 	static constexpr uint16_t TRANSCEIVER_ID = 0x3403;
 
+	static_assert(LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE <= ESP_NOW_MAX_DATA_LEN, "ESP-NOW can't carry LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE.");
+
 	static constexpr uint8_t ChannelCount = 15;
 
 	static constexpr uint8_t CHANNEL = ChannelCount / 2;
@@ -29,6 +29,12 @@ class EspNowTransceiver final
 private:
 	static constexpr uint16_t TRANSCEIVER_ID = 0x3403;
 
+	/// <summary>
+	/// ESP-NOW frame limit.
+	/// </summary>
+	static constexpr uint8_t ESP_NOW_MAX_PACKET_SIZE = 250;
+	static_assert(LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE <= ESP_NOW_MAX_PACKET_SIZE, "ESP-NOW can't carry LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE.");
+
 	static constexpr uint8_t CHANNEL = 0;
 	static constexpr uint8_t ChannelCount = 13;
 
@@ -153,7 +159,7 @@ public:
 	{
 		Listener = listener;
 
-		return Listener != nullptr;//&& LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE <= ESP_NOW_MAX_DATA_LEN;
+		return Listener != nullptr;
 	}
 
 	virtual const bool Start() final
@@ -3,7 +3,7 @@
 #ifndef _I_LOLA_TRANSCEIVER_h
 #define _I_LOLA_TRANSCEIVER_h
 
-#include "Link\LoLaPacketDefinition.h"
+#include "Link/LoLaPacketDefinition.h"
 
 class ILoLaTransceiverListener
 {
@@ -18,6 +18,24 @@ public:
 	/// <returns>True if packet was successfully consumed. False, try again later.</returns>
 	virtual const bool OnRx(const uint8_t* data, const uint32_t timestamp, const uint8_t packetSize, const uint8_t rssi) { return false; }
 
+	/// <summary>
+	/// Zero-copy receive.
+	/// Lends a free link-owned buffer, for the transceiver to read the next packet straight into.
+	/// The buffer is only committed by OnRxBuffer().
+	/// </summary>
+	/// <returns>Buffer of MAX_PACKET_TOTAL_SIZE bytes. nullptr if none is free, fall back to OnRx() or drop.</returns>
+	virtual uint8_t* GetRxBuffer() { return nullptr; }
+
+	/// <summary>
+	/// Zero-copy receive.
+	/// The buffer from the last GetRxBuffer() holds a received packet.
+	/// </summary>
+	/// <param name="receiveTimestamp">Accurate timestamp (micros()) of incoming packet start.</param>
+	/// <param name="packetSize">[MIN_PACKET_SIZE;MAX_PACKET_TOTAL_SIZE]</param>
+	/// <param name="rssi">Normalized RX RSSI [0;255].</param>
+	/// <returns>True if packet was successfully consumed.</returns>
+	virtual const bool OnRxBuffer(const uint32_t timestamp, const uint8_t packetSize, const uint8_t rssi) { return false; }
+
 	/// <summary>
 	/// Transceiver has finished transmitting a packet.
 	/// </summary>
@@ -32,12 +32,26 @@ class Si446xAbstractTransceiver
 private:
 	using BaseClass = Si446xRadioDriver<LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE, pinCS, pinSDN, pinInterrupt>;
 
+	/// <summary>
+	/// Si446x hardware FIFO size, with the variable length byte.
+	/// Packets are written and read whole, there's no FIFO refill.
+	/// </summary>
+	static constexpr uint8_t SI446X_FIFO_SIZE = 64;
+	static_assert(LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE <= (SI446X_FIFO_SIZE - 1), "Si446x FIFO can't carry LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE.");
+
 	static constexpr uint32_t TRANSCEIVER_CODE = (uint32_t)RadioConfig::TRANSCEIVER_ID << 16
 		| (uint32_t)RadioConfig::ChannelCount << 8
 		| ((uint32_t)(RadioConfig::BaseFrequency / 10000000) + (uint32_t)(RadioConfig::BitRate / 10000));
 
 	static constexpr uint8_t CalibrationSamples = 5;
 
+	/// <summary>
+	/// RadioConfig::TTRX_LONG is measured with a default size packet, scaled for the configured max packet size.
+	/// </summary>
+	static constexpr uint16_t TTRX_MAX = RadioConfig::TTRX_SHORT
+		+ ((((uint32_t)RadioConfig::TTRX_LONG - RadioConfig::TTRX_SHORT) * (LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE - LoLaPacketDefinition::MIN_PACKET_SIZE))
+			/ (LoLaPacketDefinition::DEFAULT_PACKET_TOTAL_SIZE - LoLaPacketDefinition::MIN_PACKET_SIZE));
+
 
 private:
 	ILoLaTransceiverListener* Listener = nullptr;
@@ -196,7 +210,7 @@ public:
 
 	virtual const uint16_t GetDurationInAir(const uint8_t packetSize) final
 	{
-		return (RadioConfig::TTRX_SHORT - TxDurationBase) + ((((uint32_t)(packetSize - LoLaPacketDefinition::MIN_PACKET_SIZE)) * ((RadioConfig::TTRX_LONG - RadioConfig::TTRX_SHORT) - TxDurationRange)) / (LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE - LoLaPacketDefinition::MIN_PACKET_SIZE));
+		return (RadioConfig::TTRX_SHORT - TxDurationBase) + ((((uint32_t)(packetSize - LoLaPacketDefinition::MIN_PACKET_SIZE)) * ((TTRX_MAX - RadioConfig::TTRX_SHORT) - TxDurationRange)) / (LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE - LoLaPacketDefinition::MIN_PACKET_SIZE));
 	}
 
 	const uint8_t GetChannelCount() final
@@ -285,7 +299,7 @@ private:
 
 
 		if (txShort >= RadioConfig::TTRX_SHORT
-			|| txLong >= RadioConfig::TTRX_LONG
+			|| txLong >= TTRX_MAX
 			|| txLong <= txShort)
 		{
 			return false;
@@ -46,6 +46,7 @@ private:
 	static constexpr uint8_t Delimiter = 0;
 
 	static constexpr uint8_t COBS_OVERHEAD = 1;
+	static_assert(LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE <= (UINT8_MAX - COBS_OVERHEAD - 2), "UART frame can't carry LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE.");
 	static constexpr uint8_t MAX_COBS_SIZE = LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE + COBS_OVERHEAD;
 
 	static constexpr uint8_t GetFrameSize(const uint8_t packetSize)
@@ -61,9 +62,17 @@ private:
 	static constexpr uint32_t REFERENCE_SHORT = 8230;
 	static constexpr uint16_t REFERENCE_BAUD_RATE = 9600;
 
+	/// <summary>
+	/// REFERENCE_LONG was measured with this packet size, scaled for the configured max packet size.
+	/// </summary>
+	static constexpr uint8_t REFERENCE_LONG_SIZE = LoLaPacketDefinition::DEFAULT_PACKET_TOTAL_SIZE;
+	static constexpr uint32_t REFERENCE_MAX = REFERENCE_SHORT
+		+ (((REFERENCE_LONG - REFERENCE_SHORT) * (LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE - LoLaPacketDefinition::MIN_PACKET_SIZE))
+			/ (REFERENCE_LONG_SIZE - LoLaPacketDefinition::MIN_PACKET_SIZE));
+
 private:
 	static constexpr uint16_t DurationShort = (uint32_t)((REFERENCE_SHORT * REFERENCE_BAUD_RATE) / BaudRate);
-	static constexpr uint16_t DurationLong = (uint32_t)((REFERENCE_LONG * REFERENCE_BAUD_RATE) / BaudRate);
+	static constexpr uint16_t DurationLong = (uint32_t)((REFERENCE_MAX * REFERENCE_BAUD_RATE) / BaudRate);
 	static constexpr uint16_t DurationRange = DurationLong - DurationShort;
 
 	static constexpr uint16_t ByteDuration = (DurationLong / LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE);
@@ -5,6 +5,34 @@
 
 #include <stdint.h>
 
+#if defined(LOLA_HOST_PLATFORM)
+#include <Arduino.h>
+// Virtual time hint: the next simulated PHY event, so the host scheduler can skip ahead to it.
+#define VIRTUAL_TRANSCEIVER_WAKE(timestamp)	HostClock::RequestWake(timestamp)
+#else
+#define VIRTUAL_TRANSCEIVER_WAKE(timestamp)	((void)0)
+#endif
+
+class IVirtualTransceiver;
+
+/// <summary>
+/// Shared simulated RF medium, for any number of IVirtualTransceiver.
+/// Transceivers report their air time, the medium decides who hears what.
+/// </summary>
+class IVirtualMedium
+{
+public:
+	/// <summary>
+	/// Sender has started radiating on channel.
+	/// </summary>
+	virtual void OnAirStart(IVirtualTransceiver* sender, const uint8_t channel) {}
+
+	/// <summary>
+	/// Sender has finished radiating, packet is distributed to listening transceivers.
+	/// </summary>
+	virtual void OnAirEnd(IVirtualTransceiver* sender, const uint8_t* data, const uint32_t txTimestamp, const uint8_t size, const uint8_t channel) {}
+};
+
 class IVirtualTransceiver
 {
 public:
@@ -25,7 +53,16 @@ public:
 	};
 
 public:
+	/// <summary>
+	/// Point-to-point, no collisions or attenuation.
+	/// </summary>
 	virtual void SetPartner(IVirtualTransceiver* partner) {}
-	virtual void ReceivePacket(const uint8_t* data, const uint32_t txTimestamp, const uint8_t size, const uint8_t channel) { }
+
+	/// <summary>
+	/// Shared medium, replaces the partner.
+	/// </summary>
+	virtual void SetMedium(IVirtualMedium* medium) {}
+
+	virtual void ReceivePacket(const uint8_t* data, const uint32_t txTimestamp, const uint8_t size, const uint8_t channel, const uint8_t rssi) { }
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,279 @@
+// VirtualMedium.h
+
+#ifndef _VIRTUAL_MEDIUM_h
+#define _VIRTUAL_MEDIUM_h
+
+#include <Arduino.h>
+#include "IVirtualTransceiver.h"
+
+/// <summary>
+/// Shared simulated RF medium, for multiple VirtualTransceivers in the same room.
+/// Tracks per-channel occupancy and detects overlapping transmissions,
+/// with per-pair attenuation deciding who hears (and who is jammed by) whom.
+/// Packets are delivered when the sender's air time ends.
+/// </summary>
+/// <typeparam name="Config">IVirtualTransceiver::Configuration: shared by all attached transceivers.</typeparam>
+/// <typeparam name="MaxNodes">How many transceivers can be attached.</typeparam>
+template<typename Config,
+	const uint8_t MaxNodes>
+class VirtualMedium final : public virtual IVirtualMedium
+{
+public:
+	/// <summary>
+	/// Out of range, no reception and no interference.
+	/// </summary>
+	static constexpr uint8_t ATTENUATION_OUT_OF_RANGE = UINT8_MAX;
+
+	/// <summary>
+	/// Capture effect: a packet survives interference if it is this much stronger.
+	/// </summary>
+	static constexpr uint8_t CAPTURE_RSSI_MARGIN = UINT8_MAX / 8;
+
+	/// <summary>
+	/// AirMicros: total air time on channel.
+	/// TxCount: transmissions on channel.
+	/// CollisionCount: transmissions that were jammed on at least one (in range) receiver.
+	/// </summary>
+	struct ChannelStatsStruct
+	{
+		uint32_t AirMicros = 0;
+		uint32_t TxCount = 0;
+		uint32_t CollisionCount = 0;
+	};
+
+private:
+	struct NodeStruct
+	{
+		IVirtualTransceiver* Transceiver = nullptr;
+		uint32_t AirStart = 0;
+		uint32_t AirEnd = 0;
+		uint8_t Channel = 0;
+		bool InAir = false;
+		bool HasAired = false;
+	};
+
+private:
+	NodeStruct Nodes[MaxNodes]{};
+
+	uint8_t Attenuation[MaxNodes][MaxNodes]{};
+
+	ChannelStatsStruct ChannelStats[Config::ChannelCount]{};
+
+	uint8_t NodeCount = 0;
+
+public:
+	VirtualMedium()
+		: IVirtualMedium()
+	{}
+
+	/// <summary>
+	/// Attach a transceiver to the medium, replacing any point-to-point partner.
+	/// </summary>
+	/// <param name="transceiver"></param>
+	/// <returns>True if attached. False if full or null.</returns>
+	const bool Attach(IVirtualTransceiver* transceiver)
+	{
+		if (transceiver == nullptr
+			|| NodeCount >= MaxNodes
+			|| GetNodeIndex(transceiver) < MaxNodes)
+		{
+			return false;
+		}
+
+		Nodes[NodeCount].Transceiver = transceiver;
+		NodeCount++;
+
+		transceiver->SetPartner(nullptr);
+		transceiver->SetMedium(this);
+
+		return true;
+	}
+
+	/// <summary>
+	/// Symmetric attenuation between two attached transceivers.
+	/// </summary>
+	/// <param name="attenuation">RSSI loss [0;UINT8_MAX]. ATTENUATION_OUT_OF_RANGE for no contact.</param>
+	/// <returns>True if both transceivers are attached.</returns>
+	const bool SetAttenuation(IVirtualTransceiver* a, IVirtualTransceiver* b, const uint8_t attenuation)
+	{
+		const uint8_t indexA = GetNodeIndex(a);
+		const uint8_t indexB = GetNodeIndex(b);
+
+		if (indexA < MaxNodes && indexB < MaxNodes)
+		{
+			Attenuation[indexA][indexB] = attenuation;
+			Attenuation[indexB][indexA] = attenuation;
+
+			return true;
+		}
+
+		return false;
+	}
+
+	const ChannelStatsStruct& GetChannelStats(const uint8_t channel) const
+	{
+		return ChannelStats[channel % Config::ChannelCount];
+	}
+
+	void ClearStats()
+	{
+		for (uint_fast8_t i = 0; i < Config::ChannelCount; i++)
+		{
+			ChannelStats[i] = ChannelStatsStruct{};
+		}
+	}
+
+	/// <summary>
+	/// Log per-channel occupancy, as air time over the elapsed duration.
+	/// </summary>
+	/// <param name="serial"></param>
+	/// <param name="elapsedMicros">Duration since the stats were cleared.</param>
+	void LogStats(Print& serial, const uint32_t elapsedMicros)
+	{
+		for (uint_fast8_t i = 0; i < Config::ChannelCount; i++)
+		{
+			serial.print(F("\tCh "));
+			serial.print(i);
+			serial.print(F("\tTx "));
+			serial.print(ChannelStats[i].TxCount);
+			serial.print(F("\tCollisions "));
+			serial.print(ChannelStats[i].CollisionCount);
+			serial.print(F("\tOccupancy "));
+			if (elapsedMicros > 0)
+			{
+				serial.print((uint32_t)(((uint64_t)ChannelStats[i].AirMicros * 1000) / elapsedMicros));
+			}
+			else
+			{
+				serial.print(0);
+			}
+			serial.println(F(" %o"));
+		}
+	}
+
+public:
+	void OnAirStart(IVirtualTransceiver* sender, const uint8_t channel) final
+	{
+		const uint8_t index = GetNodeIndex(sender);
+
+		if (index < MaxNodes)
+		{
+			Nodes[index].AirStart = micros();
+			Nodes[index].Channel = channel;
+			Nodes[index].InAir = true;
+			Nodes[index].HasAired = true;
+		}
+	}
+
+	void OnAirEnd(IVirtualTransceiver* sender, const uint8_t* data, const uint32_t txTimestamp, const uint8_t size, const uint8_t channel) final
+	{
+		const uint8_t index = GetNodeIndex(sender);
+
+		if (index >= MaxNodes
+			|| !Nodes[index].InAir)
+		{
+			return;
+		}
+
+		const uint32_t timestamp = micros();
+		const uint32_t airDuration = timestamp - Nodes[index].AirStart;
+		Nodes[index].AirEnd = timestamp;
+		Nodes[index].InAir = false;
+
+		ChannelStatsStruct& stats = ChannelStats[channel % Config::ChannelCount];
+		stats.AirMicros += airDuration;
+		stats.TxCount++;
+
+		bool collided = false;
+		for (uint_fast8_t receiver = 0; receiver < NodeCount; receiver++)
+		{
+			if (receiver == index
+				|| Attenuation[index][receiver] == ATTENUATION_OUT_OF_RANGE)
+			{
+				continue;
+			}
+
+			// Half-duplex, a transceiver can't hear while it was transmitting.
+			if (Overlaps(receiver, timestamp, airDuration))
+			{
+				continue;
+			}
+
+			const uint8_t rssi = UINT8_MAX - Attenuation[index][receiver];
+
+			if (IsJammed(index, receiver, rssi, channel, timestamp, airDuration))
+			{
+				collided = true;
+			}
+			else
+			{
+				Nodes[receiver].Transceiver->ReceivePacket(data, txTimestamp, size, channel, rssi);
+			}
+		}
+
+		if (collided)
+		{
+			stats.CollisionCount++;
+		}
+	}
+
+private:
+	/// <summary>
+	/// Any other audible transmission on the same channel, overlapping the packet's air time,
+	/// and not weak enough for the capture effect.
+	/// </summary>
+	const bool IsJammed(const uint8_t sender, const uint8_t receiver, const uint8_t rssi, const uint8_t channel, const uint32_t airEnd, const uint32_t airDuration)
+	{
+		for (uint_fast8_t i = 0; i < NodeCount; i++)
+		{
+			if (i != sender
+				&& i != receiver
+				&& Nodes[i].Channel == channel
+				&& Attenuation[i][receiver] != ATTENUATION_OUT_OF_RANGE
+				&& Overlaps(i, airEnd, airDuration))
+			{
+				const uint8_t interferenceRssi = UINT8_MAX - Attenuation[i][receiver];
+
+				if (rssi < CAPTURE_RSSI_MARGIN
+					|| (rssi - CAPTURE_RSSI_MARGIN) < interferenceRssi)
+				{
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	/// <summary>
+	/// Node's last transmission overlaps the window that ends at airEnd.
+	/// </summary>
+	const bool Overlaps(const uint8_t index, const uint32_t airEnd, const uint32_t airDuration) const
+	{
+		if (!Nodes[index].HasAired)
+		{
+			return false;
+		}
+
+		if (Nodes[index].InAir)
+		{
+			return true;
+		}
+
+		return (airEnd - Nodes[index].AirEnd) < airDuration;
+	}
+
+	const uint8_t GetNodeIndex(IVirtualTransceiver* transceiver) const
+	{
+		for (uint_fast8_t i = 0; i < NodeCount; i++)
+		{
+			if (Nodes[i].Transceiver == transceiver)
+			{
+				return i;
+			}
+		}
+
+		return UINT8_MAX;
+	}
+};
+#endif
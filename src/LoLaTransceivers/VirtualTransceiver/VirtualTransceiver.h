@@ -12,7 +12,7 @@
 /// <summary>
 /// Virtual Packet Transceiver.
 /// Provides a double-buffered simulated PHY, for LoLaLinks.
-/// Can send and transmit to IVirtualTransceiver partner.
+/// Can send and transmit to IVirtualTransceiver partner, or through a shared IVirtualMedium.
 /// </summary>
 /// <typeparam name="Config">IVirtualTransceiver::Configuration: Simulated PHY characteristics.</typeparam>
 /// <typeparam name="OnwerName">Indentifier for debug logging.</typeparam>
@@ -102,6 +102,7 @@ private:
 
 private:
 	IVirtualTransceiver* Partner = nullptr;
+	IVirtualMedium* Medium = nullptr;
 
 
 private:
@@ -113,6 +114,7 @@ private:
 	uint32_t LastOut = 0;
 
 	uint8_t CurrentChannel = 0;
+	uint8_t IncomingRssi = 0;
 
 	bool DriverEnabled = false;
 
@@ -147,6 +149,9 @@ public:
 public:
 	bool Callback() final
 	{
+		// Only simulated events count as work, waiting for one doesn't.
+		bool processed = false;
+
 		// Simulate transmit delay, from request to on-air start.
 		if (OutGoing.HasPending())
 		{
@@ -161,6 +166,7 @@ public:
 				if (!OutGoing.AirStarted)
 				{
 					OutGoing.AirStarted = true;
+					processed = true;
 
 #if defined(ECO_CHANCE)
 					if (RollDice(ECO_CHANCE))
@@ -169,27 +175,40 @@ public:
 						PrintName();
 						Serial.println(F("Echo attack!"));
 #endif
-						ReceivePacket(OutGoing.Buffer, micros(), OutGoing.Size, CurrentChannel);
+						ReceivePacket(OutGoing.Buffer, micros(), OutGoing.Size, CurrentChannel, GetRxRssi());
 					}
 #endif
 
 #if defined(DOUBLE_SEND_CHANCE)
-					if (RollDice(DOUBLE_SEND_CHANCE))
+					if (Partner != nullptr && RollDice(DOUBLE_SEND_CHANCE))
 					{
 #if defined(DEBUG_LOLA_LINK)
 						PrintName();
 						Serial.println(F("Double send attack!"));
 #endif
-						Partner->ReceivePacket(OutGoing.Buffer, micros(), OutGoing.Size, CurrentChannel);
+						Partner->ReceivePacket(OutGoing.Buffer, micros(), OutGoing.Size, CurrentChannel, GetRxRssi());
 					}
 #endif
-					Partner->ReceivePacket(OutGoing.Buffer, OutGoing.StartTimestamp, OutGoing.Size, OutGoing.Channel);
+					if (Medium != nullptr)
+					{
+						// Medium distributes the packet when the air time ends.
+						Medium->OnAirStart(this, OutGoing.Channel);
+					}
+					else if (Partner != nullptr)
+					{
+						Partner->ReceivePacket(OutGoing.Buffer, OutGoing.StartTimestamp, OutGoing.Size, OutGoing.Channel, GetRxRssi());
+					}
 #if defined(PRINT_PACKETS)
 					PrintPacket(OutGoing.Buffer, OutGoing.Size);
 #endif
 				}
 				else if ((micros() - OutGoing.StartTimestamp) > GetTimeToAir(OutGoing.Size) + GetDurationInAir(OutGoing.Size))
 				{
+					if (Medium != nullptr)
+					{
+						Medium->OnAirEnd(this, OutGoing.Buffer, OutGoing.StartTimestamp, OutGoing.Size, OutGoing.Channel);
+					}
+
 					// After TX, TX channel is the current internal channel.
 					if (Listener != nullptr)
 					{
@@ -198,16 +217,28 @@ public:
 					TS::Task::enable();
 					OutGoing.Clear();
 					LastOut = micros();
+					processed = true;
 				}
 			}
 		}
 
 		// Simulate delay from start event to received packet buffer.
-		else if (Incoming.HasPending() && ((micros() - Incoming.StartTimestamp) >= GetDurationInAir(Incoming.Size)))
+		// Incoming start is the partner's Tx request, so the air ends after both TimeToAir and DurationInAir.
+		else if (Incoming.HasPending() && ((micros() - Incoming.StartTimestamp) >= (uint32_t)GetTimeToAir(Incoming.Size) + GetDurationInAir(Incoming.Size)))
 		{
 			// Rx duration has elapsed since the packet incoming start triggered.
 			if (Listener != nullptr)
 			{
+#if defined(FADE_PERIOD_MILLIS) && defined(FADE_DURATION_MILLIS)
+				if (IsFading())
+				{
+#if defined(DEBUG_LOLA_LINK)
+					PrintName();
+					Serial.println(F("Fade drop!"));
+#endif
+				}
+				else
+#endif
 #if defined(DROP_CHANCE)
 				if (RollDice(DROP_CHANCE))
 				{
@@ -218,22 +249,41 @@ public:
 				}
 				else
 #endif
-					if (!Listener->OnRx(Incoming.Buffer, Incoming.StartTimestamp, Incoming.Size, GetRxRssi()))
+				{
+					// Zero-copy: "read" the packet straight into the link's receive buffer.
+					uint8_t* buffer = Listener->GetRxBuffer();
+					if (buffer == nullptr
+						|| Incoming.Size > LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE)
 					{
 #if defined(DEBUG_LOLA_LINK)
 						PrintName();
 						Serial.println(F("Rx Collision. Packet rejected."));
 #endif
 					}
+					else
+					{
+						memcpy(buffer, Incoming.Buffer, Incoming.Size);
+						Listener->OnRxBuffer(Incoming.StartTimestamp, Incoming.Size, IncomingRssi);
+					}
+				}
 			}
 			Incoming.Clear();
+			processed = true;
 		}
 
 		if (OutGoing.HasPending())
 		{
+			if (OutGoing.AirStarted)
+			{
+				VIRTUAL_TRANSCEIVER_WAKE(OutGoing.StartTimestamp + GetTimeToAir(OutGoing.Size) + GetDurationInAir(OutGoing.Size) + 1);
+			}
+			else
+			{
+				VIRTUAL_TRANSCEIVER_WAKE(OutGoing.StartTimestamp + GetTimeToAir(OutGoing.Size));
+			}
 			TS::Task::enable();
 
-			return true;
+			return processed;
 		}
 
 		if (HopRequest.HasPending())
@@ -241,21 +291,27 @@ public:
 			if ((micros() - HopRequest.StartTimestamp) >= Config::HopMicros)
 			{
 				HopRequest.Clear();
+				processed = true;
+			}
+			else
+			{
+				VIRTUAL_TRANSCEIVER_WAKE(HopRequest.StartTimestamp + Config::HopMicros);
 			}
 			TS::Task::enable();
 
-			return true;
+			return processed;
 		}
 		else if (Incoming.HasPending())
 		{
+			VIRTUAL_TRANSCEIVER_WAKE(Incoming.StartTimestamp + GetTimeToAir(Incoming.Size) + GetDurationInAir(Incoming.Size));
 			TS::Task::enable();
 
-			return true;
+			return processed;
 		}
 		else
 		{
 			TS::Task::disable();
-			return false;
+			return processed;
 		}
 	}
 
@@ -397,7 +453,12 @@ public:
 		Partner = partner;
 	}
 
-	void ReceivePacket(const uint8_t* data, const uint32_t txTimestamp, const uint8_t packetSize, const uint8_t channel) final
+	void SetMedium(IVirtualMedium* medium) final
+	{
+		Medium = medium;
+	}
+
+	void ReceivePacket(const uint8_t* data, const uint32_t txTimestamp, const uint8_t packetSize, const uint8_t channel, const uint8_t rssi) final
 	{
 		if (HopRequest.HasPending() && ((micros() - HopRequest.StartTimestamp) < Config::HopMicros))
 		{
@@ -440,6 +501,7 @@ public:
 
 		Incoming.Size = packetSize;
 		Incoming.StartTimestamp = txTimestamp;
+		IncomingRssi = rssi;
 		memcpy(Incoming.Buffer, data, packetSize);
 
 #if defined(CORRUPT_CHANCE)
@@ -509,5 +571,15 @@ private:
 	{
 		return random(200) <= (long)chance;
 	}
+
+#if defined(FADE_PERIOD_MILLIS) && defined(FADE_DURATION_MILLIS)
+	/// <summary>
+	/// Simulated obstruction, all packets are lost at the end of every fade period.
+	/// </summary>
+	static const bool IsFading()
+	{
+		return (millis() % FADE_PERIOD_MILLIS) >= (FADE_PERIOD_MILLIS - FADE_DURATION_MILLIS);
+	}
+#endif
 };
 #endif
\ No newline at end of file
@@ -42,6 +42,12 @@ class nRF24Transceiver final
 private:
 	static constexpr uint32_t EVENT_TIMEOUT_MILLIS = 10;
 
+	/// <summary>
+	/// nRF24 hardware FIFO payload size.
+	/// </summary>
+	static constexpr uint8_t NRF24_MAX_PACKET_SIZE = 32;
+	static_assert(LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE <= NRF24_MAX_PACKET_SIZE, "nRF24 can't carry LoLaPacketDefinition::MAX_PACKET_TOTAL_SIZE.");
+
 	// The used timings' constants, based on baudrate.
 	// Used to estimate Tx duration and Rx compensation.
 	static constexpr uint16_t TX_DELAY_MIN = nRF24Support::NRF_TIMINGS[DataRate].TxDelayMin;
@@ -302,11 +308,20 @@ public:
 						RssiHistory |= 1; // Received power > -64 dBm.
 					}
 
-					// Read packet from radio to InBuffer.
-					Radio.read(InBuffer, packetSize);
-
 					// Rx Interrupt only occurs when packet has been fully received, so the timestamp must be compensated with RxDelay.
-					Listener->OnRx(InBuffer, PacketEvent.Timestamp - GetRxDelay(packetSize), packetSize, GetRxRssi());
+					uint8_t* buffer = Listener->GetRxBuffer();
+					if (buffer != nullptr)
+					{
+						// Zero-copy: read packet from radio straight into the link's receive buffer.
+						Radio.read(buffer, packetSize);
+						Listener->OnRxBuffer(PacketEvent.Timestamp - GetRxDelay(packetSize), packetSize, GetRxRssi());
+					}
+					else
+					{
+						// Read packet from radio to InBuffer.
+						Radio.read(InBuffer, packetSize);
+						Listener->OnRx(InBuffer, PacketEvent.Timestamp - GetRxDelay(packetSize), packetSize, GetRxRssi());
+					}
 				}
 				else
 				{
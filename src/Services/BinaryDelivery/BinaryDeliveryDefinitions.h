@@ -3,7 +3,7 @@
 #ifndef _BINARY_DELIVERY_DEFINITIONS_h
 #define _BINARY_DELIVERY_DEFINITIONS_h
 
-#include "..\..\LoLaLink\LoLaPacketDefinition.h"
+#include "../../LoLaLink/LoLaPacketDefinition.h"
 #include <IBinaryDelivery.h>
 
 
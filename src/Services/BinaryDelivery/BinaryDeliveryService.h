@@ -3,8 +3,8 @@
 #ifndef _ABSTRACT_STREAM_h
 #define _ABSTRACT_STREAM_h
 
-#include "..\..\Services\AbstractLoLaDiscoveryService.h"
-#include "..\..\LoLaLink\LoLaPacketDefinition.h"
+#include "../../Services/AbstractLoLaDiscoveryService.h"
+#include "../../LoLaLink/LoLaPacketDefinition.h"
 #include <IBinaryDelivery.h>
 #include "BinaryDeliveryDefinitions.h"
 
@@ -21,15 +21,17 @@ using namespace DiscoveryDefinitions;
 /// <typeparam name="ServiceId">Unique service identifier.</typeparam>
 /// <typeparam name="MaxSendPayloadSize">The max packet payload sent by this service.
 /// Effective value will always be at least as big as DiscoveryDefinition::PAYLOAD_SIZE.</typeparam>
+/// <typeparam name="SendQueueSize">How many send requests can be pending.</typeparam>
 template<const uint8_t Port,
 	const uint32_t ServiceId,
-	const uint8_t MaxSendPayloadSize = 0>
+	const uint8_t MaxSendPayloadSize = 0,
+	const uint8_t SendQueueSize = 1>
 class AbstractDiscoveryService
-	: public TemplateLinkService<DiscoveryDefinition::MaxPayloadSize(MaxSendPayloadSize)>
+	: public TemplateLinkService<DiscoveryDefinition::MaxPayloadSize(MaxSendPayloadSize), SendQueueSize>
 	, public virtual ILinkListener
 {
 private:
-	using BaseClass = TemplateLinkService<DiscoveryDefinition::MaxPayloadSize(MaxSendPayloadSize)>;
+	using BaseClass = TemplateLinkService<DiscoveryDefinition::MaxPayloadSize(MaxSendPayloadSize), SendQueueSize>;
 
 	static constexpr uint32_t DISCOVERY_SLOT_PERIOD_MICROS = LoLaLinkDefinition::DUPLEX_PERIOD_MAX_MICROS * 5;
 	static constexpr uint32_t DISCOVERY_TIMEOUT_MICROS = 10000000;
@@ -83,11 +85,22 @@ protected:
 	/// </summary>
 	virtual void OnLinkedPacketReceived(const uint32_t timestamp, const uint8_t* payload, const uint8_t payloadSize, const uint8_t port) {}
 
+	/// <summary>
+	/// A linked send request was dropped without being sent, once per request.
+	/// </summary>
+	virtual void OnLinkedSendRequestFail() {}
+
 private:
 	DiscoveryStateEnum DiscoveryState = DiscoveryStateEnum::WaitingForLink;
 	uint8_t LocalSlot = 0;
 	bool ReplyPending = false;
 
+public:
+	/// <summary>
+	/// Service port, for compile-time registries.
+	/// </summary>
+	static constexpr uint8_t PORT = Port;
+
 public:
 	AbstractDiscoveryService(TS::Scheduler& scheduler, ILoLaLink* loLaLink)
 		: BaseClass(scheduler, loLaLink)
@@ -245,6 +258,14 @@ public:
 	}
 
 protected:
+	virtual void OnSendRequestFail() final
+	{
+		if (DiscoveryState == DiscoveryStateEnum::Running)
+		{
+			OnLinkedSendRequestFail();
+		}
+	}
+
 	virtual void OnServiceRun() final
 	{
 		switch (DiscoveryState)
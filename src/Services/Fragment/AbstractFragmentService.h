@@ -0,0 +1,292 @@
+// AbstractFragmentService.h
+
+#ifndef _ABSTRACT_FRAGMENT_SERVICE_
+#define _ABSTRACT_FRAGMENT_SERVICE_
+
+#include "../../Services/Discovery/AbstractDiscoveryService.h"
+#include "FragmentDefinitions.h"
+
+/// <summary>
+/// Bi-directional, fragmented message service.
+/// Extends DiscoveryService and its functionality.
+/// Sends messages larger than a packet's payload,
+///  split over consecutive packets and reassembled in order on the partner.
+/// Fragments are pipelined through the service's send queue.
+/// A lost fragment drops the whole message, there is no retransmission.
+/// Incomplete messages are dropped when the reassembly deadline expires.
+/// </summary>
+/// <typeparam name="Port">The port registered for this service.</typeparam>
+/// <typeparam name="ServiceId">Unique service identifier.</typeparam>
+/// <typeparam name="MaxMessageSize">Reassembly buffer size [1;FragmentDefinitions::MAX_MESSAGE_SIZE].</typeparam>
+/// <typeparam name="SendQueueSize">How many fragments can be pending on the link.</typeparam>
+/// <typeparam name="ReassemblyTimeoutMillis">Max duration of a message reassembly, from its first fragment.</typeparam>
+template<const uint8_t Port,
+	const uint32_t ServiceId,
+	const uint16_t MaxMessageSize,
+	const uint8_t SendQueueSize = 4,
+	const uint32_t ReassemblyTimeoutMillis = 500>
+class AbstractFragmentService
+	: public AbstractDiscoveryService<Port, ServiceId, LoLaPacketDefinition::MAX_PAYLOAD_SIZE, SendQueueSize>
+{
+private:
+	using BaseClass = AbstractDiscoveryService<Port, ServiceId, LoLaPacketDefinition::MAX_PAYLOAD_SIZE, SendQueueSize>;
+
+	using FragmentDefinition = FragmentDefinitions::FragmentDefinition;
+
+	static_assert(MaxMessageSize > 0 && MaxMessageSize <= FragmentDefinitions::MAX_MESSAGE_SIZE, "MaxMessageSize out of range.");
+
+private:
+	using BaseClass::CanRequestSend;
+	using BaseClass::OutPacket;
+	using BaseClass::RequestSendPacket;
+
+protected:
+	using BaseClass::HasLink;
+	using BaseClass::IsDiscovered;
+
+private:
+	uint8_t RxBuffer[MaxMessageSize]{};
+
+	const uint8_t* TxData = nullptr;
+
+	uint32_t RxStart = 0;
+	uint32_t RxTimestamp = 0;
+	uint16_t RxSize = 0;
+	uint16_t TxSize = 0;
+	uint8_t RxId = 0;
+	uint8_t RxIndex = 0;
+	uint8_t RxCount = 0;
+	uint8_t TxId = 0;
+	uint8_t TxIndex = 0;
+	uint8_t TxCount = 0;
+	uint8_t TxPriority = 0;
+
+protected:
+	/// <summary>
+	/// Fires when the last fragment of the message has been queued.
+	/// The message data source can be released.
+	/// </summary>
+	virtual void OnMessageSent() {}
+
+	/// <summary>
+	/// Fires when all fragments of a message have arrived, in order.
+	/// </summary>
+	/// <param name="timestamp">Reception timestamp of the first fragment.</param>
+	/// <param name="data">Reassembly buffer, only valid during the callback.</param>
+	/// <param name="dataSize">[0;MaxMessageSize]</param>
+	virtual void OnMessageReceived(const uint32_t timestamp, const uint8_t* data, const uint16_t dataSize) {}
+
+public:
+	AbstractFragmentService(TS::Scheduler& scheduler, ILoLaLink* loLaLink)
+		: BaseClass(scheduler, loLaLink)
+	{}
+
+protected:
+	void CancelMessage()
+	{
+		TxData = nullptr;
+	}
+
+	const bool MessagePending() const
+	{
+		return TxData != nullptr;
+	}
+
+	const bool CanRequestMessage()
+	{
+		return HasLink()
+			&& IsDiscovered()
+			&& !MessagePending();
+	}
+
+	const bool RequestSendMessage(const uint8_t* data, const uint16_t dataSize, const RequestPriority priority = RequestPriority::REGULAR)
+	{
+		return RequestSendMessage(data, dataSize, (uint8_t)priority);
+	}
+
+	/// <summary>
+	/// Sends a message, in as many fragments as needed.
+	/// </summary>
+	/// <param name="data">Immutable data source. Contents should not change before OnMessageSent.</param>
+	/// <param name="dataSize">[0;MaxMessageSize].</param>
+	/// <param name="priority">For reference values see RequestPriority.</param>
+	/// <returns>True on success.</returns>
+	const bool RequestSendMessage(const uint8_t* data, const uint16_t dataSize, const uint8_t priority)
+	{
+		if (CanRequestMessage()
+			&& (data != nullptr || dataSize == 0)
+			&& dataSize <= MaxMessageSize)
+		{
+			TxId++;
+			TxData = data;
+			TxSize = dataSize;
+			TxIndex = 0;
+			TxCount = FragmentDefinitions::GetFragmentCount(dataSize);
+			TxPriority = priority;
+
+			TS::Task::enableDelayed(0);
+
+			return true;
+		}
+
+		return false;
+	}
+
+protected:
+	virtual void OnLinkedServiceRun()
+	{
+		// Keep the send queue full, until the last fragment is queued.
+		while (TxData != nullptr
+			&& CanRequestSend())
+		{
+			const uint16_t offset = (uint16_t)TxIndex * FragmentDefinitions::MAX_DATA_SIZE;
+			uint8_t dataSize = FragmentDefinitions::MAX_DATA_SIZE;
+			if (TxSize - offset < dataSize)
+			{
+				dataSize = TxSize - offset;
+			}
+
+			OutPacket.SetPort(Port);
+			OutPacket.SetHeader(FragmentDefinition::HEADER);
+			OutPacket.Payload[FragmentDefinition::PAYLOAD_MESSAGE_ID_INDEX] = TxId;
+			OutPacket.Payload[FragmentDefinition::PAYLOAD_FRAGMENT_INDEX] = TxIndex;
+			OutPacket.Payload[FragmentDefinition::PAYLOAD_FRAGMENT_COUNT_INDEX] = TxCount;
+			if (dataSize > 0)
+			{
+				memcpy(&OutPacket.Payload[FragmentDefinition::PAYLOAD_DATA_INDEX], &TxData[offset], dataSize);
+			}
+
+			if (!RequestSendPacket(FragmentDefinitions::GetFragmentPayloadSize(dataSize), TxPriority))
+			{
+				break;
+			}
+
+			TxIndex++;
+			if (TxIndex >= TxCount)
+			{
+				TxData = nullptr;
+				OnMessageSent();
+			}
+		}
+
+		if (TxData != nullptr)
+		{
+			TS::Task::enableDelayed(0);
+		}
+		else if (RxCount > 0)
+		{
+			// Wake up on reassembly deadline.
+			const uint32_t elapsed = millis() - RxStart;
+			if (elapsed >= ReassemblyTimeoutMillis)
+			{
+				DropMessage();
+				TS::Task::disable();
+			}
+			else
+			{
+				TS::Task::enableDelayed(ReassemblyTimeoutMillis - elapsed);
+			}
+		}
+		else
+		{
+			TS::Task::disable();
+		}
+	}
+
+	virtual void OnServiceStarted()
+	{
+		TS::Task::disable();
+		TxData = nullptr;
+		RxCount = 0;
+		TxId = 0;
+	}
+
+	virtual void OnServiceEnded()
+	{
+		TS::Task::disable();
+		TxData = nullptr;
+		RxCount = 0;
+	}
+
+	void OnLinkedPacketReceived(const uint32_t timestamp, const uint8_t* payload, const uint8_t payloadSize, const uint8_t port) final
+	{
+		if (payload[HeaderDefinition::HEADER_INDEX] != FragmentDefinition::HEADER
+			|| payloadSize < FragmentDefinitions::GetFragmentPayloadSize(0))
+		{
+			return;
+		}
+
+		const uint8_t id = payload[FragmentDefinition::PAYLOAD_MESSAGE_ID_INDEX];
+		const uint8_t index = payload[FragmentDefinition::PAYLOAD_FRAGMENT_INDEX];
+		const uint8_t count = payload[FragmentDefinition::PAYLOAD_FRAGMENT_COUNT_INDEX];
+		const uint8_t dataSize = FragmentDefinitions::GetFragmentDataSize(payloadSize);
+
+		if (index >= count
+			|| (index < (count - 1) && dataSize != FragmentDefinitions::MAX_DATA_SIZE))
+		{
+			// Invalid fragment.
+			DropMessage();
+			return;
+		}
+
+		if (RxCount > 0
+			&& (millis() - RxStart) >= ReassemblyTimeoutMillis)
+		{
+			DropMessage();
+		}
+
+		if (index == 0)
+		{
+			// First fragment starts a new message, any incomplete one is dropped.
+			DropMessage();
+			RxId = id;
+			RxCount = count;
+			RxIndex = 0;
+			RxSize = 0;
+			RxStart = millis();
+			RxTimestamp = timestamp;
+			TS::Task::enableDelayed(0);
+		}
+		else if (RxCount == 0
+			|| id != RxId
+			|| count != RxCount
+			|| index != RxIndex)
+		{
+			// Lost fragment, message can't be completed.
+			DropMessage();
+			return;
+		}
+
+		if ((uint16_t)RxSize + dataSize > MaxMessageSize)
+		{
+			DropMessage();
+			return;
+		}
+
+		if (dataSize > 0)
+		{
+			memcpy(&RxBuffer[RxSize], &payload[FragmentDefinition::PAYLOAD_DATA_INDEX], dataSize);
+		}
+		RxSize += dataSize;
+		RxIndex++;
+
+		if (RxIndex >= RxCount)
+		{
+			RxCount = 0;
+			OnMessageReceived(RxTimestamp, RxBuffer, RxSize);
+		}
+	}
+
+private:
+	void DropMessage()
+	{
+		if (RxCount > 0)
+		{
+			RxCount = 0;
+#if defined(DEBUG_LOLA)
+			Serial.println(F("Fragment message dropped."));
+#endif
+		}
+	}
+};
+#endif
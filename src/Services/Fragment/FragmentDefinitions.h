@@ -0,0 +1,56 @@
+// FragmentDefinitions.h
+
+#ifndef _FRAGMENT_DEFINITIONS_h
+#define _FRAGMENT_DEFINITIONS_h
+
+#include <ILinkServices.h>
+
+struct FragmentDefinitions
+{
+	/// <summary>
+	/// MessageId, FragmentIndex and FragmentCount.
+	/// </summary>
+	static constexpr uint8_t FRAGMENT_HEADER_SIZE = 3;
+
+	static constexpr uint8_t MAX_DATA_SIZE = LoLaPacketDefinition::MAX_PAYLOAD_SIZE
+		- HeaderDefinition::SUB_PAYLOAD_INDEX - FRAGMENT_HEADER_SIZE;
+
+	/// <summary>
+	/// Largest message that can be indexed in fragments.
+	/// </summary>
+	static constexpr uint16_t MAX_MESSAGE_SIZE = (uint16_t)UINT8_MAX * MAX_DATA_SIZE;
+
+	/// <summary>
+	/// Every message takes at least one fragment, even if empty.
+	/// </summary>
+	static constexpr uint8_t GetFragmentCount(const uint16_t messageSize)
+	{
+		return messageSize == 0 ? 1 : (uint8_t)((messageSize + MAX_DATA_SIZE - 1) / MAX_DATA_SIZE);
+	}
+
+	static constexpr uint8_t GetFragmentDataSize(const uint8_t payloadSize)
+	{
+		return payloadSize - (FragmentDefinition::PAYLOAD_SIZE - MAX_DATA_SIZE);
+	}
+
+	static constexpr uint8_t GetFragmentPayloadSize(const uint8_t dataSize)
+	{
+		return dataSize + (FragmentDefinition::PAYLOAD_SIZE - MAX_DATA_SIZE);
+	}
+
+	/// <summary>
+	/// Dynamic size packet.
+	/// Only the last fragment of a message may be shorter than MAX_DATA_SIZE.
+	/// SubPayload: ||MessageId|FragmentIndex|FragmentCount|Data...||
+	/// </summary>
+	struct FragmentDefinition : public TemplateHeaderDefinition<0, FRAGMENT_HEADER_SIZE + MAX_DATA_SIZE>
+	{
+		static constexpr uint8_t PAYLOAD_MESSAGE_ID_INDEX = HeaderDefinition::SUB_PAYLOAD_INDEX;
+		static constexpr uint8_t PAYLOAD_FRAGMENT_INDEX = PAYLOAD_MESSAGE_ID_INDEX + 1;
+		static constexpr uint8_t PAYLOAD_FRAGMENT_COUNT_INDEX = PAYLOAD_FRAGMENT_INDEX + 1;
+		static constexpr uint8_t PAYLOAD_DATA_INDEX = PAYLOAD_FRAGMENT_COUNT_INDEX + 1;
+	};
+
+	static constexpr uint8_t FRAGMENT_SUB_SERVICE_HEADER_START = FragmentDefinition::HEADER + 1;
+};
+#endif
@@ -18,14 +18,16 @@ using namespace SurfaceDefinitions;
 /// <typeparam name="Port">The port registered for this service.</typeparam>
 /// <typeparam name="ServiceId">Unique service identifier.</typeparam>
 /// <typeparam name="MaxSendPayloadSize">The max packet payload sent by this service.</typeparam>
+/// <typeparam name="SendQueueSize">How many send requests can be pending.</typeparam>
 template<const uint8_t Port,
 	const uint32_t ServiceId,
-	const uint8_t MaxSendPayloadSize>
+	const uint8_t MaxSendPayloadSize,
+	const uint8_t SendQueueSize = 1>
 class AbstractSurfaceService
-	: public AbstractDiscoveryService<Port, ServiceId, MaxSendPayloadSize>
+	: public AbstractDiscoveryService<Port, ServiceId, MaxSendPayloadSize, SendQueueSize>
 {
 private:
-	using BaseClass = AbstractDiscoveryService<Port, ServiceId, MaxSendPayloadSize>;
+	using BaseClass = AbstractDiscoveryService<Port, ServiceId, MaxSendPayloadSize, SendQueueSize>;
 	using SyncMetaDefinition = SyncDefinition<0>;
 
 protected:
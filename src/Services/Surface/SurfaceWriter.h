@@ -14,15 +14,17 @@
 /// <typeparam name="Port">The port registered for this service.</typeparam>
 /// <typeparam name="ServiceId">Unique service identifier.</typeparam>
 /// <typeparam name="ThrottlePeriodMillis">Minimum update period between sync cycles, in milliseconds.</typeparam>
+/// <typeparam name="SendQueueSize">How many block updates can be pending, to keep the pipeline full across duplex slots.</typeparam>
 template <const uint8_t Port
 	, const uint32_t ServiceId
-	, const uint16_t ThrottlePeriodMillis = 50>
+	, const uint16_t ThrottlePeriodMillis = 50
+	, const uint8_t SendQueueSize = 1>
 class SurfaceWriter
-	: public AbstractSurfaceService<Port, ServiceId, SurfaceWriterMaxPayloadSize>
+	: public AbstractSurfaceService<Port, ServiceId, SurfaceWriterMaxPayloadSize, SendQueueSize>
 	, public virtual ISurfaceListener
 {
 private:
-	using BaseClass = AbstractSurfaceService<Port, ServiceId, SurfaceWriterMaxPayloadSize>;
+	using BaseClass = AbstractSurfaceService<Port, ServiceId, SurfaceWriterMaxPayloadSize, SendQueueSize>;
 
 	static constexpr uint32_t START_DELAY_PERIOD_MILLIS = 50;
 	static constexpr uint8_t MAX_RETRIES_BEFORE_INVALIDATION = 2;
@@ -7,6 +7,7 @@
 #include <TSchedulerDeclarations.hpp>
 
 #include "RequestPriority.h"
+#include "TemplateSendQueue.h"
 
 #include "../../Link/LoLaPacketDefinition.h"
 #include "../../Link/ILoLaLink.h"
@@ -17,17 +18,19 @@
 /// Features:
 ///  - Async Send, blocking ServiceRun until transmition is done.
 ///  - Callbacks for last chance Pre-Send, and Send-Failure.
-///  - Priority handling, based on link congestion.
+///  - Priority handling, based on link congestion, by the link's transmit arbiter.
+///  - Optional bounded send queue, to keep the send pipeline full across duplex slots.
 /// </summary>
 /// <typeparam name="MaxSendPayloadSize"></typeparam>
-template<const uint8_t MaxSendPayloadSize>
-class TemplateLinkService : public virtual ILinkPacketListener 
+/// <typeparam name="SendQueueSize">How many send requests can be pending.
+/// 1 sends in-place from OutPacket. Above 1, requests are copied into the send queue.</typeparam>
+template<const uint8_t MaxSendPayloadSize,
+	const uint8_t SendQueueSize = 1>
+class TemplateLinkService : public virtual ILinkPacketListener
+	, protected ILinkSendRequest
 	, protected TS::Task
 {
-private:
-	static constexpr uint16_t PRIORITY_NEGATIVE_SCALE = 275;
-	static constexpr uint8_t PRIORITY_POSITIVE_SCALE = 15;
-	static constexpr uint8_t PRIORITY_PERIOD_SCALE = 2;
+	static_assert(SendQueueSize > 0, "SendQueueSize must be at least 1.");
 
 protected:
 	/// <summary>
@@ -41,18 +44,25 @@ protected:
 	ILoLaLink* LoLaLink;
 
 private:
-	uint32_t RequestStart = 0;
+	TemplateSendQueue<MaxSendPayloadSize, SendQueueSize> SendQueue{};
+
 	uint32_t LastSent = 0;
 
 	uint8_t PayloadSize = 0;
-	uint8_t Priority = 0;
 
 protected:
 	/// <summary>
-	/// Last chance to update payload right before transmission.
+	/// Last chance to update OutPacket's payload right before transmission.
+	/// Only called when SendQueueSize is 1, queued packets are already copied and sent as requested.
 	/// </summary>
 	virtual void OnPreSend() { }
 
+	/// <summary>
+	/// A pending send request was dropped without being sent.
+	/// Fires once per dropped request, the service may request again from here.
+	/// </summary>
+	virtual void OnSendRequestFail() { }
+
 	/// <summary>
 	/// The service class can ride this task's callback, when no send is being performed.
 	/// Useful for in-line services (expected to block flow until send is complete).
@@ -73,6 +83,7 @@ public:
 public:
 	TemplateLinkService(TS::Scheduler& scheduler, ILoLaLink* loLaLink)
 		: ILinkPacketListener()
+		, ILinkSendRequest()
 		, TS::Task(TASK_IMMEDIATE, TASK_FOREVER, &scheduler, false)
 		, LoLaLink(loLaLink)
 	{}
@@ -89,45 +100,12 @@ public:
 
 	virtual bool Callback() final
 	{
-		if (PayloadSize > 0)
+		if (!CanRequestSend())
 		{
-			TS::Task::delay(0);
-			if (Priority == 0)
-			{
-				// Busy loop waiting for send availability.
-				LOLA_RTOS_PAUSE();
-				if (LoLaLink->CanSendPacket(PayloadSize))
-				{
-					// Send is available, last moment callback before transmission.
-					OnPreSend();
-
-					// Transmit packet.
-					const bool sent = LoLaLink->SendPacket(OutPacket.Data, PayloadSize);
-					LOLA_RTOS_RESUME();
-
-					if (sent)
-					{
-						PayloadSize = 0;
-						LastSent = micros();
-					}
-					else
-					{
-						// Transmit failed on Transceiver, try again until time-out.
-#if defined(DEBUG_LOLA)
-						Serial.println(F("Tx Failed."));
-#endif
-					}
-				}
-				else
-				{
-					LOLA_RTOS_RESUME();
-					// Can't send now, try again later.
-				}
-			}
-			else if (GetPriorityScore(LoLaLink->GetSendElapsed(), micros() - RequestStart) >= Priority)
-			{
-				Priority = 0;
-			}
+			// Request is queued on the link, the service is woken up once it's sent.
+			TS::Task::disable();
+
+			return false;
 		}
 		else
 		{
@@ -137,17 +115,52 @@ public:
 		return true;
 	}
 
+	/// <summary>
+	/// ILinkSendRequest overrides.
+	/// </summary>
+public:
+	const uint8_t* OnSendGranted() final
+	{
+		if (SendQueueSize > 1)
+		{
+			return SendQueue.Peek()->Data;
+		}
+
+		OnPreSend();
+
+		return OutPacket.Data;
+	}
+
+	void OnSendRequestDone() final
+	{
+		LastSent = micros();
+		if (SendQueueSize > 1)
+		{
+			SendQueue.Pop();
+			if (SendQueue.GetCount() > 0
+				&& !RequestSendQueueHead())
+			{
+				DiscardSendRequests();
+			}
+		}
+		else
+		{
+			PayloadSize = 0;
+		}
+		TS::Task::enable();
+	}
+
 protected:
 	/// <summary>
 	/// Shortcut for services to register Port listeners.
 	/// A service can register to multiple ports.
 	/// Also checks if requested port is not reserved.
 	/// </summary>
-	/// <param name="port">Port number to register [0;LoLaLinkDefinition::LINK_PORT-1].</param>
+	/// <param name="port">Port number to register [0;LoLaLinkDefinition::MAX_DEFINITION_PORT].</param>
 	/// <returns>True if success. False if no more slots are available or Port was reserved.</returns>
 	const bool RegisterPacketListener(const uint8_t port)
 	{
-		if (port < LoLaLinkDefinition::LINK_PORT)
+		if (port <= LoLaLinkDefinition::MAX_DEFINITION_PORT)
 		{
 			return LoLaLink->RegisterPacketListener(this, port);
 		}
@@ -178,30 +191,56 @@ protected:
 
 	/// <summary>
 	/// Cancel send request if pending and unlock service.
+	/// Every dropped request fires OnSendRequestFail.
 	/// </summary>
 	void RequestSendCancel()
 	{
-		PayloadSize = 0;
+		if (PayloadSize > 0
+			|| SendQueue.GetCount() > 0)
+		{
+			LoLaLink->CancelSend(this);
+			DiscardSendRequests();
+		}
 	}
 
 	/// <summary>
 	/// </summary>
-	/// <returns>True if no request is pending.</returns>
+	/// <returns>True if a new request can be accepted.</returns>
 	const bool CanRequestSend() const
 	{
+		if (SendQueueSize > 1)
+		{
+			return !SendQueue.IsFull();
+		}
+
 		return PayloadSize == 0;
 	}
 
+	/// <summary>
+	/// </summary>
+	/// <returns>How many send requests are pending.</returns>
+	const uint8_t GetSendPendingCount() const
+	{
+		if (SendQueueSize > 1)
+		{
+			return SendQueue.GetCount();
+		}
+
+		return PayloadSize > 0;
+	}
+
 	/// <summary>
 	/// Request to send the current Outpacket as soon as possible.
-	/// Locks service callbacks until the OutPacket is sent.
+	/// Locks service callbacks until the request can be accepted:
+	///  the OutPacket is sent, or the send queue has room.
 	/// </summary>
 	/// <param name="payloadSize">Payload size of the current Outpacket.</param>
 	/// <param name="priority"></param>
+	/// <param name="deadline">Max wait in microseconds, before the request jumps the queue. 0 for no deadline.</param>
 	/// <returns>False if a previous send request was interrupted.</returns>
-	const bool RequestSendPacket(const uint8_t payloadSize, const RequestPriority priority = RequestPriority::REGULAR)
+	const bool RequestSendPacket(const uint8_t payloadSize, const RequestPriority priority = RequestPriority::REGULAR, const uint32_t deadline = 0)
 	{
-		return RequestSendPacket(payloadSize, (const uint8_t)priority);
+		return RequestSendPacket(payloadSize, (const uint8_t)priority, deadline);
 	}
 
 	/// <summary>
@@ -209,10 +248,11 @@ protected:
 	/// </summary>
 	/// <param name="payloadSize">Payload size of the current Outpacket.</param>
 	/// <param name="priority">For reference values see RequestPriority.</param>
+	/// <param name="deadline">Max wait in microseconds, before the request jumps the queue. 0 for no deadline.</param>
 	/// <returns>False if a previous send request was interrupted.</returns>
-	const bool RequestSendPacket(const uint8_t payloadSize, const uint8_t priority)
+	const bool RequestSendPacket(const uint8_t payloadSize, const uint8_t priority, const uint32_t deadline = 0)
 	{
-		if (PayloadSize > 0)
+		if (!CanRequestSend())
 		{
 			// Attempted to interrupt another request.
 #if defined(DEBUG_LOLA)
@@ -228,14 +268,88 @@ protected:
 		}
 #endif
 
-		RequestStart = micros();
+		if (SendQueueSize > 1)
+		{
+			typename TemplateSendQueue<MaxSendPayloadSize, SendQueueSize>::SlotType* slot = SendQueue.Push();
+			memcpy(slot->Data, OutPacket.Data, LoLaPacketDefinition::GetDataSizeFromPayloadSize(payloadSize));
+			slot->Start = micros();
+			slot->Deadline = deadline;
+			slot->PayloadSize = payloadSize;
+			slot->Priority = priority;
+
+			// Only the queue head is requested on the link.
+			if (SendQueue.GetCount() == 1
+				&& !RequestSendQueueHead())
+			{
+				DiscardSendRequests();
+				return false;
+			}
+
+			return true;
+		}
+
+		SendStart = micros();
+		SendDeadline = deadline;
+		SendPriority = priority;
+		SendPayloadSize = payloadSize;
+		SendPort = OutPacket.GetPort();
+
+		if (!LoLaLink->RequestSend(this))
+		{
+			return false;
+		}
 		PayloadSize = payloadSize;
-		Priority = priority;
-		TS::Task::enableDelayed(0);
 
 		return true;
 	}
 
+private:
+	/// <summary>
+	/// Drops all pending requests and reports each one.
+	/// The queue is emptied before the callbacks, so the service can request again.
+	/// </summary>
+	void DiscardSendRequests()
+	{
+		uint8_t discarded = 0;
+		if (SendQueueSize > 1)
+		{
+			discarded = SendQueue.GetCount();
+			SendQueue.Clear();
+		}
+		else
+		{
+			discarded = PayloadSize > 0;
+			PayloadSize = 0;
+		}
+
+		for (uint_fast8_t i = 0; i < discarded; i++)
+		{
+			OnSendRequestFail();
+		}
+	}
+
+	/// <summary>
+	/// Request the send queue head on the link, with its own request parameters.
+	/// </summary>
+	/// <returns>False if the queue is empty or the link rejected the request.</returns>
+	const bool RequestSendQueueHead()
+	{
+		typename TemplateSendQueue<MaxSendPayloadSize, SendQueueSize>::SlotType* slot = SendQueue.Peek();
+
+		if (slot == nullptr)
+		{
+			return false;
+		}
+
+		SendStart = slot->Start;
+		SendDeadline = slot->Deadline;
+		SendPriority = slot->Priority;
+		SendPayloadSize = slot->PayloadSize;
+		SendPort = slot->Data[(uint8_t)LoLaPacketDefinition::IndexEnum::Port - (uint8_t)LoLaPacketDefinition::IndexEnum::Data];
+
+		return LoLaLink->RequestSend(this);
+	}
+
 protected:
 	/// <summary>
 	/// Scales a priority range, provided a progress.
@@ -265,33 +379,5 @@ protected:
 	{
 		return (const RequestPriority)GetProgressPriority<(const uint8_t)PriorityMin, (const uint8_t)PriorityMax>(progress);
 	}
-
-private:
-	/// <summary>
-	/// Calculates the priority score, to match with the request priority.
-	/// </summary>
-	/// <param name="txElapsed">Elapsed since last transmition ended, in microseconds.</param>
-	/// <param name="requestElapsed">Elapsed since the Send Request started, in microseconds.</param>
-	/// <returns>Abstract priority Score.</returns>
-	const uint8_t GetPriorityScore(const uint32_t txElapsed, const uint32_t requestElapsed) const
-	{
-		const uint32_t priorityPeriod = LoLaLink->GetPacketThrottlePeriod() * PRIORITY_PERIOD_SCALE;
-		const uint32_t scoreRequest = requestElapsed / ((uint32_t)1 + (priorityPeriod / PRIORITY_NEGATIVE_SCALE));
-		const uint32_t scoreTx = txElapsed / ((uint32_t)1 + (priorityPeriod / PRIORITY_POSITIVE_SCALE));
-
-		if (scoreRequest >= UINT8_MAX)
-		{
-			return UINT8_MAX;
-		}
-		else if (scoreTx >= UINT8_MAX
-			|| scoreTx >= ((uint32_t)UINT8_MAX - scoreRequest))
-		{
-			return UINT8_MAX;
-		}
-		else
-		{
-			return ((uint8_t)scoreRequest) + ((uint8_t)scoreTx);
-		}
-	}
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,124 @@
+// TemplateSendQueue.h
+
+#ifndef _TEMPLATE_SEND_QUEUE_h
+#define _TEMPLATE_SEND_QUEUE_h
+
+#include "../../Link/LoLaPacketDefinition.h"
+
+/// <summary>
+/// Queued outbound packet, with its own send request parameters.
+/// </summary>
+/// <typeparam name="MaxSendPayloadSize"></typeparam>
+template<const uint8_t MaxSendPayloadSize>
+struct TemplateSendSlot
+{
+	static constexpr uint8_t DataSize = LoLaPacketDefinition::GetDataSizeFromPayloadSize(MaxSendPayloadSize);
+
+	uint8_t Data[DataSize];
+	uint32_t Start;
+	uint32_t Deadline;
+	uint8_t PayloadSize;
+	uint8_t Priority;
+};
+
+/// <summary>
+/// Bounded FIFO of outbound packets, for services that keep a send pipeline full.
+/// </summary>
+/// <typeparam name="MaxSendPayloadSize"></typeparam>
+/// <typeparam name="SendQueueSize">How many packets can be queued [2;UINT8_MAX].</typeparam>
+template<const uint8_t MaxSendPayloadSize,
+	const uint8_t SendQueueSize>
+class TemplateSendQueue
+{
+public:
+	using SlotType = TemplateSendSlot<MaxSendPayloadSize>;
+
+private:
+	SlotType Slots[SendQueueSize]{};
+
+	uint8_t Head = 0;
+	uint8_t Count = 0;
+
+public:
+	const uint8_t GetCount() const
+	{
+		return Count;
+	}
+
+	const bool IsFull() const
+	{
+		return Count >= SendQueueSize;
+	}
+
+	/// <summary>
+	/// Reserve the tail slot.
+	/// </summary>
+	/// <returns>Tail slot, nullptr if full.</returns>
+	SlotType* Push()
+	{
+		if (IsFull())
+		{
+			return nullptr;
+		}
+
+		uint8_t tail = Head + Count;
+		if (tail >= SendQueueSize)
+		{
+			tail -= SendQueueSize;
+		}
+		Count++;
+
+		return &Slots[tail];
+	}
+
+	/// <summary>
+	/// </summary>
+	/// <returns>Head slot, nullptr if empty.</returns>
+	SlotType* Peek()
+	{
+		if (Count == 0)
+		{
+			return nullptr;
+		}
+
+		return &Slots[Head];
+	}
+
+	void Pop()
+	{
+		if (Count > 0)
+		{
+			Count--;
+			Head++;
+			if (Head >= SendQueueSize)
+			{
+				Head = 0;
+			}
+		}
+	}
+
+	void Clear()
+	{
+		Head = 0;
+		Count = 0;
+	}
+};
+
+/// <summary>
+/// Single request services send in-place from their OutPacket, no queue storage.
+/// </summary>
+template<const uint8_t MaxSendPayloadSize>
+class TemplateSendQueue<MaxSendPayloadSize, 1>
+{
+public:
+	using SlotType = TemplateSendSlot<MaxSendPayloadSize>;
+
+public:
+	const uint8_t GetCount() const { return 0; }
+	const bool IsFull() const { return true; }
+	SlotType* Push() { return nullptr; }
+	SlotType* Peek() { return nullptr; }
+	void Pop() {}
+	void Clear() {}
+};
+#endif
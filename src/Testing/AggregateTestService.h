@@ -0,0 +1,168 @@
+// AggregateTestService.h
+
+#ifndef _AGGREGATE_TEST_SERVICE_h
+#define _AGGREGATE_TEST_SERVICE_h
+
+#include "Services/Discovery/AbstractDiscoveryService.h"
+
+/// <summary>
+/// Shared by the receiving services, to spot packets that carried more than one service.
+/// Each received packet has its own receive timestamp,
+///  only an aggregated packet delivers the same timestamp to different ports.
+/// </summary>
+struct AggregateTestTracker
+{
+	uint32_t LastTimestamp = 0;
+	uint32_t AggregateCount = 0;
+	uint8_t LastPort = UINT8_MAX;
+
+	void OnReceived(const uint32_t timestamp, const uint8_t port)
+	{
+		if (timestamp == LastTimestamp
+			&& port != LastPort)
+		{
+			AggregateCount++;
+		}
+		LastTimestamp = timestamp;
+		LastPort = port;
+	}
+};
+
+/// <summary>
+/// Small payload service, for the link to aggregate with its siblings.
+/// Senders request on the same period boundary, so their requests are eligible in the same arbiter pass.
+/// Payload content is derived from the port and sequence, so the receiver can check it without state.
+/// </summary>
+template<const char OnwerName,
+	const uint8_t Port,
+	const uint32_t ServiceId,
+	const bool IsSender>
+class AggregateTestService : public AbstractDiscoveryService<Port, ServiceId, 4>
+{
+private:
+	using BaseClass = AbstractDiscoveryService<Port, ServiceId, 4>;
+
+	static constexpr uint8_t HEADER = 0;
+	static constexpr uint8_t PAYLOAD_SIZE = 4;
+	static constexpr uint32_t SEND_PERIOD_MILLIS = 50;
+
+protected:
+	using BaseClass::CanRequestSend;
+	using BaseClass::RequestSendPacket;
+	using BaseClass::OutPacket;
+
+private:
+	AggregateTestTracker* Tracker;
+
+	uint32_t SendPeriod = 0;
+	uint32_t ReceivedCount = 0;
+	uint32_t ErrorCount = 0;
+	uint8_t Sequence = 0;
+
+public:
+	AggregateTestService(TS::Scheduler& scheduler, ILoLaLink* link, AggregateTestTracker* tracker = nullptr)
+		: BaseClass(scheduler, link)
+		, Tracker(tracker)
+	{}
+
+	const uint32_t GetReceivedCount() const
+	{
+		return ReceivedCount;
+	}
+
+	const uint32_t GetErrorCount() const
+	{
+		return ErrorCount;
+	}
+
+#ifdef DEBUG_LOLA
+protected:
+	void PrintName()
+	{
+		Serial.print(millis());
+		Serial.print('\t');
+		Serial.print('[');
+		Serial.print(OnwerName);
+		Serial.print(']');
+		Serial.print('\t');
+	}
+#endif
+
+private:
+	static constexpr uint8_t GetPayloadByte(const uint8_t sequence, const uint8_t index)
+	{
+		return (uint8_t)(sequence + (index * Port));
+	}
+
+protected:
+	void OnServiceStarted() final
+	{
+		BaseClass::OnServiceStarted();
+
+		SendPeriod = millis() / SEND_PERIOD_MILLIS;
+		TS::Task::enableDelayed(0);
+#if defined(DEBUG_LOLA)
+		PrintName();
+		Serial.println(F("Test Aggregate Started."));
+#endif
+	}
+
+	void OnLinkedServiceRun() final
+	{
+		BaseClass::OnLinkedServiceRun();
+
+		if (IsSender)
+		{
+			const uint32_t period = millis() / SEND_PERIOD_MILLIS;
+
+			if (period != SendPeriod
+				&& CanRequestSend())
+			{
+				OutPacket.SetPort(Port);
+				OutPacket.SetHeader(HEADER);
+				OutPacket.Payload[1] = Sequence;
+				for (uint8_t i = 2; i < PAYLOAD_SIZE; i++)
+				{
+					OutPacket.Payload[i] = GetPayloadByte(Sequence, i);
+				}
+
+				if (RequestSendPacket(PAYLOAD_SIZE, RequestPriority::FAST))
+				{
+					Sequence++;
+					SendPeriod = period;
+				}
+			}
+			TS::Task::enableDelayed(1);
+		}
+	}
+
+	void OnLinkedPacketReceived(const uint32_t timestamp, const uint8_t* payload, const uint8_t payloadSize, const uint8_t port) final
+	{
+		bool valid = port == Port
+			&& payloadSize == PAYLOAD_SIZE
+			&& payload[HeaderDefinition::HEADER_INDEX] == HEADER;
+		for (uint8_t i = 2; valid && i < PAYLOAD_SIZE; i++)
+		{
+			valid = payload[i] == GetPayloadByte(payload[1], i);
+		}
+
+		if (valid)
+		{
+			ReceivedCount++;
+			if (Tracker != nullptr)
+			{
+				Tracker->OnReceived(timestamp, port);
+			}
+		}
+		else
+		{
+			ErrorCount++;
+#if defined(DEBUG_LOLA)
+			PrintName();
+			Serial.print(F("Aggregate sub-frame corrupted, size "));
+			Serial.println(payloadSize);
+#endif
+		}
+	}
+};
+#endif
@@ -6,7 +6,7 @@
 #define _TASK_OO_CALLBACKS
 #include <TSchedulerDeclarations.hpp>
 
-#include "../../LoLa/src/Clock/TuneClock.h"
+#include "../Clock/TuneClock.h"
 
 class ClockDetunerTask : private TS::Task
 {
@@ -3,7 +3,7 @@
 #ifndef _DELIVERY_TEST_SERVICE_h
 #define _DELIVERY_TEST_SERVICE_h
 
-#include "Services\Delivery\AbstractDeliveryService.h"
+#include "Services/Delivery/AbstractDeliveryService.h"
 
 namespace TestDeliveryData
 {
@@ -0,0 +1,131 @@
+// FragmentTestService.h
+
+#ifndef _FRAGMENT_TEST_SERVICE_h
+#define _FRAGMENT_TEST_SERVICE_h
+
+#include "Services/Fragment/AbstractFragmentService.h"
+
+/// <summary>
+/// Sender cycles through message sizes, receiver checks every reassembled message.
+/// Message content is derived from its first byte, so the receiver can check it without state.
+/// </summary>
+template<const char OnwerName,
+	const uint8_t Port,
+	const uint32_t ServiceId,
+	const bool IsSender,
+	const uint16_t MaxMessageSize = 200>
+class FragmentTestService : public AbstractFragmentService<Port, ServiceId, MaxMessageSize>
+{
+private:
+	using BaseClass = AbstractFragmentService<Port, ServiceId, MaxMessageSize>;
+
+protected:
+	using BaseClass::CanRequestMessage;
+	using BaseClass::RequestSendMessage;
+
+private:
+	static constexpr uint32_t SEND_PERIOD_MILLIS = 100;
+
+	uint8_t Message[MaxMessageSize]{};
+
+	uint32_t SendTime = 0;
+	uint32_t ReceivedCount = 0;
+	uint32_t ErrorCount = 0;
+	uint8_t Sequence = 0;
+
+public:
+	FragmentTestService(TS::Scheduler& scheduler, ILoLaLink* link)
+		: BaseClass(scheduler, link)
+	{}
+
+	const uint32_t GetReceivedCount() const
+	{
+		return ReceivedCount;
+	}
+
+	const uint32_t GetErrorCount() const
+	{
+		return ErrorCount;
+	}
+
+#ifdef DEBUG_LOLA
+protected:
+	void PrintName()
+	{
+		Serial.print(millis());
+		Serial.print('\t');
+		Serial.print('[');
+		Serial.print(OnwerName);
+		Serial.print(']');
+		Serial.print('\t');
+	}
+#endif
+
+private:
+	static constexpr uint16_t GetMessageSize(const uint8_t sequence)
+	{
+		return 1 + (((uint16_t)sequence * 37) % MaxMessageSize);
+	}
+
+protected:
+	void OnServiceStarted() final
+	{
+		BaseClass::OnServiceStarted();
+
+		SendTime = millis() - SEND_PERIOD_MILLIS;
+		TS::Task::enableDelayed(0);
+#if defined(DEBUG_LOLA)
+		PrintName();
+		Serial.println(F("Test Fragment Started."));
+#endif
+	}
+
+	void OnLinkedServiceRun() final
+	{
+		BaseClass::OnLinkedServiceRun();
+
+		if (IsSender)
+		{
+			if (CanRequestMessage()
+				&& millis() - SendTime >= SEND_PERIOD_MILLIS)
+			{
+				const uint16_t size = GetMessageSize(Sequence);
+				for (uint16_t i = 0; i < size; i++)
+				{
+					Message[i] = Sequence + i;
+				}
+
+				if (RequestSendMessage(Message, size))
+				{
+					Sequence++;
+					SendTime = millis();
+				}
+			}
+			TS::Task::enableDelayed(1);
+		}
+	}
+
+	void OnMessageReceived(const uint32_t timestamp, const uint8_t* data, const uint16_t dataSize) final
+	{
+		bool valid = dataSize > 0 && dataSize == GetMessageSize(data[0]);
+		for (uint16_t i = 1; valid && i < dataSize; i++)
+		{
+			valid = data[i] == (uint8_t)(data[0] + i);
+		}
+
+		if (valid)
+		{
+			ReceivedCount++;
+		}
+		else
+		{
+			ErrorCount++;
+#if defined(DEBUG_LOLA)
+			PrintName();
+			Serial.print(F("Fragment message corrupted, size "));
+			Serial.println(dataSize);
+#endif
+		}
+	}
+};
+#endif